@@ -13,27 +13,211 @@
 #include "buffer/buffer_pool_manager.h"
 
 #include <algorithm>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                     ReplacerType replacer_type, FrameAllocator *frame_allocator,
+                                     DiskBackend *disk_backend, size_t max_pool_size, size_t lru_k,
+                                     uint64_t lru_k_correlated_reference_period)
+    : BufferPoolManager(pool_size, 1, 0, disk_manager, log_manager, replacer_type, frame_allocator, disk_backend,
+                        max_pool_size, lru_k, lru_k_correlated_reference_period) {}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                     DiskManager *disk_manager, LogManager *log_manager, ReplacerType replacer_type,
+                                     FrameAllocator *frame_allocator, DiskBackend *disk_backend, size_t max_pool_size,
+                                     size_t lru_k, uint64_t lru_k_correlated_reference_period)
+    : pool_size_(0),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      default_disk_backend_(disk_manager),
+      disk_backend_(disk_backend != nullptr ? disk_backend : &default_disk_backend_),
+      page_table_(max_pool_size_) {
+  BUSTUB_ASSERT(num_instances > 0, "a buffer pool that is not sharded is a pool of 1 instance");
+  BUSTUB_ASSERT(instance_index < num_instances, "instance index must be smaller than the number of instances");
   // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // The Page objects are allocated for the largest size up front, so that frames never move while hits read them
+  // without the latch. The frame data lives in separate regions, so that the allocator can align it and back it by
+  // huge pages, and so that Resize can allocate and free it.
+  pages_ = new Page[max_pool_size_];
+  frame_allocator_ = frame_allocator != nullptr ? frame_allocator : DefaultFrameAllocator::Instance();
+  switch (replacer_type) {
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU_K:
+      lru_k_replacer_ = new LRUKReplacer(max_pool_size_, lru_k, lru_k_correlated_reference_period);
+      replacer_ = lru_k_replacer_;
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+  }
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  io_in_progress_ = std::vector<std::atomic<bool>>(max_pool_size_);
+
+  // Frames beyond the pool size are retired until a Resize grows the pool.
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].pin_count_ = RESERVED_PIN_COUNT;
   }
+
+  // Initially, every page is in the free list.
+  GrowPool(pool_size);
 }
 
 BufferPoolManager::~BufferPoolManager() {
+  StopBackgroundFlusher();
   delete[] pages_;
+  for (const FrameExtent &extent : frame_extents_) {
+    frame_allocator_->Deallocate(extent.data_, extent.num_frames_ * PAGE_SIZE);
+  }
   delete replacer_;
 }
 
+bool BufferPoolManager::Resize(size_t new_size, std::chrono::milliseconds timeout) {
+  if (new_size == 0 || new_size > max_pool_size_) {
+    return false;
+  }
+  const std::lock_guard<std::mutex> resize_guard(resize_mutex_);
+  if (new_size >= pool_size_) {
+    GrowPool(new_size);
+    return true;
+  }
+  return ShrinkPool(new_size, timeout);
+}
+
+void BufferPoolManager::GrowPool(size_t new_size) {
+  // Back the new frames with memory before publishing them, until then nobody else can reach them. Frames that were
+  // retired may still have theirs, the extents always cover a prefix of the frames.
+  size_t backed_frames =
+      frame_extents_.empty() ? 0 : frame_extents_.back().first_frame_ + frame_extents_.back().num_frames_;
+  if (new_size > backed_frames) {
+    const size_t num_frames = new_size - backed_frames;
+    char *data = frame_allocator_->Allocate(num_frames * PAGE_SIZE);
+    for (size_t i = 0; i < num_frames; ++i) {
+      pages_[backed_frames + i].data_ = data + i * PAGE_SIZE;
+    }
+    frame_extents_.push_back({backed_frames, num_frames, data});
+  }
+
+  // the new frames are still reserved since construction or their retirement, as frames on the free list must be
+  const std::lock_guard<std::mutex> guard(latch_);
+  for (size_t i = pool_size_; i < new_size; ++i) {
+    free_list_.emplace_back(static_cast<frame_id_t>(i));
+  }
+  pool_size_ = new_size;
+}
+
+bool BufferPoolManager::ShrinkPool(size_t new_size, std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(latch_);
+  const size_t old_size = pool_size_;
+  // from here on no page is read into a retired frame, see FindReplacementFrame
+  pool_size_ = new_size;
+  free_list_.remove_if([new_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_size; });
+
+  // Every other retired frame holds a page. Frames only become reserved under the latch, so these are unpinned or
+  // pinned, and lock-free hits can still pin them until they are reserved here.
+  std::vector<frame_id_t> pending;
+  for (size_t i = new_size; i < old_size; ++i) {
+    if (pages_[i].pin_count_ != RESERVED_PIN_COUNT) {
+      pending.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    // evict what is unpinned, like FetchPageImpl does with its victim
+    std::vector<frame_id_t> pinned;
+    std::vector<PageIORequest> writes;
+    for (frame_id_t frame_id : pending) {
+      if (!TryReserveFrame(frame_id)) {
+        // unless DeletePageImpl freed the frame in the meantime, it leaves retired frames reserved
+        if (pages_[frame_id].pin_count_ != RESERVED_PIN_COUNT) {
+          pinned.push_back(frame_id);
+        }
+        continue;
+      }
+      Page *retired_page = &pages_[frame_id];
+      replacer_->Pin(frame_id);
+      page_table_.Remove(retired_page->GetPageId());
+      stats_.Add(BufferPoolCounter::EVICTIONS);
+      if (retired_page->IsDirty()) {
+        write_back_pages_.insert(retired_page->GetPageId());
+        writes.push_back({retired_page->GetPageId(), retired_page->GetData()});
+      }
+      retired_page->page_id_ = INVALID_PAGE_ID;
+      retired_page->is_dirty_ = false;
+    }
+    pending.swap(pinned);
+
+    if (!writes.empty()) {
+      lock.unlock();
+      disk_backend_->WritePages(writes);
+      lock.lock();
+      for (const PageIORequest &write : writes) {
+        write_back_pages_.erase(write.page_id_);
+      }
+      io_cv_.notify_all();
+    }
+
+    if (pending.empty()) {
+      break;
+    }
+    if (std::chrono::steady_clock::now() >= deadline) {
+      // Keep the old size. The frames evicted so far go back to the free list, the pinned ones back to the
+      // replacer, which victim searches may have taken them out of in the meantime.
+      for (size_t i = new_size; i < old_size; ++i) {
+        frame_id_t frame_id = static_cast<frame_id_t>(i);
+        if (std::find(pending.begin(), pending.end(), frame_id) == pending.end()) {
+          free_list_.push_back(frame_id);
+        }
+      }
+      for (frame_id_t frame_id : pending) {
+        replacer_->Unpin(frame_id);
+      }
+      pool_size_ = old_size;
+      return false;
+    }
+
+    // pins are dropped without the latch, poll for them
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    lock.lock();
+  }
+  lock.unlock();
+
+  // The retired frames are reserved, so nothing touches their memory anymore. Free the extents that only cover
+  // retired frames.
+  while (!frame_extents_.empty() && frame_extents_.back().first_frame_ >= new_size) {
+    const FrameExtent &extent = frame_extents_.back();
+    for (size_t i = 0; i < extent.num_frames_; ++i) {
+      pages_[extent.first_frame_ + i].data_ = nullptr;
+    }
+    frame_allocator_->Deallocate(extent.data_, extent.num_frames_ * PAGE_SIZE);
+    frame_extents_.pop_back();
+  }
+  return true;
+}
+
 Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  if (!BufferPoolStats::SampleFetchLatency()) {
+    return FetchPageFromPool(page_id);
+  }
+  auto start = std::chrono::steady_clock::now();
+  Page *page = FetchPageFromPool(page_id);
+  stats_.RecordFetchLatency(std::chrono::steady_clock::now() - start);
+  return page;
+}
+
+Page *BufferPoolManager::FetchPageFromPool(page_id_t page_id) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the
@@ -43,94 +227,140 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to
   // P.
-  const std::lock_guard<std::mutex> guard(latch_);
+  //
+  // Disk I/O is done without holding latch_: the frame is reserved under the latch (pinned, mapped to P and
+  // marked as I/O in progress), then R is written back and P is read in, so hits on other pages are not
+  // blocked by this miss. Fetchers of P wait until the read finished, fetchers of R until its write-back did.
+  //
+  // Hits do not take any mutex at all: the page table lookup is lock-free, and the frame is pinned with a CAS
+  // that fails while the frame is being replaced. The pinned frame must still hold P afterwards, otherwise the
+  // pin is undone and the latched path below is taken. The replacer is not told about pins at all; a victim it
+  // returns is only used if it can still be reserved (see FindReplacementFrame), and the frame is handed back to
+  // it when the last pin is released (see ReleaseFrame).
+  frame_id_t frame_id;
 
-  // try to find the page_id page in the bufferPool
-  // use bufferPool map <page, frame> , the buffer contains frames to storage page
-  std::unordered_map<page_id_t, frame_id_t>::iterator table_item_it = page_table_.find(page_id);
+  if (page_table_.Find(page_id, &frame_id) && TryPinFrame(frame_id)) {
+    Page *the_page_in_frame = &pages_[frame_id];
+    if (the_page_in_frame->GetPageId() == page_id && !io_in_progress_[frame_id]) {
+      stats_.Add(BufferPoolCounter::HITS);
+      return the_page_in_frame;
+    }
+    // the frame was replaced after the lookup, or the page is still being read in
+    const std::lock_guard<std::mutex> guard(latch_);
+    UnpinFrame(frame_id);
+  }
 
-  frame_id_t frame_id;
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // the page may have just been evicted and its dirty content still be on the way to disk,
+  // reading it back before the write finished would return stale data
+  if (write_back_pages_.count(page_id) != 0) {
+    stats_.Add(BufferPoolCounter::PIN_WAITS);
+    io_cv_.wait(lock, [&] { return write_back_pages_.count(page_id) == 0; });
+  }
 
+  // try to find the page_id page in the bufferPool
+  // use bufferPool map <page, frame> , the buffer contains frames to storage page
   // find the id page in bufferpool successfully
-  if (table_item_it != page_table_.end()) {
-    frame_id = table_item_it->second;
+  if (page_table_.Find(page_id, &frame_id)) {
     Page *the_page_in_frame = &pages_[frame_id];
     // the page in frame 's pin_count need +1
     // to point out another thread using the page which is storaged in buffer frame
+    // the frame is not taken out of the replacer, a pinned frame can not be reserved as victim frame
     ++the_page_in_frame->pin_count_;
-    // Pin this frame, can not be victim frame
-    replacer_->Pin(frame_id);
 
+    // another thread may still be reading the page in, our pin keeps the frame from being replaced while we wait
+    if (io_in_progress_[frame_id]) {
+      stats_.Add(BufferPoolCounter::PIN_WAITS);
+      io_cv_.wait(lock, [&] { return !io_in_progress_[frame_id]; });
+    }
+
+    stats_.Add(BufferPoolCounter::HITS);
     return the_page_in_frame;
   }
 
-  if (!free_list_.empty()) {
-    // use the free list the first front frame as frame will be used to storage the page
-    // move the needed page in the frame
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    bool victim_found = replacer_->Victim(&frame_id);
-    // try to find victim frame to storage the needed page
-    // the frame_id will be update to the victim frame id
-    if (!victim_found) {
-      return nullptr;
-    }
+  // try to find victim frame to storage the needed page
+  // the frame_id will be update to the victim frame id
+  if (!FindReplacementFrame(&frame_id)) {
+    return nullptr;
   }
+  stats_.Add(BufferPoolCounter::MISSES);
   // find victim successfully, frame_id update to the victim frame id
   Page *replacedPage_in_frame = &pages_[frame_id];
 
-  if (replacedPage_in_frame->IsDirty()) {
-    disk_manager_->WritePage(replacedPage_in_frame->GetPageId(), replacedPage_in_frame->GetData());
-    replacedPage_in_frame->is_dirty_ = false;
+  page_id_t replaced_page_id = replacedPage_in_frame->GetPageId();
+  bool replaced_is_dirty = replacedPage_in_frame->IsDirty();
+
+  page_table_.Remove(replaced_page_id);
+  if (replaced_page_id != INVALID_PAGE_ID) {
+    stats_.Add(BufferPoolCounter::EVICTIONS);
   }
 
-  page_table_.erase(replacedPage_in_frame->GetPageId());
+  replacedPage_in_frame->page_id_ = page_id;
+  replacedPage_in_frame->is_dirty_ = false;
+
+  // reserve the frame, then do the I/O without the latch
+  io_in_progress_[frame_id] = true;
+  if (replaced_is_dirty) {
+    write_back_pages_.insert(replaced_page_id);
+  }
 
   // create new element <page_id_t, frame_id_t> in page_table
-  page_table_.emplace(page_id, frame_id);
+  page_table_.Insert(page_id, frame_id);
 
-  replacedPage_in_frame->page_id_ = page_id;
+  // publishing the pin count makes the frame pinnable by lock-free hits, which then see the I/O flag
+  replacedPage_in_frame->pin_count_ = 1;
 
-  ++replacedPage_in_frame->pin_count_;
+  lock.unlock();
 
-  replacer_->Pin(frame_id);
+  if (replaced_is_dirty) {
+    disk_backend_->WritePage(replaced_page_id, replacedPage_in_frame->GetData());
+    stats_.Add(BufferPoolCounter::DIRTY_WRITEBACKS);
+    // the flusher is behind, let it catch up instead of waiting for its next round
+    flusher_cv_.notify_one();
+  }
+  disk_backend_->ReadPage(page_id, replacedPage_in_frame->GetData());
 
-  disk_manager_->ReadPage(page_id, replacedPage_in_frame->GetData());
+  lock.lock();
+  write_back_pages_.erase(replaced_page_id);
+  io_in_progress_[frame_id] = false;
+  lock.unlock();
+  io_cv_.notify_all();
 
   // now the needed page is storaged in the frame_id frame's replaced page's position
   return replacedPage_in_frame;
 }
 
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
-  const std::lock_guard<std::mutex> guard(latch_);
-
-  std::unordered_map<page_id_t, frame_id_t>::iterator table_item_it = page_table_.find(page_id);
+  // The caller's pin keeps the page in its frame, so like a hit in FetchPageImpl the frame is looked up without
+  // the latch. The lock-free lookup can miss while the page table is being modified, so retry a miss latched.
+  frame_id_t frame_id;
 
-  // can not find the page in the bufferPool frame
-  // this page is already unpined
-  if (table_item_it == page_table_.end()) {
-    return true;
+  if (!page_table_.Find(page_id, &frame_id) || pages_[frame_id].GetPageId() != page_id) {
+    const std::lock_guard<std::mutex> guard(latch_);
+    // can not find the page in the bufferPool frame
+    // this page is already unpined
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return true;
+    }
   }
 
-  frame_id_t frame_id = table_item_it->second;
-
   Page *thePage_in_frame = &pages_[frame_id];
 
-  int pin_count = thePage_in_frame->GetPinCount();
-
   if (is_dirty) {
     thePage_in_frame->is_dirty_ = true;
   }
 
-  if (pin_count <= 0) {
-    return false;
-  }
+  int pin_count = thePage_in_frame->pin_count_;
 
-  thePage_in_frame->pin_count_--;
+  do {
+    if (pin_count <= 0) {
+      return false;
+    }
+  } while (!thePage_in_frame->pin_count_.compare_exchange_weak(pin_count, pin_count - 1));
 
-  if (thePage_in_frame->GetPinCount() == 0) {
-    replacer_->Unpin(frame_id);
+  if (pin_count == 1) {
+    ReleaseFrame(frame_id);
   }
 
   return true;
@@ -142,17 +372,25 @@ bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
   // make sure the page_id is valid
   assert(page_id != INVALID_PAGE_ID);
 
-  const std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+
+  frame_id_t frame_id;
+
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return false;
+  }
 
-  std::unordered_map<page_id_t, frame_id_t>::iterator table_item_it = page_table_.find(page_id);
+  // the frame content is not valid until the read into it finished
+  io_cv_.wait(lock, [&] { return !io_in_progress_[frame_id]; });
 
-  if (table_item_it == page_table_.end()) {
+  // the page may have been replaced while we waited
+  if (pages_[frame_id].GetPageId() != page_id) {
     return false;
   }
 
-  Page *thePage_in_frame = &pages_[table_item_it->second];
+  Page *thePage_in_frame = &pages_[frame_id];
 
-  disk_manager_->WritePage(thePage_in_frame->GetPageId(), thePage_in_frame->GetData());
+  disk_backend_->WritePage(thePage_in_frame->GetPageId(), thePage_in_frame->GetData());
 
   thePage_in_frame->is_dirty_ = false;
 
@@ -160,13 +398,13 @@ bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
 }
 
 Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
-  // 0.   Make sure you call DiskManager::AllocatePage!
+  // 0.   Page ids come from AllocatePage(), so they always route back to this instance.
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the
   // free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  const std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
 
   bool all_pinned = true;
 
@@ -184,36 +422,49 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
 
   frame_id_t frame_id;
 
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    bool victim_found = replacer_->Victim(&frame_id);
-    if (!victim_found) {
-      return nullptr;
-    }
+  if (!FindReplacementFrame(&frame_id)) {
+    return nullptr;
   }
 
   Page *replacedPage_in_frame = &pages_[frame_id];
 
-  if (replacedPage_in_frame->IsDirty()) {
-    disk_manager_->WritePage(replacedPage_in_frame->GetPageId(), replacedPage_in_frame->GetData());
-    replacedPage_in_frame->is_dirty_ = false;
-  }
+  page_id_t replaced_page_id = replacedPage_in_frame->GetPageId();
+  bool replaced_is_dirty = replacedPage_in_frame->IsDirty();
 
-  page_table_.erase(replacedPage_in_frame->GetPageId());
+  page_table_.Remove(replaced_page_id);
+  if (replaced_page_id != INVALID_PAGE_ID) {
+    stats_.Add(BufferPoolCounter::EVICTIONS);
+  }
 
-  page_id_t new_page_id = disk_manager_->AllocatePage();
+  page_id_t new_page_id = AllocatePage();
 
   replacedPage_in_frame->page_id_ = new_page_id;
+  replacedPage_in_frame->is_dirty_ = false;
 
-  replacedPage_in_frame->pin_count_++;
+  // like FetchPageImpl, write back the replaced page without holding the latch
+  io_in_progress_[frame_id] = true;
+  if (replaced_is_dirty) {
+    write_back_pages_.insert(replaced_page_id);
+  }
 
-  replacedPage_in_frame->ResetMemory();
+  page_table_.Insert(new_page_id, frame_id);
 
-  replacer_->Pin(frame_id);
+  replacedPage_in_frame->pin_count_ = 1;
 
-  page_table_.emplace(new_page_id, frame_id);
+  lock.unlock();
+
+  if (replaced_is_dirty) {
+    disk_backend_->WritePage(replaced_page_id, replacedPage_in_frame->GetData());
+    stats_.Add(BufferPoolCounter::DIRTY_WRITEBACKS);
+    flusher_cv_.notify_one();
+  }
+  replacedPage_in_frame->ResetMemory();
+
+  lock.lock();
+  write_back_pages_.erase(replaced_page_id);
+  io_in_progress_[frame_id] = false;
+  lock.unlock();
+  io_cv_.notify_all();
 
   *page_id = new_page_id;
 
@@ -230,51 +481,254 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // it to the free list.
   const std::lock_guard<std::mutex> guard(latch_);
 
-  std::unordered_map<page_id_t, frame_id_t>::iterator table_item_it = page_table_.find(page_id);
+  frame_id_t frame_id;
 
-  if (table_item_it == page_table_.end()) {
+  if (!page_table_.Find(page_id, &frame_id)) {
     return true;
   }
 
-  frame_id_t frame_id = table_item_it->second;
-
   Page *replacedPage_in_frame = &pages_[frame_id];
 
   // the page still used by some thread, can not deleted(replaced)
-  if (replacedPage_in_frame->GetPinCount() != 0) {
+  if (!TryReserveFrame(frame_id)) {
     return false;
   }
 
   if (replacedPage_in_frame->IsDirty()) {
-    disk_manager_->WritePage(replacedPage_in_frame->GetPageId(), replacedPage_in_frame->GetData());
+    disk_backend_->WritePage(replacedPage_in_frame->GetPageId(), replacedPage_in_frame->GetData());
     replacedPage_in_frame->is_dirty_ = false;
   }
 
-  page_table_.erase(replacedPage_in_frame->GetPageId());
+  page_table_.Remove(replacedPage_in_frame->GetPageId());
 
   disk_manager_->DeallocatePage(page_id);
 
+  // the frame stays reserved while it is on the free list
   replacedPage_in_frame->ResetMemory();
   replacedPage_in_frame->page_id_ = INVALID_PAGE_ID;
-  replacedPage_in_frame->pin_count_ = 0;
   replacedPage_in_frame->is_dirty_ = false;
 
-  free_list_.push_back(frame_id);
+  // a frame that a shrinking Resize is retiring is done now
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.push_back(frame_id);
+  }
 
   return true;
 }
 
 void BufferPoolManager::FlushAllPagesImpl() {
   // You can do it!
-  const std::lock_guard<std::mutex> guard(latch_);
-
-  for (size_t i = 0; i < pool_size_; i++) {
-    Page *thePage_in_frame = &pages_[i];
-    if (thePage_in_frame->page_id_ != INVALID_PAGE_ID && thePage_in_frame->IsDirty()) {
-      disk_manager_->WritePage(thePage_in_frame->GetPageId(), thePage_in_frame->GetData());
+  // Snapshot the dirty pages under the latch and pin them, so they stay in their frames while they are written.
+  std::vector<frame_id_t> dirty_frames;
+  // dirty pages that were replaced before the snapshot, their evicting thread is still writing them back
+  std::vector<page_id_t> write_backs;
+  {
+    const std::lock_guard<std::mutex> guard(latch_);
+    write_backs.assign(write_back_pages_.begin(), write_back_pages_.end());
+    // not just up to pool_size_, a shrinking Resize may be waiting for dirty pages in the frames it retires
+    for (size_t i = 0; i < max_pool_size_; i++) {
+      frame_id_t frame_id = static_cast<frame_id_t>(i);
+      Page *thePage_in_frame = &pages_[i];
+      // pages being read in are clean, reserved frames are either free or written back by their replacer
+      if (!thePage_in_frame->IsDirty() || io_in_progress_[frame_id] || !TryPinFrame(frame_id)) {
+        continue;
+      }
+      // like FlushFrameInBackground, an update racing with the write dirties the page again
       thePage_in_frame->is_dirty_ = false;
+      dirty_frames.push_back(frame_id);
+    }
+  }
+
+  // in page id order the writes become sequential on disk
+  std::sort(dirty_frames.begin(), dirty_frames.end(),
+            [this](frame_id_t a, frame_id_t b) { return pages_[a].GetPageId() < pages_[b].GetPageId(); });
+
+  // one batch, so that the disk backend can keep all of the writes in flight and merge the consecutive ones
+  std::vector<PageIORequest> writes;
+  writes.reserve(dirty_frames.size());
+  for (frame_id_t frame_id : dirty_frames) {
+    writes.push_back({pages_[frame_id].GetPageId(), pages_[frame_id].GetData()});
+  }
+  disk_backend_->WritePages(writes);
+
+  for (frame_id_t frame_id : dirty_frames) {
+    DropFlushPin(frame_id);
+  }
+
+  // the replaced pages are no longer in any frame, but they are not on disk before their write-backs finished
+  if (!write_backs.empty()) {
+    std::unique_lock<std::mutex> lock(latch_);
+    io_cv_.wait(lock, [&] {
+      return std::none_of(write_backs.begin(), write_backs.end(),
+                          [this](page_id_t page_id) { return write_back_pages_.count(page_id) != 0; });
+    });
+  }
+}
+
+void BufferPoolManager::StartBackgroundFlusher(size_t low_watermark, size_t high_watermark,
+                                               std::chrono::milliseconds interval) {
+  BUSTUB_ASSERT(low_watermark <= high_watermark, "the flusher must stop above the point where it starts");
+  const std::lock_guard<std::mutex> guard(flusher_mutex_);
+  if (flusher_running_) {
+    return;
+  }
+  flusher_low_watermark_ = low_watermark;
+  flusher_high_watermark_ = std::min(high_watermark, max_pool_size_);
+  flusher_interval_ = interval;
+  flusher_running_ = true;
+  flusher_thread_ = std::thread(&BufferPoolManager::BackgroundFlusherLoop, this);
+}
+
+void BufferPoolManager::StopBackgroundFlusher() {
+  {
+    const std::lock_guard<std::mutex> guard(flusher_mutex_);
+    if (!flusher_running_) {
+      return;
     }
+    flusher_running_ = false;
   }
+  flusher_cv_.notify_one();
+  flusher_thread_.join();
+}
+
+void BufferPoolManager::BackgroundFlusherLoop() {
+  std::unique_lock<std::mutex> lock(flusher_mutex_);
+  while (flusher_running_) {
+    lock.unlock();
+
+    size_t clean_frames = CountCleanFrames();
+    // a concurrent Resize may change the pool size, retired frames are reserved and skipped
+    const size_t pool_size = pool_size_;
+    if (clean_frames < flusher_low_watermark_) {
+      // one sweep over the pool at most, the pages that are still dirty afterwards are all pinned
+      for (size_t i = 0; i < pool_size && clean_frames < flusher_high_watermark_; i++) {
+        flusher_cursor_ %= pool_size;
+        frame_id_t frame_id = static_cast<frame_id_t>(flusher_cursor_);
+        flusher_cursor_ = (flusher_cursor_ + 1) % pool_size;
+        if (FlushFrameInBackground(frame_id)) {
+          clean_frames++;
+        }
+      }
+    }
+
+    lock.lock();
+    flusher_cv_.wait_for(lock, flusher_interval_);
+  }
+}
+
+size_t BufferPoolManager::CountCleanFrames() {
+  size_t clean_frames;
+  {
+    const std::lock_guard<std::mutex> guard(latch_);
+    clean_frames = free_list_.size();
+  }
+  const size_t pool_size = pool_size_;
+  for (size_t i = 0; i < pool_size; i++) {
+    if (pages_[i].pin_count_ == 0 && !pages_[i].is_dirty_) {
+      clean_frames++;
+    }
+  }
+  return clean_frames;
+}
+
+bool BufferPoolManager::FlushFrameInBackground(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  // cheap checks first, pinned pages are in use and will likely be dirtied again
+  if (page->pin_count_ != 0 || !page->is_dirty_) {
+    return false;
+  }
+  if (!TryPinFrame(frame_id)) {
+    return false;
+  }
+
+  bool written = false;
+  const page_id_t page_id = page->GetPageId();
+  // the page may have been replaced between the checks and the pin, or still be read in
+  if (page_id != INVALID_PAGE_ID && !io_in_progress_[frame_id] && page->is_dirty_) {
+    // clear the flag before writing, an update racing with the write dirties the page again and is not lost
+    page->is_dirty_ = false;
+    disk_backend_->WritePage(page_id, page->GetData());
+    stats_.Add(BufferPoolCounter::BACKGROUND_WRITEBACKS);
+    written = true;
+  }
+
+  DropFlushPin(frame_id);
+  return written;
+}
+
+void BufferPoolManager::DropFlushPin(frame_id_t frame_id) {
+  // The frame is still in the replacer from its last release unless a victim search dropped it while we held the
+  // pin. Unpin puts it back in that case and leaves its position alone otherwise.
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+bool BufferPoolManager::FindReplacementFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    // use the free list the first front frame as frame will be used to storage the page
+    // frames on the free list are already reserved
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  while (replacer_->Victim(frame_id)) {
+    if (static_cast<size_t>(*frame_id) >= pool_size_) {
+      // the frame is being retired by a shrinking Resize, which evicts its page itself
+      continue;
+    }
+    if (TryReserveFrame(*frame_id)) {
+      return true;
+    }
+    // the frame was pinned by a lock-free hit after it entered the replacer,
+    // it is handed back to the replacer when that pin is released, with the history of its page
+    if (lru_k_replacer_ != nullptr) {
+      lru_k_replacer_->Restore(*frame_id);
+    }
+  }
+  return false;
+}
+
+bool BufferPoolManager::TryPinFrame(frame_id_t frame_id) {
+  std::atomic<int> &pin_count = pages_[frame_id].pin_count_;
+  int expected = pin_count;
+  while (expected >= 0) {
+    if (pin_count.compare_exchange_weak(expected, expected + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BufferPoolManager::TryReserveFrame(frame_id_t frame_id) {
+  int expected = 0;
+  return pages_[frame_id].pin_count_.compare_exchange_strong(expected, RESERVED_PIN_COUNT);
+}
+
+void BufferPoolManager::UnpinFrame(frame_id_t frame_id) {
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    ReleaseFrame(frame_id);
+  }
+}
+
+void BufferPoolManager::ReleaseFrame(frame_id_t frame_id) {
+  // Fetches never touch the replacer, so this Pin/Unpin pair is the one access the replacer sees per use of the
+  // frame. The frame may still sit in the replacer from an older release, pinning first moves it to the most
+  // recently used end.
+  replacer_->Pin(frame_id);
+  replacer_->Unpin(frame_id);
+}
+
+page_id_t BufferPoolManager::AllocatePage() {
+  // hand out ids in this instance's residue class so that page_id % num_instances_ routes back here
+  const page_id_t next_page_id = next_page_id_;
+  next_page_id_ += num_instances_;
+  ValidatePageId(next_page_id);
+  return next_page_id;
+}
+
+void BufferPoolManager::ValidatePageId(const page_id_t page_id) const {
+  assert(page_id % num_instances_ == instance_index_);
 }
 
 }  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <sstream>
+
+namespace bustub {
+
+namespace {
+
+constexpr const char *COUNTER_NAMES[] = {"hits",   "misses", "evictions", "dirty_writebacks", "background_writebacks",
+                                         "pin_waits"};
+static_assert(sizeof(COUNTER_NAMES) / sizeof(COUNTER_NAMES[0]) == static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS),
+              "every counter needs a name");
+
+constexpr double REPORTED_PERCENTILES[] = {50, 90, 99, 99.9};
+
+/** @return upper bound in ns of a latency histogram bucket */
+uint64_t BucketUpperBound(size_t bucket) { return uint64_t{1} << (bucket + 1); }
+
+}  // namespace
+
+double BufferPoolStatsSnapshot::HitRatio() const {
+  uint64_t fetches = Get(BufferPoolCounter::HITS) + Get(BufferPoolCounter::MISSES);
+  return fetches == 0 ? 0 : static_cast<double>(Get(BufferPoolCounter::HITS)) / fetches;
+}
+
+uint64_t BufferPoolStatsSnapshot::FetchLatencyPercentile(double percentile) const {
+  uint64_t total = 0;
+  for (uint64_t count : fetch_latency_histogram_) {
+    total += count;
+  }
+  if (total == 0) {
+    return 0;
+  }
+  // rank of the percentile fetch, counting from 1
+  auto rank = static_cast<uint64_t>(percentile / 100 * total);
+  rank = rank == 0 ? 1 : rank;
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; i++) {
+    seen += fetch_latency_histogram_[i];
+    if (seen >= rank) {
+      return BucketUpperBound(i);
+    }
+  }
+  return BucketUpperBound(NUM_LATENCY_BUCKETS - 1);
+}
+
+std::string BufferPoolStatsSnapshot::ToString() const {
+  std::ostringstream out;
+  for (size_t i = 0; i < counters_.size(); i++) {
+    out << COUNTER_NAMES[i] << ": " << counters_[i] << "\n";
+  }
+  out << "hit_ratio: " << HitRatio() << "\n";
+  for (double percentile : REPORTED_PERCENTILES) {
+    out << "fetch_latency_p" << percentile << ": <" << FetchLatencyPercentile(percentile) << "ns\n";
+  }
+  return out.str();
+}
+
+std::string BufferPoolStatsSnapshot::ToJson() const {
+  std::ostringstream out;
+  out << "{";
+  for (size_t i = 0; i < counters_.size(); i++) {
+    out << "\"" << COUNTER_NAMES[i] << "\":" << counters_[i] << ",";
+  }
+  out << "\"hit_ratio\":" << HitRatio() << ",";
+  // only the non-empty buckets, as [upper bound in ns, count] pairs
+  out << "\"fetch_latency_ns\":{\"histogram\":[";
+  bool first = true;
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; i++) {
+    if (fetch_latency_histogram_[i] == 0) {
+      continue;
+    }
+    out << (first ? "" : ",") << "[" << BucketUpperBound(i) << "," << fetch_latency_histogram_[i] << "]";
+    first = false;
+  }
+  out << "]";
+  for (double percentile : REPORTED_PERCENTILES) {
+    out << ",\"p" << percentile << "\":" << FetchLatencyPercentile(percentile);
+  }
+  out << "}}";
+  return out.str();
+}
+
+BufferPoolStatsSnapshot &BufferPoolStatsSnapshot::operator+=(const BufferPoolStatsSnapshot &other) {
+  for (size_t i = 0; i < counters_.size(); i++) {
+    counters_[i] += other.counters_[i];
+  }
+  for (size_t i = 0; i < NUM_LATENCY_BUCKETS; i++) {
+    fetch_latency_histogram_[i] += other.fetch_latency_histogram_[i];
+  }
+  return *this;
+}
+
+void BufferPoolStats::RecordFetchLatency(std::chrono::nanoseconds latency) {
+  // bucket i holds [2^i, 2^(i+1)) ns, that is the index of the highest set bit
+  auto ns = static_cast<uint64_t>(latency.count());
+  size_t bucket = ns == 0 ? 0 : 63 - __builtin_clzll(ns);
+  if (bucket >= BufferPoolStatsSnapshot::NUM_LATENCY_BUCKETS) {
+    bucket = BufferPoolStatsSnapshot::NUM_LATENCY_BUCKETS - 1;
+  }
+  GetShard().fetch_latency_histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+BufferPoolStatsSnapshot BufferPoolStats::Snapshot() const {
+  BufferPoolStatsSnapshot snapshot;
+  for (const Shard &shard : shards_) {
+    for (size_t i = 0; i < snapshot.counters_.size(); i++) {
+      snapshot.counters_[i] += shard.counters_[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < BufferPoolStatsSnapshot::NUM_LATENCY_BUCKETS; i++) {
+      snapshot.fetch_latency_histogram_[i] += shard.fetch_latency_histogram_[i].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+BufferPoolStats::Shard &BufferPoolStats::GetShard() {
+  // the shard index is per thread, not per BufferPoolStats: a thread uses the same slot in every buffer pool
+  static std::atomic<size_t> next_shard{0};
+  static thread_local const size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+  return shards_[shard];
+}
+
+}  // namespace bustub
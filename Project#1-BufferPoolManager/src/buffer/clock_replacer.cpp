@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_replacer.cpp
+//
+// Identification: src/buffer/clock_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/clock_replacer.h"
+
+namespace bustub {
+
+ClockReplacer::ClockReplacer(size_t num_pages) : in_replacer_(num_pages, false), ref_bits_(num_pages, false) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * 从clock_hand_开始顺时针扫描:
+ * 1.帧不在replacer中,跳过
+ * 2.帧在replacer中且ref位为1,把ref位清0,继续扫描
+ * 3.帧在replacer中且ref位为0,它就是牺牲帧
+ * 每一圈最多清一次ref位,所以最多扫描两圈
+ */
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  if (size_ == 0) {
+    return false;
+  }
+
+  const size_t num_frames = in_replacer_.size();
+  while (true) {
+    size_t frame = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % num_frames;
+    if (!in_replacer_[frame]) {
+      continue;
+    }
+    if (ref_bits_[frame]) {
+      ref_bits_[frame] = false;
+      continue;
+    }
+    in_replacer_[frame] = false;
+    size_--;
+    *frame_id = static_cast<frame_id_t>(frame);
+    return true;
+  }
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  if (in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = false;
+    size_--;
+  }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  // unpinning a frame that is already in the replacer does not give it a second chance
+  if (!in_replacer_[frame_id]) {
+    in_replacer_[frame_id] = true;
+    ref_bits_[frame_id] = true;
+    size_++;
+  }
+}
+
+size_t ClockReplacer::Size() {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  return size_;
+}
+
+}  // namespace bustub
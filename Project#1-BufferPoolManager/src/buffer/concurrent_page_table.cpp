@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.cpp
+//
+// Identification: src/buffer/concurrent_page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/concurrent_page_table.h"
+
+#include <cassert>
+
+namespace bustub {
+
+ConcurrentPageTable::ConcurrentPageTable(size_t num_frames) {
+  // keep the load factor at or below 1/2 so probe sequences stay short
+  size_t num_slots = 2;
+  int bits = 1;
+  while (num_slots < 2 * num_frames) {
+    num_slots <<= 1;
+    bits++;
+  }
+  mask_ = num_slots - 1;
+  hash_shift_ = 64 - bits;
+  slots_ = std::vector<std::atomic<uint64_t>>(num_slots);
+  for (auto &slot : slots_) {
+    slot.store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+size_t ConcurrentPageTable::HomeSlot(page_id_t page_id) const {
+  // Fibonacci hashing, page ids of a ParallelBufferPoolManager instance are strided and must not cluster
+  return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                             hash_shift_);
+}
+
+bool ConcurrentPageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  size_t index = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++, index = (index + 1) & mask_) {
+    uint64_t slot = slots_[index].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (SlotPageId(slot) == page_id) {
+      *frame_id = SlotFrameId(slot);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ConcurrentPageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  assert(page_id != INVALID_PAGE_ID);
+  size_t index = HomeSlot(page_id);
+  for (size_t probes = 0; probes <= mask_; probes++, index = (index + 1) & mask_) {
+    uint64_t slot = slots_[index].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || SlotPageId(slot) == page_id) {
+      slots_[index].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+  assert(false && "page table is full");
+}
+
+bool ConcurrentPageTable::Remove(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  size_t hole = HomeSlot(page_id);
+  for (size_t probes = 0;; probes++, hole = (hole + 1) & mask_) {
+    uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || probes > mask_) {
+      return false;
+    }
+    if (SlotPageId(slot) == page_id) {
+      break;
+    }
+  }
+
+  // Backward shift deletion: move every following entry of the probe run whose home slot lies at or before the
+  // hole into the hole. The entry is copied before its old slot is overwritten, so concurrent readers see it
+  // twice rather than never, except for a reader that passed the hole before the copy.
+  for (size_t index = (hole + 1) & mask_;; index = (index + 1) & mask_) {
+    uint64_t slot = slots_[index].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeSlot(SlotPageId(slot));
+    if (((index - home) & mask_) >= ((index - hole) & mask_)) {
+      slots_[hole].store(slot, std::memory_order_release);
+      hole = index;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_allocator.cpp
+//
+// Identification: src/buffer/frame_allocator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_allocator.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+char *DefaultFrameAllocator::Allocate(size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+  // aligned_alloc wants the size to be a multiple of the alignment
+  size_t aligned_size = (size + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+  auto *region = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, aligned_size));
+  if (region == nullptr) {
+    throw std::bad_alloc();
+  }
+  memset(region, 0, size);
+  return region;
+}
+
+void DefaultFrameAllocator::Deallocate(char *region, size_t size) { std::free(region); }
+
+DefaultFrameAllocator *DefaultFrameAllocator::Instance() {
+  static DefaultFrameAllocator allocator;
+  return &allocator;
+}
+
+HugePageFrameAllocator::~HugePageFrameAllocator() {
+  BUSTUB_ASSERT(mappings_.empty(), "every region must be freed before its allocator");
+}
+
+char *HugePageFrameAllocator::Allocate(size_t size) {
+  if (size == 0) {
+    return nullptr;
+  }
+  const size_t length = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  char *region = nullptr;
+  Backing backing = Backing::HUGETLB;
+
+  // anonymous mappings come zeroed, there is no need to touch the memory here
+  void *mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (mapped != MAP_FAILED) {
+    region = static_cast<char *>(mapped);
+  } else {
+    // No reserved huge pages. Transparent huge pages need a huge page aligned range, so map one huge page more than
+    // needed and trim the unaligned head and the tail.
+    backing = Backing::TRANSPARENT_HUGE_PAGES;
+    mapped = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped != MAP_FAILED) {
+      auto address = reinterpret_cast<uintptr_t>(mapped);
+      uintptr_t aligned = (address + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+      size_t head = aligned - address;
+      if (head > 0) {
+        munmap(mapped, head);
+      }
+      munmap(reinterpret_cast<char *>(aligned) + length, HUGE_PAGE_SIZE - head);
+      region = reinterpret_cast<char *>(aligned);
+      // only a hint, the kernel may have transparent huge pages disabled
+      madvise(region, length, MADV_HUGEPAGE);
+    } else {
+      backing = Backing::HEAP;
+      region = DefaultFrameAllocator::Instance()->Allocate(size);
+    }
+  }
+
+  const std::lock_guard<std::mutex> guard(mutex_);
+  mappings_.emplace(region, Mapping{backing, length});
+  return region;
+}
+
+void HugePageFrameAllocator::Deallocate(char *region, size_t size) {
+  if (region == nullptr) {
+    return;
+  }
+  Mapping mapping;
+  {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    auto it = mappings_.find(region);
+    BUSTUB_ASSERT(it != mappings_.end(), "region was not allocated by this allocator");
+    mapping = it->second;
+    mappings_.erase(it);
+  }
+  if (mapping.backing_ == Backing::HEAP) {
+    DefaultFrameAllocator::Instance()->Deallocate(region, size);
+  } else {
+    munmap(region, mapping.length_);
+  }
+}
+
+HugePageFrameAllocator::Backing HugePageFrameAllocator::GetBacking(char *region) {
+  const std::lock_guard<std::mutex> guard(mutex_);
+  auto it = mappings_.find(region);
+  BUSTUB_ASSERT(it != mappings_.end(), "region was not allocated by this allocator");
+  return it->second.backing_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,146 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_reference_period)
+    : k_(k), correlated_reference_period_(correlated_reference_period), frames_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs at least one access of history");
+  for (auto &frame : frames_) {
+    frame.history.resize(k_, 0);
+  }
+  last_victim_history_.history.resize(k_, 0);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+LRUKReplacer::EvictionKey LRUKReplacer::GetEvictionKey(frame_id_t frame_id) const {
+  const FrameHistory &frame = frames_[frame_id];
+  // fewer than K accesses is an infinite backward K-distance, the smallest possible timestamp
+  uint64_t kth_access = frame.num_accesses < k_ ? 0 : frame.history[(frame.newest + 1) % k_];
+  return {kth_access, frame.last_access, frame_id};
+}
+
+/**
+ * 从可牺牲的帧中选出backward K-distance最大的帧:
+ * 1.访问次数不足K次的帧距离为无穷大,最先被牺牲,它们之间按最近一次访问的先后(LRU)排序
+ * 2.在相关访问期(correlated reference period)内刚被访问过的帧暂时不能被牺牲,除非没有别的帧可选
+ * 3.被牺牲的帧将装入新的page,清空它的访问历史,旧的历史先保留下来,以便Restore还原
+ */
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  if (evictable_frames_.empty()) {
+    return false;
+  }
+
+  // the victim makes room for the next access, which happens at current_time_ + 1
+  auto victim_it = evictable_frames_.begin();
+  for (auto it = evictable_frames_.begin(); it != evictable_frames_.end(); ++it) {
+    if (current_time_ + 1 - std::get<1>(*it) > correlated_reference_period_) {
+      victim_it = it;
+      break;
+    }
+  }
+
+  *frame_id = std::get<2>(*victim_it);
+  evictable_frames_.erase(victim_it);
+
+  FrameHistory &frame = frames_[*frame_id];
+  // keep the history for Restore, the frame takes over the buffer of the previous victim's
+  last_victim_ = *frame_id;
+  std::swap(frame, last_victim_history_);
+  std::fill(frame.history.begin(), frame.history.end(), 0);
+  frame.newest = 0;
+  frame.num_accesses = 0;
+  frame.last_access = 0;
+  frame.evictable = false;
+  return true;
+}
+
+void LRUKReplacer::Restore(frame_id_t frame_id) {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  if (frame_id != last_victim_) {
+    return;
+  }
+  last_victim_ = -1;
+
+  // the pin that kept the page in the frame may have been released already, and the frame be evictable again
+  FrameHistory &frame = frames_[frame_id];
+  bool evictable = frame.evictable;
+  if (evictable) {
+    evictable_frames_.erase(GetEvictionKey(frame_id));
+  }
+  std::swap(frame, last_victim_history_);
+  frame.evictable = evictable;
+  if (evictable) {
+    evictable_frames_.insert(GetEvictionKey(frame_id));
+  }
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable) {
+    evictable_frames_.erase(GetEvictionKey(frame_id));
+    frame.evictable = false;
+  }
+
+  uint64_t now = ++current_time_;
+  if (frame.num_accesses > 0 && now - frame.last_access <= correlated_reference_period_) {
+    // correlated access, only the last access time moves
+    frame.last_access = now;
+    return;
+  }
+
+  if (frame.num_accesses > 0) {
+    // the previous burst of correlated accesses counts as a single access at the end of the burst,
+    // shift the older history forward by the length of the burst
+    uint64_t correlated_period = frame.last_access - frame.history[frame.newest];
+    for (auto &access : frame.history) {
+      if (access != 0) {
+        access += correlated_period;
+      }
+    }
+  }
+  frame.newest = (frame.newest + 1) % k_;
+  frame.history[frame.newest] = now;
+  frame.num_accesses++;
+  frame.last_access = now;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  FrameHistory &frame = frames_[frame_id];
+  if (frame.evictable) {
+    return;
+  }
+  frame.evictable = true;
+  evictable_frames_.insert(GetEvictionKey(frame_id));
+}
+
+size_t LRUKReplacer::Size() {
+  const std::lock_guard<mutex_t> guard(mutex_);
+
+  return evictable_frames_.size();
+}
+
+}  // namespace bustub
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+namespace bustub {
+
+// the base class owns no frames itself, all frames live in the instances
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, FrameAllocator *frame_allocator,
+                                                     DiskBackend *disk_backend, size_t max_pool_size, size_t lru_k,
+                                                     uint64_t lru_k_correlated_reference_period)
+    : BufferPoolManager(0, disk_manager, log_manager) {
+  // Allocate and create individual BufferPoolManager instances
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.push_back(new BufferPoolManager(pool_size, static_cast<uint32_t>(num_instances),
+                                               static_cast<uint32_t>(i), disk_manager, log_manager, replacer_type,
+                                               frame_allocator, disk_backend, max_pool_size, lru_k,
+                                               lru_k_correlated_reference_period));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t new_size, std::chrono::milliseconds timeout) {
+  if (new_size < instances_.size() || new_size > GetMaxPoolSize()) {
+    return false;
+  }
+  // the first new_size % num_instances instances get one frame more
+  for (size_t i = 0; i < instances_.size(); i++) {
+    size_t instance_size = new_size / instances_.size() + (i < new_size % instances_.size() ? 1 : 0);
+    if (!instances_[i]->Resize(instance_size, timeout)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t ParallelBufferPoolManager::GetMaxPoolSize() {
+  size_t max_pool_size = 0;
+  for (auto *instance : instances_) {
+    max_pool_size += instance->GetMaxPoolSize();
+  }
+  return max_pool_size;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(size_t low_watermark, size_t high_watermark,
+                                                       std::chrono::milliseconds interval) {
+  for (auto *instance : instances_) {
+    instance->StartBackgroundFlusher(low_watermark, high_watermark, interval);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto *instance : instances_) {
+    instance->StopBackgroundFlusher();
+  }
+}
+
+BufferPoolStatsSnapshot ParallelBufferPoolManager::GetStats() {
+  BufferPoolStatsSnapshot stats;
+  for (auto *instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
+  return instances_[page_id % instances_.size()];
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  // Fetch page for page_id from responsible BufferPoolManager
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  // Unpin page_id from responsible BufferPoolManager
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  // Flush page_id from responsible BufferPoolManager
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) {
+  // 1.   From a starting index of the BPMIs, call NewPage until either 1) success and return 2) looped around to
+  // starting index and return nullptr
+  // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
+  // is called
+  const size_t num_instances = instances_.size();
+  const size_t start_index = next_instance_.fetch_add(1) % num_instances;
+
+  for (size_t i = 0; i < num_instances; i++) {
+    Page *page = instances_[(start_index + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  // Delete page_id from responsible BufferPoolManager
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // flush all pages from all BufferPoolManagers
+  for (auto *instance : instances_) {
+    instance->FlushAllPages();
+  }
+}
+
+}  // namespace bustub
@@ -12,12 +12,23 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/concurrent_page_table.h"
+#include "buffer/frame_allocator.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
+#include "storage/disk/disk_backend.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
@@ -31,18 +42,60 @@ class BufferPoolManager {
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
 
+  /** The replacement policies the buffer pool can be created with. */
+  enum class ReplacerType { LRU, CLOCK, LRU_K };
+
+  /** Default K of the LRU-K replacement policy. */
+  static constexpr size_t DEFAULT_LRU_K = 2;
+  /** Default correlated reference period of the LRU-K replacement policy, in page accesses. */
+  static constexpr uint64_t DEFAULT_LRU_K_CORRELATED_REFERENCE_PERIOD = 0;
+  /** How often the background flusher checks the clean frame count when nothing wakes it up earlier. */
+  static constexpr std::chrono::milliseconds DEFAULT_FLUSH_INTERVAL{10};
+  /** How long Resize waits for the pages in the frames it retires to be unpinned. */
+  static constexpr std::chrono::milliseconds DEFAULT_RESIZE_TIMEOUT{1000};
+
   /**
    * Creates a new BufferPoolManager.
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param frame_allocator where the frame memory comes from, nullptr for DefaultFrameAllocator
+   * @param disk_backend what reads and writes the pages, nullptr to do it through disk_manager
+   * @param max_pool_size the size Resize can grow the buffer pool to, 0 for pool_size
+   * @param lru_k K of the LRU-K replacement policy, only used with ReplacerType::LRU_K
+   * @param lru_k_correlated_reference_period correlated reference period of the LRU-K replacement policy
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                    ReplacerType replacer_type = ReplacerType::LRU, FrameAllocator *frame_allocator = nullptr,
+                    DiskBackend *disk_backend = nullptr, size_t max_pool_size = 0, size_t lru_k = DEFAULT_LRU_K,
+                    uint64_t lru_k_correlated_reference_period = DEFAULT_LRU_K_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Creates a new BufferPoolManager that is one shard of a ParallelBufferPoolManager.
+   * The shard only allocates page ids with page_id % num_instances == instance_index.
+   * @param pool_size the size of this shard's buffer pool
+   * @param num_instances the total number of shards
+   * @param instance_index the index of this shard, in [0, num_instances)
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param frame_allocator where the frame memory comes from, nullptr for DefaultFrameAllocator
+   * @param disk_backend what reads and writes the pages, nullptr to do it through disk_manager
+   * @param max_pool_size the size Resize can grow this shard's buffer pool to, 0 for pool_size
+   * @param lru_k K of the LRU-K replacement policy, only used with ReplacerType::LRU_K
+   * @param lru_k_correlated_reference_period correlated reference period of the LRU-K replacement policy
+   */
+  BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index, DiskManager *disk_manager,
+                    LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                    FrameAllocator *frame_allocator = nullptr, DiskBackend *disk_backend = nullptr,
+                    size_t max_pool_size = 0, size_t lru_k = DEFAULT_LRU_K,
+                    uint64_t lru_k_correlated_reference_period = DEFAULT_LRU_K_CORRELATED_REFERENCE_PERIOD);
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -95,7 +148,52 @@ class BufferPoolManager {
   Page *GetPages() { return pages_; }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  /**
+   * Changes the number of frames while the buffer pool is in use.
+   *
+   * Growing adds the new frames to the free list. Shrinking retires the frames with the highest ids: from the start no
+   * page is read into them anymore, their unpinned pages are evicted, dirty ones written back, and pinned pages are
+   * waited for until they are unpinned. Frame memory goes back to the frame allocator once every frame it was
+   * allocated for is retired. If a page is still pinned when the timeout expires, the buffer pool keeps its old size,
+   * the pages that were evicted so far are gone from it though.
+   *
+   * Resizes are serialized, fetches and the other operations go on while one runs.
+   * @param new_size the new number of frames, at least 1 and at most the max_pool_size given at construction
+   * @param timeout how long to wait for pinned pages in the frames that are retired
+   * @return false if new_size is out of range or shrinking timed out
+   */
+  virtual bool Resize(size_t new_size, std::chrono::milliseconds timeout = DEFAULT_RESIZE_TIMEOUT);
+
+  /** @return the size Resize can grow the buffer pool to */
+  virtual size_t GetMaxPoolSize() { return max_pool_size_; }
+
+  /**
+   * Starts a background thread that writes back dirty, unpinned pages before the eviction path needs their frames.
+   * A frame is clean if it is free, or unpinned and not dirty, i.e. it can be replaced without a disk write.
+   * Whenever fewer than low_watermark frames are clean, the flusher writes back dirty unpinned pages until
+   * high_watermark frames are clean. Does nothing if the flusher is already running.
+   * @param low_watermark start flushing when fewer frames than this are clean
+   * @param high_watermark stop flushing once this many frames are clean
+   * @param interval how often the clean frame count is checked
+   */
+  virtual void StartBackgroundFlusher(size_t low_watermark, size_t high_watermark,
+                                      std::chrono::milliseconds interval = DEFAULT_FLUSH_INTERVAL);
+
+  /**
+   * Stops the background flusher and waits for it to exit. Does nothing if it is not running.
+   */
+  virtual void StopBackgroundFlusher();
+
+  /** @return number of dirty pages written back by FetchPage and NewPage to free a frame */
+  uint64_t GetForegroundWriteCount() { return GetStats().Get(BufferPoolCounter::DIRTY_WRITEBACKS); }
+
+  /** @return number of dirty pages written back by the background flusher */
+  uint64_t GetBackgroundWriteCount() { return GetStats().Get(BufferPoolCounter::BACKGROUND_WRITEBACKS); }
+
+  /** @return the hit, miss, eviction, write-back, pin wait and fetch latency statistics of this buffer pool */
+  virtual BufferPoolStatsSnapshot GetStats() { return stats_.Snapshot(); }
 
  protected:
   /**
@@ -116,7 +214,14 @@ class BufferPoolManager {
    * @param page_id id of page to be fetched
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id);
+
+  /**
+   * FetchPageImpl without the latency measurement.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPageFromPool(page_id_t page_id);
 
   /**
    * Unpin the target page from the buffer pool.
@@ -124,21 +229,21 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id);
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id);
 
   /**
    * Deletes a page from the buffer pool.
@@ -146,34 +251,186 @@ class BufferPoolManager {
    * @return false if the page exists but could not be deleted, true if the page didn't exist or
    * deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id);
+
+  /**
+   * Flushes all the pages in the buffer pool to disk. The dirty pages are collected and pinned under the latch, then
+   * handed to the disk backend as one batch, in page id order, without holding it. Returns only once the write-backs
+   * of dirty pages that were replaced before the flush started have finished as well.
+   */
+  virtual void FlushAllPagesImpl();
+
+  /**
+   * Backs the frames up to new_size with memory and adds the ones beyond the pool size to the free list.
+   * Must be called with resize_mutex_ held.
+   * @param new_size the new number of frames, not smaller than the current one
+   */
+  void GrowPool(size_t new_size);
+
+  /**
+   * Retires the frames from new_size on, see Resize. Must be called with resize_mutex_ held.
+   * @param new_size the new number of frames, smaller than the current one
+   * @param timeout how long to wait for pinned pages
+   * @return false if a page was still pinned at the timeout
+   */
+  bool ShrinkPool(size_t new_size, std::chrono::milliseconds timeout);
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Picks a frame to hold a new page, from the free list first and from the replacer otherwise.
+   * Frames at or beyond the pool size are never picked. Must be called with latch_ held.
+   * @param[out] frame_id the picked frame
+   * @return false if every frame is pinned
    */
-  void FlushAllPagesImpl();
+  bool FindReplacementFrame(frame_id_t *frame_id);
 
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
+  /**
+   * Pins a frame without holding latch_. Fails if the frame is reserved.
+   * @param frame_id the frame to pin
+   * @return true if the frame was pinned
+   */
+  bool TryPinFrame(frame_id_t frame_id);
+
+  /**
+   * Reserves an unpinned frame for replacement or deletion, after which it cannot be pinned until the buffer
+   * pool manager publishes a new pin count. Must be called with latch_ held.
+   * @param frame_id the frame to reserve
+   * @return false if the frame is pinned or already reserved
+   */
+  bool TryReserveFrame(frame_id_t frame_id);
+
+  /**
+   * Drops one pin of a frame and hands the frame to the replacer if it was the last one.
+   * @param frame_id the frame to unpin
+   */
+  void UnpinFrame(frame_id_t frame_id);
+
+  /**
+   * Makes a frame whose last pin was just dropped the most recently used candidate of the replacer.
+   * @param frame_id the frame to release
+   */
+  void ReleaseFrame(frame_id_t frame_id);
+
+  /** Body of the background flusher thread. */
+  void BackgroundFlusherLoop();
+
+  /**
+   * Counts the frames that can be replaced without writing a page back. The count is a snapshot, frames are pinned
+   * and dirtied concurrently.
+   * @return number of clean frames
+   */
+  size_t CountCleanFrames();
+
+  /**
+   * Writes back one page for the background flusher if it is dirty and unpinned. The frame is pinned during the write
+   * so it can not be replaced, but the pin is not reported to the replacer as an access.
+   * @param frame_id the frame to flush
+   * @return true if a page was written
+   */
+  bool FlushFrameInBackground(frame_id_t frame_id);
+
+  /**
+   * Drops a pin taken only to write a page back. Unlike UnpinFrame this is not an access, the replacer only gets the
+   * frame back if a victim search dropped it while the pin was held.
+   * @param frame_id the frame to unpin
+   */
+  void DropFlushPin(frame_id_t frame_id);
+
+  /**
+   * Allocates a page id on disk that belongs to this instance. Must be called with latch_ held.
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage();
+
+  /**
+   * Asserts that the page id is owned by this instance.
+   * @param page_id the page id to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /** Pin count of a frame that is on the free list or being replaced or deleted. */
+  static constexpr int RESERVED_PIN_COUNT = -1;
+
+  /** A block of frame memory, PAGE_SIZE bytes per frame, for the frames [first_frame_, first_frame_ + num_frames_). */
+  struct FrameExtent {
+    size_t first_frame_;
+    size_t num_frames_;
+    char *data_;
+  };
+
+  /**
+   * Number of frames in use, frame ids are always [0, pool_size_). Changed by Resize under latch_, read without it
+   * by the background flusher.
+   */
+  std::atomic<size_t> pool_size_;
+  /** Number of Page objects, the pool can not grow beyond this. */
+  const size_t max_pool_size_;
+  /** How many instances share the page id space (1 unless this is a ParallelBufferPoolManager shard). */
+  const uint32_t num_instances_ = 1;
+  /** Index of this instance in the page id space. */
+  const uint32_t instance_index_ = 0;
+  /** Each instance allocates page ids congruent to instance_index_ modulo num_instances_. */
+  page_id_t next_page_id_ = 0;
+  /** Array of buffer pool pages, max_pool_size_ of them. Retired frames are reserved and hold no page. */
   Page *pages_;
+  /** Allocator of frame_extents_, not owned. */
+  FrameAllocator *frame_allocator_;
+  /**
+   * The memory of the frames in frame id order, one extent from construction and one per grow. Only touched under
+   * resize_mutex_ or when no other thread uses the buffer pool.
+   */
+  std::vector<FrameExtent> frame_extents_;
+  /** Serializes Resize. */
+  std::mutex resize_mutex_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page I/O through disk_manager_, used when no disk backend is given. */
+  DiskManagerBackend default_disk_backend_;
+  /** Does all page reads and writes, not owned. */
+  DiskBackend *disk_backend_;
+  /** Page table for keeping track of buffer pool pages, readable without latch_. */
+  ConcurrentPageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
+  /** replacer_ if it is an LRUKReplacer, which gets back the histories of victims that could not be replaced. */
+  LRUKReplacer *lru_k_replacer_ = nullptr;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
+  /** Per frame flag, set while the frame's page is being read in or its replaced page written back. */
+  std::vector<std::atomic<bool>> io_in_progress_;
+  /** Ids of replaced dirty pages whose write-back has not finished yet. */
+  std::unordered_set<page_id_t> write_back_pages_;
+  /** Signalled whenever an I/O started by FetchPageImpl or NewPageImpl finishes. */
+  std::condition_variable io_cv_;
+
+  /** Event counters, updated without latch_. */
+  BufferPoolStats stats_;
+  /** The background flusher, joinable while it runs. */
+  std::thread flusher_thread_;
+  /** Protects flusher_running_, separate from latch_ so that waking the flusher never contends with page accesses. */
+  std::mutex flusher_mutex_;
+  /** Wakes the flusher when it is stopped or when the eviction path had to write back a dirty page. */
+  std::condition_variable flusher_cv_;
+  bool flusher_running_ = false;
+  size_t flusher_low_watermark_ = 0;
+  size_t flusher_high_watermark_ = 0;
+  std::chrono::milliseconds flusher_interval_ = DEFAULT_FLUSH_INTERVAL;
+  /** Next frame the flusher looks at, it sweeps the frames round robin. Only used by the flusher thread. */
+  size_t flusher_cursor_ = 0;
   /**
    * This latch protects shared data structures.
    * We recommend updating this comment to describe what it protects.
    *
    * latch protects:
-   * - page_table_
+   * - page_table_ modifications
    * - free_list_
+   * - pool_size_ modifications
+   * - next_page_id_ allocation
+   * - io_in_progress_
+   * - write_back_pages_
+   *
+   * It is not held while reading or writing pages, and not taken by hits, see FetchPageImpl.
    */
   std::mutex latch_;
 };
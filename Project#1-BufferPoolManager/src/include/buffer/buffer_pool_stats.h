@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+
+namespace bustub {
+
+/** The events counted by BufferPoolStats. */
+enum class BufferPoolCounter {
+  /** FetchPage found the page in the buffer pool. */
+  HITS,
+  /** FetchPage had to read the page from disk. */
+  MISSES,
+  /** A page was replaced to make room for another one. */
+  EVICTIONS,
+  /** A replaced page was dirty and written back by the thread that needed its frame. */
+  DIRTY_WRITEBACKS,
+  /** A dirty page was written back by the background flusher. */
+  BACKGROUND_WRITEBACKS,
+  /** FetchPage blocked on I/O of another thread: the page was being read in or written back. */
+  PIN_WAITS,
+  NUM_COUNTERS
+};
+
+/**
+ * A point in time copy of the statistics of a buffer pool. Snapshots of several buffer pools can be added up.
+ */
+struct BufferPoolStatsSnapshot {
+  /** Number of fetch latency histogram buckets. Bucket i counts fetches that took [2^i, 2^(i+1)) ns, the last one
+   * everything slower. */
+  static constexpr size_t NUM_LATENCY_BUCKETS = 32;
+
+  std::array<uint64_t, static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS)> counters_{};
+  /** Latencies of a sample of the fetches, see BufferPoolStats::SampleFetchLatency. */
+  std::array<uint64_t, NUM_LATENCY_BUCKETS> fetch_latency_histogram_{};
+
+  /** @return the value of a counter */
+  uint64_t Get(BufferPoolCounter counter) const { return counters_[static_cast<size_t>(counter)]; }
+
+  /** @return hits / (hits + misses), 0 if nothing was fetched */
+  double HitRatio() const;
+
+  /**
+   * @param percentile in [0, 100]
+   * @return upper bound in ns of the histogram bucket the percentile falls into, 0 if nothing was fetched
+   */
+  uint64_t FetchLatencyPercentile(double percentile) const;
+
+  /** @return the snapshot as human readable text, one counter per line */
+  std::string ToString() const;
+
+  /** @return the snapshot as a JSON object */
+  std::string ToJson() const;
+
+  BufferPoolStatsSnapshot &operator+=(const BufferPoolStatsSnapshot &other);
+};
+
+/**
+ * BufferPoolStats counts the events of one buffer pool.
+ *
+ * Updates have to be cheap enough for the hit path of FetchPage, which takes no mutex. Every thread therefore
+ * updates its own cache line aligned shard with relaxed atomics, and the shards are only summed up when a snapshot
+ * is taken. Threads are assigned to shards round robin; with more threads than shards some share a shard, which
+ * only costs contention, never counts.
+ */
+class BufferPoolStats {
+ public:
+  /** Number of shards, the number of threads that update the stats without sharing a cache line. */
+  static constexpr size_t NUM_SHARDS = 32;
+  /** One in this many fetches is timed. */
+  static constexpr uint32_t LATENCY_SAMPLE_PERIOD = 16;
+
+  /** Adds one event to a counter. */
+  void Add(BufferPoolCounter counter) {
+    GetShard().counters_[static_cast<size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Timing every fetch would double the cost of a hit, so only one in LATENCY_SAMPLE_PERIOD fetches of each thread
+   * is timed, and the latency histogram holds a sample of the fetches.
+   * @return true if the calling thread should time its current fetch
+   */
+  static bool SampleFetchLatency() {
+    static thread_local uint32_t fetches = 0;
+    return fetches++ % LATENCY_SAMPLE_PERIOD == 0;
+  }
+
+  /** Records how long a FetchPage call took. */
+  void RecordFetchLatency(std::chrono::nanoseconds latency);
+
+  /** @return the current statistics */
+  BufferPoolStatsSnapshot Snapshot() const;
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS)> counters_{};
+    std::array<std::atomic<uint64_t>, BufferPoolStatsSnapshot::NUM_LATENCY_BUCKETS> fetch_latency_histogram_{};
+  };
+
+  /** @return the shard of the calling thread */
+  Shard &GetShard();
+
+  std::array<Shard, NUM_SHARDS> shards_;
+};
+
+}  // namespace bustub
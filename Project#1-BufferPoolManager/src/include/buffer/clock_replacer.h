@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// clock_replacer.h
+//
+// Identification: src/include/buffer/clock_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The state is two flat arrays indexed by frame id, so Pin and Unpin are O(1) without any allocation, and Victim
+ * is O(1) amortized: the hand clears every reference bit at most once per lap before it finds a victim.
+ */
+class ClockReplacer : public Replacer {
+  using mutex_t = std::mutex;
+
+ public:
+  /**
+   * Create a new ClockReplacer.
+   * @param num_pages the maximum number of pages the ClockReplacer will be required to store
+   */
+  explicit ClockReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ClockReplacer.
+   */
+  ~ClockReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  mutex_t mutex_;
+  /** in_replacer_[i] is true if frame i is unpinned and can be victimized. */
+  std::vector<bool> in_replacer_;
+  /** ref_bits_[i] is set when frame i is unpinned and cleared when the clock hand passes it. */
+  std::vector<bool> ref_bits_;
+  /** The frame the clock hand points to. */
+  size_t clock_hand_{0};
+  /** Number of frames in the replacer. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
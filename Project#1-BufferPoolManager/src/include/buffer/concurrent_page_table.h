@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table.h
+//
+// Identification: src/include/buffer/concurrent_page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ConcurrentPageTable maps page ids to frame ids for the buffer pool manager.
+ *
+ * It is an open addressing hash table with linear probing whose slots are single atomic words, so Find() never
+ * blocks. Insert() and Remove() must be serialized by the caller (the buffer pool manager's latch). Removal shifts
+ * the following entries back instead of leaving tombstones, which means a Find() running concurrently with a
+ * writer may miss an entry that is present, or still see one that was just removed. Callers of the lock-free
+ * Find() must therefore validate a hit and fall back to a latched lookup on a miss; a Find() done while holding
+ * the writers' latch is always exact.
+ */
+class ConcurrentPageTable {
+ public:
+  /**
+   * Create a new ConcurrentPageTable.
+   * @param num_frames the maximum number of pages that will be mapped at the same time
+   */
+  explicit ConcurrentPageTable(size_t num_frames);
+
+  ~ConcurrentPageTable() = default;
+
+  /**
+   * Look up the frame that holds a page. Lock-free.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Map a page to a frame, replacing an existing mapping of the page. Callers must be serialized.
+   * @param page_id the page, cannot be INVALID_PAGE_ID
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Remove the mapping of a page. Callers must be serialized.
+   * @param page_id the page to remove
+   * @return true if the page was mapped
+   */
+  bool Remove(page_id_t page_id);
+
+ private:
+  /** A slot packs the page id in the upper and the frame id in the lower 32 bits. */
+  static uint64_t MakeSlot(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t SlotPageId(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t SlotFrameId(uint64_t slot) { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** Empty slots hold INVALID_PAGE_ID. */
+  static constexpr uint64_t EMPTY_SLOT = static_cast<uint64_t>(static_cast<uint32_t>(INVALID_PAGE_ID)) << 32;
+
+  /** @return the slot where probing for the page starts */
+  size_t HomeSlot(page_id_t page_id) const;
+
+  /** Number of slots - 1, the number of slots is a power of two. */
+  size_t mask_;
+  /** Shift that keeps the top bits of the multiplicative hash. */
+  int hash_shift_;
+  std::vector<std::atomic<uint64_t>> slots_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_allocator.h
+//
+// Identification: src/include/buffer/frame_allocator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+namespace bustub {
+
+/**
+ * FrameAllocator provides the memory that holds the data of the buffer pool frames. The buffer pool manager takes
+ * one region of pool_size * PAGE_SIZE bytes and slices it into frames, so with a PAGE_SIZE aligned region every
+ * frame is aligned for direct I/O.
+ */
+class FrameAllocator {
+ public:
+  FrameAllocator() = default;
+  virtual ~FrameAllocator() = default;
+
+  /**
+   * Allocates a zeroed region aligned to at least PAGE_SIZE.
+   * @param size size of the region in bytes
+   * @return the region, nullptr if size is 0
+   */
+  virtual char *Allocate(size_t size) = 0;
+
+  /**
+   * Frees a region returned by Allocate.
+   * @param region the region
+   * @param size the size it was allocated with
+   */
+  virtual void Deallocate(char *region, size_t size) = 0;
+};
+
+/**
+ * DefaultFrameAllocator takes frame memory from the heap, aligned to PAGE_SIZE.
+ */
+class DefaultFrameAllocator : public FrameAllocator {
+ public:
+  char *Allocate(size_t size) override;
+
+  void Deallocate(char *region, size_t size) override;
+
+  /** @return the allocator the buffer pool manager uses when it is not given one */
+  static DefaultFrameAllocator *Instance();
+};
+
+/**
+ * HugePageFrameAllocator backs the frames with huge pages to cut down TLB misses on large buffer pools.
+ *
+ * It first maps explicit huge pages (MAP_HUGETLB), which only works if the administrator reserved enough of them.
+ * Otherwise it maps regular anonymous memory aligned to the huge page size and asks for transparent huge pages
+ * (MADV_HUGEPAGE), and if even mmap fails it falls back to DefaultFrameAllocator. It is thread safe, one instance can
+ * serve several buffer pools.
+ */
+class HugePageFrameAllocator : public FrameAllocator {
+ public:
+  /** How a region is backed. */
+  enum class Backing { HUGETLB, TRANSPARENT_HUGE_PAGES, HEAP };
+
+  /** The huge page size of x86-64 and of the common arm64 configurations. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  ~HugePageFrameAllocator() override;
+
+  char *Allocate(size_t size) override;
+
+  void Deallocate(char *region, size_t size) override;
+
+  /**
+   * @param region a region returned by Allocate and not freed yet
+   * @return how the region is backed
+   */
+  Backing GetBacking(char *region);
+
+ private:
+  struct Mapping {
+    Backing backing_;
+    /** Length of the mapping, the requested size rounded up to HUGE_PAGE_SIZE. */
+    size_t length_;
+  };
+
+  std::mutex mutex_;
+  /** The live regions, keyed by their address. */
+  std::unordered_map<char *, Mapping> mappings_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy (O'Neil, O'Neil and Weikum, 1993).
+ *
+ * The victim is the unpinned frame whose K-th most recent access lies furthest in the past (the largest backward
+ * K-distance). Frames with fewer than K accesses have an infinite backward K-distance and are evicted first, in
+ * LRU order of their last access, so pages touched once by a sequential scan are replaced before pages that are
+ * used repeatedly.
+ *
+ * Every call to Pin() is one access. Accesses that follow the previous access of the frame within the correlated
+ * reference period only refresh the frame's last access time and do not count towards its history, and a frame
+ * is not eligible as victim until the correlated reference period after its last access has passed, unless no
+ * other frame is. Time is measured in accesses, i.e. in calls to Pin().
+ *
+ * The history belongs to the page in the frame and is dropped when the frame is victimized; histories of evicted
+ * pages are not retained. The buffer pool can still give the last victim its history back with Restore() if it
+ * turns out that the page stays in the frame after all.
+ */
+class LRUKReplacer : public Replacer {
+  using mutex_t = std::mutex;
+
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses whose history is kept per frame, must be at least 1
+   * @param correlated_reference_period number of accesses during which repeated accesses to a frame are
+   * considered correlated
+   */
+  LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_reference_period = 0);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  /**
+   * Gives the frame last returned by Victim() the history of its page back, for when the page could not be replaced
+   * because it was pinned in the meantime. Does nothing if frame_id was not the last victim.
+   * @param frame_id the victim whose page stays in the frame
+   */
+  void Restore(frame_id_t frame_id);
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  /** Order of the unpinned frames: (K-th most recent access or 0, most recent access, frame), oldest first. */
+  using EvictionKey = std::tuple<uint64_t, uint64_t, frame_id_t>;
+
+  struct FrameHistory {
+    /** The last K uncorrelated accesses as a ring buffer, history[(newest + K - i) % K] is the i-th most recent. */
+    std::vector<uint64_t> history;
+    size_t newest{0};
+    /** Number of uncorrelated accesses, at most K are remembered. */
+    size_t num_accesses{0};
+    /** Time of the last access, correlated or not. */
+    uint64_t last_access{0};
+    bool evictable{false};
+  };
+
+  EvictionKey GetEvictionKey(frame_id_t frame_id) const;
+
+  mutex_t mutex_;
+  size_t k_;
+  uint64_t correlated_reference_period_;
+  /** Logical clock, advanced by every access. */
+  uint64_t current_time_{0};
+  std::vector<FrameHistory> frames_;
+  std::set<EvictionKey> evictable_frames_;
+  /** The last victim and the history it had, until Restore() puts it back or the next victim replaces it. */
+  frame_id_t last_victim_{-1};
+  FrameHistory last_victim_history_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into several independent BufferPoolManager instances.
+ * Every instance has its own page table, free list, replacer and latch, and page_id % num_instances decides which
+ * instance owns a page, so operations on pages of different instances never contend with each other.
+ *
+ * It can be used wherever a BufferPoolManager is expected. Note that GetPages() is meaningless here because the
+ * frames are not stored in one consecutive array.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManager instances
+   * @param pool_size the pool size of each instance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every instance
+   * @param frame_allocator where the frame memory of every instance comes from, nullptr for DefaultFrameAllocator
+   * @param disk_backend what reads and writes the pages of every instance, nullptr to do it through disk_manager
+   * @param max_pool_size the size Resize can grow each instance to, 0 for pool_size
+   * @param lru_k K of the LRU-K replacement policy of every instance, only used with ReplacerType::LRU_K
+   * @param lru_k_correlated_reference_period correlated reference period of the LRU-K replacement policy
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            FrameAllocator *frame_allocator = nullptr, DiskBackend *disk_backend = nullptr,
+                            size_t max_pool_size = 0, size_t lru_k = DEFAULT_LRU_K,
+                            uint64_t lru_k_correlated_reference_period = DEFAULT_LRU_K_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  size_t GetPoolSize() override;
+
+  /**
+   * Resizes every instance, the frames are spread evenly over them. Instances that were resized before one failed
+   * keep their new size.
+   * @param new_size the new number of frames of all instances together, at least one per instance
+   * @param timeout how long each instance waits for pinned pages in the frames it retires
+   * @return false if new_size is out of range or an instance timed out
+   */
+  bool Resize(size_t new_size, std::chrono::milliseconds timeout = DEFAULT_RESIZE_TIMEOUT) override;
+
+  /** @return the size Resize can grow the buffer pool to, summed over all instances */
+  size_t GetMaxPoolSize() override;
+
+  /**
+   * Starts a background flusher in every instance. The watermarks apply to each instance on its own.
+   * @param low_watermark start flushing an instance when fewer of its frames than this are clean
+   * @param high_watermark stop flushing an instance once this many of its frames are clean
+   * @param interval how often the clean frame count is checked
+   */
+  void StartBackgroundFlusher(size_t low_watermark, size_t high_watermark,
+                              std::chrono::milliseconds interval = DEFAULT_FLUSH_INTERVAL) override;
+
+  /** Stops the background flusher of every instance. */
+  void StopBackgroundFlusher() override;
+
+  /** @return the statistics of all instances added up */
+  BufferPoolStatsSnapshot GetStats() override;
+
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManager instance responsible for handling the given page id
+   */
+  BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
+
+ protected:
+  /**
+   * Fetch the requested page from the responsible instance.
+   * @param page_id id of page to be fetched
+   * @return the requested page
+   */
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  /**
+   * Unpin the target page from the responsible instance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  /**
+   * Flushes the target page to disk.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Creates a new page. Instances are tried in round robin order, starting one past where the last call started,
+   * so new pages are spread evenly over the instances.
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Deletes a page from the responsible instance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or
+   * deletion succeeded
+   */
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  /**
+   * Flushes all the pages of every instance to disk.
+   */
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** The individual buffer pool instances, indexed by page_id % num_instances. */
+  std::vector<BufferPoolManager *> instances_;
+  /** The instance the next NewPage call starts searching from. */
+  std::atomic<size_t> next_instance_{0};
+};
+}  // namespace bustub
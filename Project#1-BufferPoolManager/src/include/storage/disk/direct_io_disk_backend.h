@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// direct_io_disk_backend.h
+//
+// Identification: src/include/storage/disk/direct_io_disk_backend.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "storage/disk/disk_backend.h"
+
+namespace bustub {
+
+/**
+ * DirectIODiskBackend reads and writes the database file with O_DIRECT, bypassing the page cache, and keeps the
+ * pages of a batch in flight together through io_uring.
+ *
+ * Single pages are transferred with pread/pwrite. Batches are sorted by page id, runs of consecutive pages become one
+ * vectored request, and up to QUEUE_DEPTH requests are outstanding at a time. Every part degrades on its own: if the
+ * file system refuses O_DIRECT the file is opened buffered, and if io_uring can not be set up (old kernel, seccomp)
+ * batches are written with synchronous preadv/pwritev per run.
+ *
+ * O_DIRECT needs PAGE_SIZE aligned memory. Buffer pool frames are aligned, other buffers go through a bounce buffer.
+ */
+class DirectIODiskBackend : public DiskBackend {
+ public:
+  /** Number of requests io_uring keeps in flight. */
+  static constexpr unsigned QUEUE_DEPTH = 64;
+
+  /**
+   * Opens the database file, creating it if it does not exist.
+   * @param db_file the database file, usually the one of the DiskManager the buffer pool manager is given
+   */
+  explicit DirectIODiskBackend(const std::string &db_file);
+
+  ~DirectIODiskBackend() override;
+
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  void ReadPages(const std::vector<PageIORequest> &requests) override;
+
+  void WritePages(const std::vector<PageIORequest> &requests) override;
+
+  /** @return true if the file is opened with O_DIRECT */
+  bool IsDirectIO() const { return direct_io_; }
+
+  /** @return true if batches are submitted through io_uring */
+  bool UsesIoUring() const { return ring_fd_ >= 0; }
+
+ private:
+  /** A vectored transfer of a run of consecutive pages. */
+  struct RunRequest {
+    off_t offset_;
+    std::vector<struct iovec> iovecs_;
+  };
+
+  /** Splits a batch into runs of consecutive page ids, in page id order. */
+  static std::vector<RunRequest> MakeRuns(const std::vector<PageIORequest> &requests);
+
+  void SubmitBatch(const std::vector<PageIORequest> &requests, bool write);
+
+  /** Does one run with preadv/pwritev, looping over short transfers. */
+  void TransferRun(const RunRequest &run, bool write);
+
+  /** Sets up the io_uring, leaves ring_fd_ at -1 if that fails. */
+  void SetUpRing();
+
+  /** Submits the runs through io_uring. Must be called with ring_mutex_ held. */
+  void SubmitToRing(std::vector<RunRequest> *runs, bool write);
+
+  /** @return true if the memory can be used for O_DIRECT as is */
+  static bool IsAligned(const char *data) { return reinterpret_cast<uintptr_t>(data) % PAGE_SIZE == 0; }
+
+  int fd_ = -1;
+  bool direct_io_ = false;
+
+  /** The io_uring, -1 if unavailable. */
+  int ring_fd_ = -1;
+  /** Serializes batches on the ring, it has a single submitter. */
+  std::mutex ring_mutex_;
+  void *sq_ring_ = nullptr;
+  size_t sq_ring_size_ = 0;
+  void *cq_ring_ = nullptr;
+  size_t cq_ring_size_ = 0;
+  struct io_uring_sqe *sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+  unsigned *sq_tail_ = nullptr;
+  unsigned *sq_mask_ = nullptr;
+  unsigned *sq_array_ = nullptr;
+  unsigned *cq_head_ = nullptr;
+  unsigned *cq_tail_ = nullptr;
+  unsigned *cq_mask_ = nullptr;
+  struct io_uring_cqe *cqes_ = nullptr;
+};
+
+}  // namespace bustub
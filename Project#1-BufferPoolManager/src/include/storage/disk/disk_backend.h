@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_backend.h
+//
+// Identification: src/include/storage/disk/disk_backend.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** One page transfer of a batch: the page and the PAGE_SIZE bytes of memory it is read into or written from. */
+struct PageIORequest {
+  page_id_t page_id_;
+  char *data_;
+};
+
+/**
+ * DiskBackend performs the page reads and writes of the buffer pool manager. Besides single pages it takes whole
+ * batches, which a backend is free to keep in flight all at once. Page allocation stays with the DiskManager.
+ */
+class DiskBackend {
+ public:
+  DiskBackend() = default;
+  virtual ~DiskBackend() = default;
+
+  /**
+   * Reads a page. Reading past the end of the file returns zeroes.
+   * @param page_id the page to read
+   * @param page_data PAGE_SIZE bytes to read it into
+   */
+  virtual void ReadPage(page_id_t page_id, char *page_data) = 0;
+
+  /**
+   * Writes a page.
+   * @param page_id the page to write
+   * @param page_data the PAGE_SIZE bytes to write
+   */
+  virtual void WritePage(page_id_t page_id, const char *page_data) = 0;
+
+  /**
+   * Reads a batch of pages and returns once all of them are read.
+   * @param requests the pages, no page may appear twice
+   */
+  virtual void ReadPages(const std::vector<PageIORequest> &requests);
+
+  /**
+   * Writes a batch of pages and returns once all of them are written.
+   * @param requests the pages, no page may appear twice
+   */
+  virtual void WritePages(const std::vector<PageIORequest> &requests);
+};
+
+/**
+ * DiskManagerBackend does the page I/O through a DiskManager, one page at a time. It is what the buffer pool manager
+ * uses when it is not given a backend.
+ */
+class DiskManagerBackend : public DiskBackend {
+ public:
+  /** @param disk_manager the disk manager, not owned */
+  explicit DiskManagerBackend(DiskManager *disk_manager) : disk_manager_(disk_manager) {}
+
+  void ReadPage(page_id_t page_id, char *page_data) override { disk_manager_->ReadPage(page_id, page_data); }
+
+  void WritePage(page_id_t page_id, const char *page_data) override { disk_manager_->WritePage(page_id, page_data); }
+
+ private:
+  DiskManager *disk_manager_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,324 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// direct_io_disk_backend.cpp
+//
+// Identification: src/storage/disk/direct_io_disk_backend.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/direct_io_disk_backend.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+/** PAGE_SIZE aligned scratch page for callers whose buffers can not be used with O_DIRECT. */
+struct BounceBuffer {
+  BounceBuffer() : data_(static_cast<char *>(std::aligned_alloc(PAGE_SIZE, PAGE_SIZE))) {}
+  ~BounceBuffer() { std::free(data_); }
+  BounceBuffer(const BounceBuffer &) = delete;
+  BounceBuffer &operator=(const BounceBuffer &) = delete;
+  char *data_;
+};
+
+int IoUringSetup(unsigned entries, struct io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+}  // namespace
+
+DirectIODiskBackend::DirectIODiskBackend(const std::string &db_file) {
+  fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+  direct_io_ = fd_ >= 0;
+  if (fd_ < 0 && errno == EINVAL) {
+    // the file system does not support O_DIRECT, e.g. tmpfs
+    fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file " + db_file + ": " + strerror(errno));
+  }
+  SetUpRing();
+}
+
+DirectIODiskBackend::~DirectIODiskBackend() {
+  if (ring_fd_ >= 0) {
+    munmap(sqes_, sqes_size_);
+    if (cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+  close(fd_);
+}
+
+void DirectIODiskBackend::ReadPage(page_id_t page_id, char *page_data) {
+  BounceBuffer bounce;
+  char *buffer = IsAligned(page_data) ? page_data : bounce.data_;
+  const off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  ssize_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t ret = pread(fd_, buffer + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      throw Exception(std::string("I/O error while reading: ") + strerror(errno));
+    }
+    if (ret == 0) {
+      // like DiskManager, the part past the end of the file reads as zeroes
+      memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+      break;
+    }
+    read_count += ret;
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+}
+
+void DirectIODiskBackend::WritePage(page_id_t page_id, const char *page_data) {
+  BounceBuffer bounce;
+  const char *buffer = page_data;
+  if (!IsAligned(page_data)) {
+    memcpy(bounce.data_, page_data, PAGE_SIZE);
+    buffer = bounce.data_;
+  }
+  const off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  ssize_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t ret = pwrite(fd_, buffer + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      throw Exception(std::string("I/O error while writing: ") + strerror(errno));
+    }
+    write_count += ret;
+  }
+}
+
+void DirectIODiskBackend::ReadPages(const std::vector<PageIORequest> &requests) { SubmitBatch(requests, false); }
+
+void DirectIODiskBackend::WritePages(const std::vector<PageIORequest> &requests) { SubmitBatch(requests, true); }
+
+void DirectIODiskBackend::SubmitBatch(const std::vector<PageIORequest> &requests, bool write) {
+  if (requests.empty()) {
+    return;
+  }
+  // swap unaligned buffers for bounce buffers, copying in before a write and out after a read
+  std::vector<PageIORequest> aligned_requests = requests;
+  std::vector<std::unique_ptr<BounceBuffer>> bounces;
+  for (PageIORequest &request : aligned_requests) {
+    if (!IsAligned(request.data_)) {
+      bounces.push_back(std::make_unique<BounceBuffer>());
+      if (write) {
+        memcpy(bounces.back()->data_, request.data_, PAGE_SIZE);
+      }
+      request.data_ = bounces.back()->data_;
+    }
+  }
+
+  std::vector<RunRequest> runs = MakeRuns(aligned_requests);
+  if (ring_fd_ >= 0) {
+    const std::lock_guard<std::mutex> guard(ring_mutex_);
+    SubmitToRing(&runs, write);
+  }
+  // without a ring, and for transfers the ring left short, finish synchronously
+  for (const RunRequest &run : runs) {
+    TransferRun(run, write);
+  }
+
+  if (!write) {
+    for (size_t i = 0; i < requests.size(); i++) {
+      if (aligned_requests[i].data_ != requests[i].data_) {
+        memcpy(requests[i].data_, aligned_requests[i].data_, PAGE_SIZE);
+      }
+    }
+  }
+}
+
+std::vector<DirectIODiskBackend::RunRequest> DirectIODiskBackend::MakeRuns(
+    const std::vector<PageIORequest> &requests) {
+  std::vector<PageIORequest> sorted = requests;
+  std::sort(sorted.begin(), sorted.end(),
+            [](const PageIORequest &a, const PageIORequest &b) { return a.page_id_ < b.page_id_; });
+  std::vector<RunRequest> runs;
+  page_id_t previous = INVALID_PAGE_ID;
+  for (const PageIORequest &request : sorted) {
+    // IOV_MAX bounds the length of a vectored request
+    if (runs.empty() || request.page_id_ != previous + 1 || runs.back().iovecs_.size() == IOV_MAX) {
+      runs.push_back({static_cast<off_t>(request.page_id_) * PAGE_SIZE, {}});
+    }
+    runs.back().iovecs_.push_back({request.data_, PAGE_SIZE});
+    previous = request.page_id_;
+  }
+  return runs;
+}
+
+void DirectIODiskBackend::TransferRun(const RunRequest &run, bool write) {
+  // preadv/pwritev may stop early, continue with what is left
+  std::vector<struct iovec> iovecs = run.iovecs_;
+  size_t first = 0;
+  off_t offset = run.offset_;
+  while (first < iovecs.size()) {
+    int count = static_cast<int>(iovecs.size() - first);
+    ssize_t ret = write ? pwritev(fd_, &iovecs[first], count, offset) : preadv(fd_, &iovecs[first], count, offset);
+    if (ret < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ret < 0) {
+      throw Exception(std::string("I/O error during vectored transfer: ") + strerror(errno));
+    }
+    if (ret == 0) {
+      // read past the end of the file
+      for (size_t i = first; i < iovecs.size(); i++) {
+        memset(iovecs[i].iov_base, 0, iovecs[i].iov_len);
+      }
+      return;
+    }
+    offset += ret;
+    auto done = static_cast<size_t>(ret);
+    while (first < iovecs.size() && done >= iovecs[first].iov_len) {
+      done -= iovecs[first].iov_len;
+      first++;
+    }
+    if (done > 0) {
+      iovecs[first].iov_base = static_cast<char *>(iovecs[first].iov_base) + done;
+      iovecs[first].iov_len -= done;
+    }
+  }
+}
+
+void DirectIODiskBackend::SetUpRing() {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(QUEUE_DEPTH, &params);
+  if (ring_fd < 0) {
+    return;
+  }
+
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    close(ring_fd);
+    return;
+  }
+  cq_ring_ = single_mmap ? sq_ring_
+                         : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                                IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void *sqes = cq_ring_ == MAP_FAILED ? MAP_FAILED
+                                      : mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                             ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd);
+    return;
+  }
+  sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+
+  char *sq = static_cast<char *>(sq_ring_);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  char *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+  ring_fd_ = ring_fd;
+}
+
+void DirectIODiskBackend::SubmitToRing(std::vector<RunRequest> *runs, bool write) {
+  // Keep up to QUEUE_DEPTH runs in flight. A run that completes in full is cleared, one that comes back short or
+  // failed keeps its iovecs so that the caller redoes it synchronously.
+  std::vector<bool> done(runs->size(), false);
+  size_t next = 0;
+  size_t in_flight = 0;
+  // queued in the submission ring but not consumed by the kernel yet, io_uring_enter may take fewer than offered
+  unsigned unsubmitted = 0;
+  while (next < runs->size() || in_flight > 0) {
+    while (next < runs->size() && in_flight < QUEUE_DEPTH) {
+      const RunRequest &run = (*runs)[next];
+      unsigned tail = *sq_tail_;
+      unsigned index = tail & *sq_mask_;
+      struct io_uring_sqe *sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = write ? IORING_OP_WRITEV : IORING_OP_READV;
+      sqe->fd = fd_;
+      sqe->off = run.offset_;
+      sqe->addr = reinterpret_cast<uint64_t>(run.iovecs_.data());
+      sqe->len = static_cast<uint32_t>(run.iovecs_.size());
+      sqe->user_data = next;
+      sq_array_[index] = index;
+      // the kernel must see the entry before the new tail
+      __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+      next++;
+      in_flight++;
+      unsubmitted++;
+    }
+
+    int ret = IoUringEnter(ring_fd_, unsubmitted, 1, IORING_ENTER_GETEVENTS);
+    if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      throw Exception(std::string("io_uring_enter failed: ") + strerror(errno));
+    }
+    if (ret > 0) {
+      unsubmitted -= static_cast<unsigned>(ret);
+    }
+
+    unsigned head = *cq_head_;
+    while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      const struct io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+      RunRequest &run = (*runs)[cqe.user_data];
+      if (cqe.res == static_cast<int>(run.iovecs_.size() * PAGE_SIZE)) {
+        done[cqe.user_data] = true;
+      }
+      head++;
+      in_flight--;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  // leave only the runs that still have to be done
+  std::vector<RunRequest> unfinished;
+  for (size_t i = 0; i < runs->size(); i++) {
+    if (!done[i]) {
+      unfinished.push_back(std::move((*runs)[i]));
+    }
+  }
+  *runs = std::move(unfinished);
+}
+
+}  // namespace bustub
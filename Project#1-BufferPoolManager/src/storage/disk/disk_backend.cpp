@@ -0,0 +1,29 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_backend.cpp
+//
+// Identification: src/storage/disk/disk_backend.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_backend.h"
+
+namespace bustub {
+
+void DiskBackend::ReadPages(const std::vector<PageIORequest> &requests) {
+  for (const PageIORequest &request : requests) {
+    ReadPage(request.page_id_, request.data_);
+  }
+}
+
+void DiskBackend::WritePages(const std::vector<PageIORequest> &requests) {
+  for (const PageIORequest &request : requests) {
+    WritePage(request.page_id_, request.data_);
+  }
+}
+
+}  // namespace bustub
@@ -11,9 +11,16 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <cstdio>
+#include <mutex>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -143,4 +150,639 @@ TEST(BufferPoolManagerTest, SampleTest) {
     delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// The buffer pool must keep working the same way with the other replacement policies.
+TEST(BufferPoolManagerTest, ReplacerTypeTest) {
+    for (auto replacer_type : {BufferPoolManager::ReplacerType::CLOCK, BufferPoolManager::ReplacerType::LRU_K}) {
+        const std::string db_name = "test.db";
+        const size_t buffer_pool_size = 4;
+
+        auto* disk_manager = new DiskManager(db_name);
+        auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+        page_id_t page_id_temp;
+        for (int i = 0; i < 3 * static_cast<int>(buffer_pool_size); ++i) {
+            auto* page = bpm->NewPage(&page_id_temp);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(i, page_id_temp);
+            snprintf(page->GetData(), PAGE_SIZE, "%d", i);
+            EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+        }
+
+        // Scenario: every page was evicted at least once, its content must come back from disk.
+        char expected[PAGE_SIZE];
+        for (int i = 0; i < 3 * static_cast<int>(buffer_pool_size); ++i) {
+            auto* page = bpm->FetchPage(i);
+            ASSERT_NE(nullptr, page);
+            snprintf(expected, PAGE_SIZE, "%d", i);
+            EXPECT_EQ(0, strcmp(page->GetData(), expected));
+            EXPECT_EQ(true, bpm->UnpinPage(i, false));
+        }
+
+        // Scenario: once every frame is pinned there is no victim.
+        for (int i = 0; i < static_cast<int>(buffer_pool_size); ++i) {
+            EXPECT_NE(nullptr, bpm->FetchPage(i));
+        }
+        EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+        // Shutdown the disk manager and remove the temporary file we created.
+        disk_manager->ShutDown();
+        remove("test.db");
+        remove("test.log");
+
+        delete bpm;
+        delete disk_manager;
+    }
+}
+
+// NOLINTNEXTLINE
+// Pages are read in and written back without holding the latch, make sure concurrent
+// fetches of the same page and evictions of dirty pages never expose stale content.
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 8;
+    const int num_pages = 32;
+    const int num_threads = 4;
+    const int rounds = 2000;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([bpm, t]() {
+            std::default_random_engine rng(t);
+            std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+            char expected[PAGE_SIZE];
+            for (int i = 0; i < rounds; ++i) {
+                page_id_t page_id = page_dist(rng);
+                auto* page = bpm->FetchPage(page_id);
+                if (page == nullptr) {
+                    // every frame is pinned by the other threads right now
+                    continue;
+                }
+                snprintf(expected, PAGE_SIZE, "%d", page_id);
+                EXPECT_EQ(page_id, page->GetPageId());
+                page->RLatch();
+                EXPECT_EQ(0, strcmp(page->GetData(), expected));
+                page->RUnlatch();
+                // mark some pages dirty so that evictions have to write them back
+                EXPECT_EQ(true, bpm->UnpinPage(page_id, i % 3 == 0));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Shutdown the disk manager and remove the temporary file we created.
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// FlushAllPages writes the dirty pages in page id order without the latch, check that every dirty page reaches
+// the disk, pinned ones included, and that the pins of the pages are left as they were.
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 16;
+    const int num_pages = 16;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+
+    // Dirty the pages again in shuffled order, so that frame order and page id order differ, and keep some pinned.
+    std::vector<page_id_t> page_ids(num_pages);
+    for (int i = 0; i < num_pages; ++i) {
+        page_ids[i] = i;
+    }
+    std::shuffle(page_ids.begin(), page_ids.end(), std::default_random_engine(0));
+    for (page_id_t page_id : page_ids) {
+        auto* page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "flushed %d", page_id);
+        if (page_id % 4 == 0) {
+            ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        }
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+
+    bpm->FlushAllPages();
+
+    for (page_id_t page_id : page_ids) {
+        auto* page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(false, page->IsDirty());
+        EXPECT_EQ(page_id % 4 == 0 ? 2 : 1, page->GetPinCount());
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: a second buffer pool on the same file reads the flushed content.
+    auto* other_bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    char expected[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        auto* page = other_bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "flushed %d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, other_bpm->UnpinPage(page_id, false));
+    }
+
+    // Shutdown the disk manager and remove the temporary file we created.
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete other_bpm;
+    delete bpm;
+    delete disk_manager;
+}
+
+// Writes through the disk manager, but holds the write of one page until it is released.
+class BlockingDiskBackend : public DiskManagerBackend {
+ public:
+    BlockingDiskBackend(DiskManager* disk_manager, page_id_t blocked_page_id)
+        : DiskManagerBackend(disk_manager), blocked_page_id_(blocked_page_id) {}
+
+    void WritePage(page_id_t page_id, const char* page_data) override {
+        if (page_id == blocked_page_id_) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            blocked_ = true;
+            cv_.notify_all();
+            cv_.wait(lock, [&] { return released_; });
+        }
+        DiskManagerBackend::WritePage(page_id, page_data);
+        if (page_id == blocked_page_id_) {
+            written_ = true;
+        }
+    }
+
+    void WaitUntilBlocked() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [&] { return blocked_; });
+    }
+
+    void Release() {
+        const std::lock_guard<std::mutex> guard(mutex_);
+        released_ = true;
+        cv_.notify_all();
+    }
+
+    bool IsWritten() { return written_; }
+
+ private:
+    const page_id_t blocked_page_id_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool blocked_ = false;
+    bool released_ = false;
+    std::atomic<bool> written_{false};
+};
+
+TEST(BufferPoolManagerTest, FlushAllPagesDuringEvictionTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 2;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* backend = new BlockingDiskBackend(disk_manager, 0);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::LRU,
+                                      nullptr, backend);
+
+    page_id_t page_id_temp;
+    for (int i = 0; i < 2; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Scenario: a new page evicts dirty page 0, whose write-back is held. A flush that starts meanwhile does not
+    // find page 0 in any frame, but still returns only after it is on disk.
+    std::thread evictor([&] {
+        page_id_t page_id;
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    });
+    backend->WaitUntilBlocked();
+
+    std::atomic<bool> flushed{false};
+    bool written_when_flushed = false;
+    std::thread flusher([&] {
+        bpm->FlushAllPages();
+        written_when_flushed = backend->IsWritten();
+        flushed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(flushed);
+    backend->Release();
+    flusher.join();
+    evictor.join();
+    EXPECT_TRUE(written_when_flushed);
+
+    // Scenario: a second buffer pool on the same file reads the flushed content.
+    auto* other_bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+    auto* page = other_bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+    EXPECT_EQ(true, other_bpm->UnpinPage(0, false));
+
+    // Shutdown the disk manager and remove the temporary file we created.
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete other_bpm;
+    delete bpm;
+    delete backend;
+    delete disk_manager;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Read-only workload where 95% of the fetches go to a hot set that stays resident and 5% to cold pages
+// that have to be read from disk.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_HitPathBenchmark) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 1024;
+    const int num_hot_pages = 512;
+    const int num_pages = 8192;
+    const int ops_per_thread = 200000;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    bpm->FlushAllPages();
+
+    for (int num_threads = 1; num_threads <= 8; num_threads *= 2) {
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([bpm, t]() {
+                std::default_random_engine rng(t);
+                std::uniform_int_distribution<int> percent_dist(0, 99);
+                std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+                std::uniform_int_distribution<page_id_t> cold_dist(num_hot_pages, num_pages - 1);
+                for (int i = 0; i < ops_per_thread; ++i) {
+                    page_id_t page_id = percent_dist(rng) < 95 ? hot_dist(rng) : cold_dist(rng);
+                    if (bpm->FetchPage(page_id) != nullptr) {
+                        bpm->UnpinPage(page_id, false);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("threads=%-2d %12.0f fetch+unpin/s\n", num_threads, num_threads * ops_per_thread / elapsed.count());
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// The background flusher writes back dirty unpinned pages ahead of time, so that the following evictions
+// do not have to write anything on the fetching thread.
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 10;
+    const size_t low_watermark = 4;
+    const size_t high_watermark = 8;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    // Fill the pool with dirty pages and leave the flusher to clean them.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    EXPECT_EQ(0, bpm->GetBackgroundWriteCount());
+
+    bpm->StartBackgroundFlusher(low_watermark, high_watermark, std::chrono::milliseconds(1));
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (bpm->GetBackgroundWriteCount() < high_watermark && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    bpm->StopBackgroundFlusher();
+
+    // Scenario: the flusher stops at the high watermark.
+    EXPECT_EQ(high_watermark, bpm->GetBackgroundWriteCount());
+
+    // Scenario: the frames it cleaned are replaced without foreground writes.
+    for (size_t i = 0; i < high_watermark; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+    EXPECT_EQ(0, bpm->GetForegroundWriteCount());
+
+    // Scenario: the pages it wrote can be read back.
+    char expected[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(high_watermark); ++page_id) {
+        auto* page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "%d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: the two pages it left dirty were written back by the fetches above.
+    EXPECT_EQ(buffer_pool_size - high_watermark, bpm->GetForegroundWriteCount());
+
+    // Shutdown the disk manager and remove the temporary file we created.
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Update workload where every fetched page is dirtied, so most evictions find a dirty victim. Reports the fetch
+// latency percentiles with and without the background flusher.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_BackgroundFlusherLatencyBenchmark) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 1024;
+    const int num_pages = 8192;
+    const int num_fetches = 200000;
+
+    for (bool use_flusher : {false, true}) {
+        auto* disk_manager = new DiskManager(db_name);
+        auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+        page_id_t page_id_temp;
+        for (int i = 0; i < num_pages; ++i) {
+            ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+            EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+        }
+        bpm->FlushAllPages();
+        if (use_flusher) {
+            bpm->StartBackgroundFlusher(buffer_pool_size / 8, buffer_pool_size / 4, std::chrono::milliseconds(1));
+        }
+        uint64_t foreground_writes_before = bpm->GetForegroundWriteCount();
+
+        std::default_random_engine rng(0);
+        std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+        std::vector<double> latencies;
+        latencies.reserve(num_fetches);
+        for (int i = 0; i < num_fetches; ++i) {
+            page_id_t page_id = page_dist(rng);
+            auto start = std::chrono::steady_clock::now();
+            auto* page = bpm->FetchPage(page_id);
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+            ASSERT_NE(nullptr, page);
+            latencies.push_back(elapsed.count());
+            EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+        }
+        bpm->StopBackgroundFlusher();
+
+        std::sort(latencies.begin(), latencies.end());
+        printf("flusher=%-3s p50=%8.2fus p99=%8.2fus p999=%8.2fus foreground writes=%llu background writes=%llu\n",
+               use_flusher ? "on" : "off", latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100],
+               latencies[latencies.size() * 999 / 1000],
+               static_cast<unsigned long long>(bpm->GetForegroundWriteCount() - foreground_writes_before),  // NOLINT
+               static_cast<unsigned long long>(bpm->GetBackgroundWriteCount()));                          // NOLINT
+
+        disk_manager->ShutDown();
+        remove("test.db");
+        remove("test.log");
+
+        delete bpm;
+        delete disk_manager;
+    }
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Checkpoint-like flush of a pool where every page is dirty and the pages sit in the frames in random order.
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, DISABLED_FlushAllPagesBenchmark) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 16384;
+    const int rounds = 5;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    std::vector<page_id_t> page_ids(buffer_pool_size);
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_ids[i]));
+    }
+    // free the frames again in random order, so that re-fetching scatters the page ids over the frames
+    std::shuffle(page_ids.begin(), page_ids.end(), std::default_random_engine(0));
+    for (page_id_t page_id : page_ids) {
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+        EXPECT_EQ(true, bpm->DeletePage(page_id));
+    }
+    for (page_id_t page_id : page_ids) {
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    }
+
+    for (int round = 0; round < rounds; ++round) {
+        for (page_id_t page_id : page_ids) {
+            EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+            ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        }
+        auto start = std::chrono::steady_clock::now();
+        bpm->FlushAllPages();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("round=%d %12.0f pages/s\n", round, buffer_pool_size / elapsed.count());
+    }
+    for (page_id_t page_id : page_ids) {
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Resize grows the pool by adding free frames and shrinks it by evicting the pages of the retired frames, check that
+// no page content is lost either way and that pinned pages hold up a shrink.
+TEST(BufferPoolManagerTest, ResizeTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 4;
+    const size_t max_pool_size = 16;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::LRU,
+                                      nullptr, nullptr, max_pool_size);
+    EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+    EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+
+    // Scenario: sizes out of range are refused.
+    EXPECT_EQ(false, bpm->Resize(0));
+    EXPECT_EQ(false, bpm->Resize(max_pool_size + 1));
+
+    // Scenario: with all frames pinned there is no room for a new page until the pool grows.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->Resize(max_pool_size));
+    EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+    for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+    // Scenario: a shrink times out on pinned pages in the retired frames and keeps the old size.
+    EXPECT_EQ(false, bpm->Resize(buffer_pool_size, std::chrono::milliseconds(10)));
+    EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+
+    // Scenario: once they are unpinned the dirty pages are written back and the pool shrinks.
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+    EXPECT_EQ(true, bpm->Resize(buffer_pool_size));
+    EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+    // the frames kept hold max_pool_size - buffer_pool_size pages less than before
+    EXPECT_EQ(max_pool_size - buffer_pool_size, bpm->GetStats().Get(BufferPoolCounter::EVICTIONS));
+
+    // Scenario: every page is still there, and only buffer_pool_size of them fit at a time.
+    char expected[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+        auto* page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "%d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: growing again reuses the retired frames.
+    EXPECT_EQ(true, bpm->Resize(buffer_pool_size + 1));
+    EXPECT_EQ(buffer_pool_size + 1, bpm->GetPoolSize());
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Resize the pool up and down while other threads fetch, update and unpin pages, every fetch must see the content
+// last written to its page.
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 16;
+    const size_t max_pool_size = 64;
+    const int num_pages = 128;
+    const int num_threads = 4;
+    const int rounds = 5000;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::LRU,
+                                      nullptr, nullptr, max_pool_size);
+
+    // every page holds its id and a version, each thread only updates the pages it owns
+    page_id_t page_id_temp;
+    for (int i = 0; i < num_pages; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d %d", page_id_temp, 0);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([bpm, t]() {
+            std::default_random_engine rng(t);
+            std::uniform_int_distribution<page_id_t> page_dist(0, num_pages / num_threads - 1);
+            std::vector<int> versions(num_pages / num_threads, 0);
+            char expected[PAGE_SIZE];
+            for (int i = 0; i < rounds; ++i) {
+                int index = page_dist(rng);
+                page_id_t page_id = index * num_threads + t;
+                auto* page = bpm->FetchPage(page_id);
+                if (page == nullptr) {
+                    // every frame is pinned by the other threads right now
+                    continue;
+                }
+                snprintf(expected, PAGE_SIZE, "%d %d", page_id, versions[index]);
+                EXPECT_EQ(page_id, page->GetPageId());
+                EXPECT_EQ(0, strcmp(page->GetData(), expected));
+                bool update = i % 2 == 0;
+                if (update) {
+                    snprintf(page->GetData(), PAGE_SIZE, "%d %d", page_id, ++versions[index]);
+                }
+                EXPECT_EQ(true, bpm->UnpinPage(page_id, update));
+            }
+        });
+    }
+
+    std::thread resizer([bpm, &done]() {
+        std::default_random_engine rng(num_threads);
+        std::uniform_int_distribution<size_t> size_dist(num_threads, max_pool_size);
+        while (!done) {
+            // the workers only pin briefly, a shrink never has to wait long
+            EXPECT_EQ(true, bpm->Resize(size_dist(rng)));
+        }
+    });
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done = true;
+    resizer.join();
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
 }  // namespace bustub
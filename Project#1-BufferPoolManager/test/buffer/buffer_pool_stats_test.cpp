@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats_test.cpp
+//
+// Identification: test/buffer/buffer_pool_stats_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, AggregationTest) {
+    const int num_threads = 8;
+    const int adds_per_thread = 10000;
+    BufferPoolStats stats;
+
+    // Scenario: counts of many threads add up, no matter how the threads map to shards.
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&stats]() {
+            for (int i = 0; i < adds_per_thread; ++i) {
+                stats.Add(BufferPoolCounter::HITS);
+                if (i % 10 == 0) {
+                    stats.Add(BufferPoolCounter::MISSES);
+                }
+                stats.RecordFetchLatency(std::chrono::nanoseconds(i % 10 == 0 ? 100000 : 100));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    BufferPoolStatsSnapshot snapshot = stats.Snapshot();
+    EXPECT_EQ(num_threads * adds_per_thread, snapshot.Get(BufferPoolCounter::HITS));
+    EXPECT_EQ(num_threads * adds_per_thread / 10, snapshot.Get(BufferPoolCounter::MISSES));
+    EXPECT_EQ(0, snapshot.Get(BufferPoolCounter::EVICTIONS));
+    EXPECT_DOUBLE_EQ(10.0 / 11, snapshot.HitRatio());
+
+    // Scenario: 100ns falls into [64, 128), 100us into [65536, 131072).
+    EXPECT_EQ(128, snapshot.FetchLatencyPercentile(50));
+    EXPECT_EQ(128, snapshot.FetchLatencyPercentile(90));
+    EXPECT_EQ(131072, snapshot.FetchLatencyPercentile(99));
+
+    // Scenario: snapshots add up.
+    snapshot += stats.Snapshot();
+    EXPECT_EQ(2 * num_threads * adds_per_thread, snapshot.Get(BufferPoolCounter::HITS));
+
+    // Scenario: an empty snapshot has no ratio and no latency.
+    BufferPoolStatsSnapshot empty;
+    EXPECT_EQ(0, empty.HitRatio());
+    EXPECT_EQ(0, empty.FetchLatencyPercentile(99));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, BufferPoolManagerTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 5;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+    // Fill the pool with dirty pages, then create 2 more, which evicts and writes back 2 of them.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size + 2; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    BufferPoolStatsSnapshot stats = bpm->GetStats();
+    EXPECT_EQ(0, stats.Get(BufferPoolCounter::HITS));
+    EXPECT_EQ(0, stats.Get(BufferPoolCounter::MISSES));
+    EXPECT_EQ(2, stats.Get(BufferPoolCounter::EVICTIONS));
+    EXPECT_EQ(2, stats.Get(BufferPoolCounter::DIRTY_WRITEBACKS));
+
+    // Pages 2 to 6 are resident, pages 0 and 1 are not and replace the dirty pages 2 and 3.
+    for (page_id_t page_id : {2, 3, 4, 5, 6, 0, 1}) {
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+    stats = bpm->GetStats();
+    EXPECT_EQ(5, stats.Get(BufferPoolCounter::HITS));
+    EXPECT_EQ(2, stats.Get(BufferPoolCounter::MISSES));
+    EXPECT_EQ(4, stats.Get(BufferPoolCounter::EVICTIONS));
+    EXPECT_EQ(4, stats.Get(BufferPoolCounter::DIRTY_WRITEBACKS));
+    EXPECT_EQ(0, stats.Get(BufferPoolCounter::PIN_WAITS));
+    EXPECT_EQ(4, bpm->GetForegroundWriteCount());
+
+    // Scenario: one in LATENCY_SAMPLE_PERIOD fetches is timed.
+    for (uint32_t i = 0; i < BufferPoolStats::LATENCY_SAMPLE_PERIOD; ++i) {
+        ASSERT_NE(nullptr, bpm->FetchPage(0));
+        EXPECT_EQ(true, bpm->UnpinPage(0, false));
+    }
+    stats = bpm->GetStats();
+    EXPECT_EQ(5 + BufferPoolStats::LATENCY_SAMPLE_PERIOD, stats.Get(BufferPoolCounter::HITS));
+    EXPECT_LT(0, stats.FetchLatencyPercentile(100));
+
+    // Scenario: both dumps contain every counter.
+    std::string text = stats.ToString();
+    std::string json = stats.ToJson();
+    EXPECT_NE(std::string::npos, text.find("hits: 21\n"));
+    EXPECT_NE(std::string::npos, text.find("dirty_writebacks: 4\n"));
+    EXPECT_EQ('{', json.front());
+    EXPECT_EQ('}', json.back());
+    EXPECT_NE(std::string::npos, json.find("\"misses\":2,"));
+    EXPECT_NE(std::string::npos, json.find("\"pin_waits\":0,"));
+    EXPECT_NE(std::string::npos, json.find("\"fetch_latency_ns\":{\"histogram\":[["));
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, ParallelBufferPoolManagerTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 5;
+    const size_t num_instances = 3;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+        ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_instances * buffer_pool_size); ++page_id) {
+        ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    // Scenario: the stats of the instances are added up.
+    BufferPoolStatsSnapshot stats = bpm->GetStats();
+    EXPECT_EQ(num_instances * buffer_pool_size, stats.Get(BufferPoolCounter::HITS));
+    EXPECT_EQ(0, stats.Get(BufferPoolCounter::MISSES));
+    EXPECT_EQ(1.0, stats.HitRatio());
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+}  // namespace bustub
@@ -10,11 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <memory>
+#include <random>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/clock_replacer.h"
+#include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -80,4 +84,39 @@ TEST(ClockReplacerTest, CornerCaseTest) {
     EXPECT_EQ(0, clock_replacer.Size());
 }
 
+// Replays the replacer calls a buffer pool makes under a scan-heavy workload: most accesses
+// miss, victimize a frame and unpin it again, a few hit a frame and pin/unpin it.
+static double ReplacerNsPerOp(Replacer* replacer, size_t num_frames, size_t num_ops) {
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<int> percent_dist(0, 99);
+    std::uniform_int_distribution<frame_id_t> frame_dist(0, static_cast<frame_id_t>(num_frames) - 1);
+    for (size_t i = 0; i < num_frames; ++i) {
+        replacer->Unpin(static_cast<frame_id_t>(i));
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < num_ops; ++i) {
+        frame_id_t frame_id;
+        if (percent_dist(rng) < 90) {
+            replacer->Victim(&frame_id);
+        } else {
+            frame_id = frame_dist(rng);
+            replacer->Pin(frame_id);
+        }
+        replacer->Unpin(frame_id);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / num_ops;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST(ClockReplacerTest, DISABLED_ScanCostBenchmark) {
+    const size_t num_ops = 5000000;
+    for (size_t num_frames : {64, 1024, 65536}) {
+        auto lru = std::make_unique<LRUReplacer>(num_frames);
+        auto clock = std::make_unique<ClockReplacer>(num_frames);
+        printf("frames=%-6zu LRUReplacer %6.1f ns/op  ClockReplacer %6.1f ns/op\n", num_frames,
+               ReplacerNsPerOp(lru.get(), num_frames, num_ops), ReplacerNsPerOp(clock.get(), num_frames, num_ops));
+    }
+}
+
 }  // namespace bustub
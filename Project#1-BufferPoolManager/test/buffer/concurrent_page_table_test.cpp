@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// concurrent_page_table_test.cpp
+//
+// Identification: test/buffer/concurrent_page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/concurrent_page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ConcurrentPageTableTest, SampleTest) {
+    ConcurrentPageTable page_table(4);
+    frame_id_t frame_id;
+
+    EXPECT_FALSE(page_table.Find(0, &frame_id));
+    EXPECT_FALSE(page_table.Find(INVALID_PAGE_ID, &frame_id));
+    EXPECT_FALSE(page_table.Remove(INVALID_PAGE_ID));
+
+    page_table.Insert(0, 3);
+    page_table.Insert(16, 2);
+    page_table.Insert(32, 1);
+    ASSERT_TRUE(page_table.Find(16, &frame_id));
+    EXPECT_EQ(2, frame_id);
+
+    // Scenario: inserting a mapped page again moves it to the new frame.
+    page_table.Insert(16, 0);
+    ASSERT_TRUE(page_table.Find(16, &frame_id));
+    EXPECT_EQ(0, frame_id);
+
+    EXPECT_TRUE(page_table.Remove(0));
+    EXPECT_FALSE(page_table.Remove(0));
+    EXPECT_FALSE(page_table.Find(0, &frame_id));
+    ASSERT_TRUE(page_table.Find(32, &frame_id));
+    EXPECT_EQ(1, frame_id);
+}
+
+// Random inserts and removes with strided page ids, as a ParallelBufferPoolManager instance sees them.
+// Removal shifts entries around, every remaining entry must still be found.
+TEST(ConcurrentPageTableTest, RandomTest) {
+    const size_t num_frames = 64;
+    ConcurrentPageTable page_table(num_frames);
+    std::unordered_map<page_id_t, frame_id_t> expected;
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> page_dist(0, 255);
+
+    for (int i = 0; i < 100000; ++i) {
+        page_id_t page_id = page_dist(rng) * 8 + 3;
+        if (expected.count(page_id) != 0) {
+            EXPECT_TRUE(page_table.Remove(page_id));
+            expected.erase(page_id);
+        } else if (expected.size() < num_frames) {
+            page_table.Insert(page_id, i % num_frames);
+            expected[page_id] = i % num_frames;
+        }
+        if (i % 1000 == 0) {
+            for (page_id_t candidate = 3; candidate < 256 * 8; candidate += 8) {
+                frame_id_t frame_id;
+                bool found = page_table.Find(candidate, &frame_id);
+                ASSERT_EQ(expected.count(candidate) != 0, found);
+                if (found) {
+                    EXPECT_EQ(expected[candidate], frame_id);
+                }
+            }
+        }
+    }
+}
+
+}  // namespace bustub
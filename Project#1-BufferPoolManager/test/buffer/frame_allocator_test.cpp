@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_allocator_test.cpp
+//
+// Identification: test/buffer/frame_allocator_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_allocator.h"
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+static const char *BackingName(HugePageFrameAllocator::Backing backing) {
+    switch (backing) {
+        case HugePageFrameAllocator::Backing::HUGETLB:
+            return "hugetlb";
+        case HugePageFrameAllocator::Backing::TRANSPARENT_HUGE_PAGES:
+            return "transparent huge pages";
+        case HugePageFrameAllocator::Backing::HEAP:
+        default:
+            return "heap";
+    }
+}
+
+// NOLINTNEXTLINE
+TEST(FrameAllocatorTest, SampleTest) {
+    DefaultFrameAllocator default_allocator;
+    HugePageFrameAllocator huge_page_allocator;
+    const size_t size = 3 * PAGE_SIZE + 100;
+
+    for (FrameAllocator* allocator : {static_cast<FrameAllocator*>(&default_allocator),
+                                      static_cast<FrameAllocator*>(&huge_page_allocator)}) {
+        // Scenario: an empty region is nullptr.
+        EXPECT_EQ(nullptr, allocator->Allocate(0));
+
+        // Scenario: regions are page aligned, zeroed and writable.
+        char* region = allocator->Allocate(size);
+        ASSERT_NE(nullptr, region);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(region) % PAGE_SIZE);
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(0, region[i]);
+        }
+        memset(region, 'x', size);
+        allocator->Deallocate(region, size);
+    }
+
+    // Scenario: whatever backs a huge page region, a mapped one is huge page aligned.
+    char* region = huge_page_allocator.Allocate(size);
+    HugePageFrameAllocator::Backing backing = huge_page_allocator.GetBacking(region);
+    if (backing != HugePageFrameAllocator::Backing::HEAP) {
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(region) % HugePageFrameAllocator::HUGE_PAGE_SIZE);
+    }
+    huge_page_allocator.Deallocate(region, size);
+}
+
+// NOLINTNEXTLINE
+TEST(FrameAllocatorTest, BufferPoolManagerTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 10;
+
+    auto* disk_manager = new DiskManager(db_name);
+    HugePageFrameAllocator allocator;
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::LRU,
+                                      &allocator);
+
+    // Scenario: every frame is page aligned.
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(bpm->GetPages()[i].GetData()) % PAGE_SIZE);
+    }
+
+    // Scenario: pages round trip through the disk.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    char expected[PAGE_SIZE];
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(2 * buffer_pool_size); ++page_id) {
+        auto* page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(expected, PAGE_SIZE, "%d", page_id);
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Random fetches over a large, fully resident pool, reading a word of every fetched page, so that the cost is
+// dominated by TLB misses on the page table, the Page array and the frame data.
+// NOLINTNEXTLINE
+TEST(FrameAllocatorTest, DISABLED_RandomFetchBenchmark) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 262144;  // 1GB of frames
+    const int num_fetches = 5000000;
+
+    DefaultFrameAllocator default_allocator;
+    HugePageFrameAllocator huge_page_allocator;
+    for (FrameAllocator* allocator : {static_cast<FrameAllocator*>(&default_allocator),
+                                      static_cast<FrameAllocator*>(&huge_page_allocator)}) {
+        auto* disk_manager = new DiskManager(db_name);
+        auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr,
+                                          BufferPoolManager::ReplacerType::LRU, allocator);
+        std::string name = allocator == &default_allocator
+                               ? "default"
+                               : BackingName(huge_page_allocator.GetBacking(bpm->GetPages()[0].GetData()));
+
+        page_id_t page_id_temp;
+        for (size_t i = 0; i < buffer_pool_size; ++i) {
+            ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+            EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+        }
+
+        std::default_random_engine rng(0);
+        std::uniform_int_distribution<page_id_t> page_dist(0, buffer_pool_size - 1);
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_fetches; ++i) {
+            page_id_t page_id = page_dist(rng);
+            auto* page = bpm->FetchPage(page_id);
+            checksum += page->GetData()[page_id % PAGE_SIZE];
+            bpm->UnpinPage(page_id, false);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        printf("%-24s %12.0f fetch/s (checksum %llu)\n", name.c_str(), num_fetches / elapsed.count(),
+               static_cast<unsigned long long>(checksum));  // NOLINT
+
+        disk_manager->ShutDown();
+        remove("test.db");
+        remove("test.log");
+
+        delete bpm;
+        delete disk_manager;
+    }
+}
+
+}  // namespace bustub
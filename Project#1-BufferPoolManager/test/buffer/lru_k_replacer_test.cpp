@@ -0,0 +1,181 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+
+    // Scenario: access frames 1, 2, 1, 3. Frame 1 is the only one with two accesses.
+    for (frame_id_t frame_id : {1, 2, 1, 3}) {
+        lru_k_replacer.Pin(frame_id);
+        lru_k_replacer.Unpin(frame_id);
+    }
+    EXPECT_EQ(3, lru_k_replacer.Size());
+
+    // Scenario: frames with fewer than K accesses go first, in LRU order.
+    int value;
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(2, value);
+
+    // Scenario: pinned frames cannot be victims.
+    lru_k_replacer.Pin(3);
+    EXPECT_EQ(1, lru_k_replacer.Size());
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+    // Scenario: frame 3 now has two accesses, frame 2 starts over with a new page and one access.
+    lru_k_replacer.Unpin(3);
+    lru_k_replacer.Pin(2);
+    lru_k_replacer.Unpin(2);
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(2, value);
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(3, value);
+    EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+    LRUKReplacer lru_k_replacer(5, 2, 2);
+
+    // Scenario: the second access of frame 1 follows the first one within the correlated reference
+    // period and does not count, the second access of frame 2 does.
+    for (frame_id_t frame_id : {1, 1, 2, 3, 4, 2}) {
+        lru_k_replacer.Pin(frame_id);
+        lru_k_replacer.Unpin(frame_id);
+    }
+
+    int value;
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(1, value);
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(3, value);
+
+    // Scenario: frames 4 and 2 were accessed within the correlated reference period and are not
+    // eligible, but they are still returned when no other frame is.
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(4, value);
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(2, value);
+    EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, RestoreTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+
+    // Scenario: frame 1 has two accesses, frames 2 and 3 one each.
+    for (frame_id_t frame_id : {1, 2, 1, 3}) {
+        lru_k_replacer.Pin(frame_id);
+        lru_k_replacer.Unpin(frame_id);
+    }
+
+    // Scenario: the page of victim 2 is pinned before it can be replaced, restoring the victim keeps it pinned.
+    int value;
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(2, value);
+    lru_k_replacer.Restore(2);
+    EXPECT_EQ(2, lru_k_replacer.Size());
+
+    // Scenario: once unpinned again, frame 2 has two accesses and is evicted after frame 3, which has one.
+    lru_k_replacer.Pin(2);
+    lru_k_replacer.Unpin(2);
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(3, value);
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(1, value);
+
+    // Scenario: the pin was released before the restore, the frame is a candidate right away. Restoring anything but
+    // the last victim does nothing.
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(2, value);
+    lru_k_replacer.Pin(2);
+    lru_k_replacer.Unpin(2);
+    lru_k_replacer.Restore(3);
+    lru_k_replacer.Restore(2);
+    EXPECT_EQ(1, lru_k_replacer.Size());
+    lru_k_replacer.Restore(2);
+    EXPECT_EQ(1, lru_k_replacer.Size());
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(2, value);
+    EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+// Simulates a buffer pool of pool_size frames on top of the replacer, the same way BufferPoolManager
+// drives it: every access of a frame is a Pin followed by an Unpin. Point lookups go to a small hot
+// set of pages while a sequential scan streams through a large table. Returns the lookups' hit ratio.
+static double PointLookupHitRatio(Replacer* replacer, size_t pool_size) {
+    const page_id_t num_hot_pages = 200;
+    const page_id_t num_scan_pages = 20000;
+    const int num_steps = 200000;
+
+    std::unordered_map<page_id_t, frame_id_t> page_table;
+    std::vector<page_id_t> frame_pages(pool_size, INVALID_PAGE_ID);
+    size_t num_used_frames = 0;
+    auto access = [&](page_id_t page_id) {
+        auto it = page_table.find(page_id);
+        bool hit = it != page_table.end();
+        frame_id_t frame_id;
+        if (hit) {
+            frame_id = it->second;
+        } else {
+            if (num_used_frames < pool_size) {
+                frame_id = static_cast<frame_id_t>(num_used_frames++);
+            } else {
+                EXPECT_TRUE(replacer->Victim(&frame_id));
+                page_table.erase(frame_pages[frame_id]);
+            }
+            page_table[page_id] = frame_id;
+            frame_pages[frame_id] = page_id;
+        }
+        replacer->Pin(frame_id);
+        replacer->Unpin(frame_id);
+        return hit;
+    };
+
+    std::default_random_engine rng(0);
+    std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+    int hits = 0;
+    for (int i = 0; i < num_steps; ++i) {
+        hits += access(hot_dist(rng)) ? 1 : 0;
+        access(num_hot_pages + i % num_scan_pages);
+    }
+    return static_cast<double>(hits) / num_steps;
+}
+
+// The hot set fits into the pool, but LRU lets the scan push it out.
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+    const size_t pool_size = 256;
+    LRUReplacer lru_replacer(pool_size);
+    ClockReplacer clock_replacer(pool_size);
+    LRUKReplacer lru_k_replacer(pool_size, 2);
+
+    double lru_hit_ratio = PointLookupHitRatio(&lru_replacer, pool_size);
+    double clock_hit_ratio = PointLookupHitRatio(&clock_replacer, pool_size);
+    double lru_k_hit_ratio = PointLookupHitRatio(&lru_k_replacer, pool_size);
+
+    EXPECT_GT(lru_k_hit_ratio, 0.95);
+    EXPECT_GT(lru_k_hit_ratio, lru_hit_ratio);
+    EXPECT_GT(lru_k_hit_ratio, clock_hit_ratio);
+}
+
+}  // namespace bustub
@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 5;
+    const size_t num_instances = 2;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+    EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+    page_id_t page_id_temp;
+    auto* page0 = bpm->NewPage(&page_id_temp);
+
+    // Scenario: The buffer pool is empty. We should be able to create a new page.
+    ASSERT_NE(nullptr, page0);
+    EXPECT_EQ(0, page_id_temp);
+
+    // Scenario: Once we have a page, we should be able to read and write content.
+    snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+    EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+    // Scenario: We should be able to create new pages until we fill up the buffer pool.
+    // New pages are handed out round robin, so consecutive page ids alternate between instances.
+    for (size_t i = 1; i < buffer_pool_size * num_instances; ++i) {
+        EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+        EXPECT_EQ(bpm->GetBufferPoolManager(page_id_temp), bpm->GetBufferPoolManager(i % num_instances));
+    }
+
+    // Scenario: Once every instance is full, we should not be able to create any new pages.
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+        EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+        EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+    }
+
+    // Scenario: After unpinning page 0 only its instance has a free frame, and NewPage must find it
+    // no matter which instance the round robin starts from.
+    EXPECT_EQ(true, bpm->UnpinPage(0, true));
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(0, page_id_temp % static_cast<page_id_t>(num_instances));
+    EXPECT_EQ(nullptr, bpm->FetchPage(0));
+
+    // Scenario: Unpin a page on the other instance; page 0 must still be read back from its own instance.
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    page0 = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page0);
+    EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+    EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+    // Scenario: Pages are deleted from the instance that owns them.
+    EXPECT_EQ(false, bpm->DeletePage(1));
+    EXPECT_EQ(true, bpm->UnpinPage(1, false));
+    EXPECT_EQ(true, bpm->DeletePage(1));
+
+    // Shutdown the disk manager and remove the temporary file we created.
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete bpm;
+    delete disk_manager;
+}
+
+// Every thread fetches and unpins random pages from a pool that holds all of them, so the run time is dominated by
+// the buffer pool's own synchronization rather than by disk I/O.
+static double FetchThroughput(BufferPoolManager* bpm, const std::vector<page_id_t>& page_ids, size_t num_threads,
+                              size_t ops_per_thread) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t]() {
+            std::mt19937 rng(t);
+            std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+            for (size_t i = 0; i < ops_per_thread; i++) {
+                page_id_t page_id = page_ids[dist(rng)];
+                Page* page = bpm->FetchPage(page_id);
+                EXPECT_NE(nullptr, page);
+                bpm->UnpinPage(page_id, false);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(num_threads * ops_per_thread) / elapsed.count();
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_ScalingBenchmark) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 1024;
+    const size_t num_instances = 16;
+    const size_t ops_per_thread = 200000;
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* single = new BufferPoolManager(buffer_pool_size * num_instances, disk_manager);
+    auto* parallel = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+    for (BufferPoolManager* bpm : {static_cast<BufferPoolManager*>(single), static_cast<BufferPoolManager*>(parallel)}) {
+        std::vector<page_id_t> page_ids;
+        page_id_t page_id_temp;
+        for (size_t i = 0; i < buffer_pool_size * num_instances; i++) {
+            ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+            bpm->UnpinPage(page_id_temp, false);
+            page_ids.push_back(page_id_temp);
+        }
+        for (size_t num_threads = 1; num_threads <= 32; num_threads *= 2) {
+            double ops = FetchThroughput(bpm, page_ids, num_threads, ops_per_thread);
+            printf("%-26s threads=%-2zu %12.0f fetch+unpin/s\n",
+                   bpm == single ? "BufferPoolManager" : "ParallelBufferPoolManager", num_threads, ops);
+        }
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete parallel;
+    delete single;
+    delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,223 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// direct_io_disk_backend_test.cpp
+//
+// Identification: test/storage/direct_io_disk_backend_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/direct_io_disk_backend.h"
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_allocator.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+static void FillPage(char* data, page_id_t page_id) {
+    memset(data, 0, PAGE_SIZE);
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+    data[PAGE_SIZE - 1] = static_cast<char>(page_id);
+}
+
+static bool CheckPage(const char* data, page_id_t page_id) {
+    char expected[PAGE_SIZE];
+    FillPage(expected, page_id);
+    return memcmp(data, expected, PAGE_SIZE) == 0;
+}
+
+// NOLINTNEXTLINE
+TEST(DirectIODiskBackendTest, SampleTest) {
+    const std::string db_name = "test.db";
+    remove(db_name.c_str());
+    auto* backend = new DirectIODiskBackend(db_name);
+    DefaultFrameAllocator allocator;
+    char* frame = allocator.Allocate(PAGE_SIZE);
+
+    // Scenario: reading past the end of the file returns zeroes.
+    memset(frame, 'x', PAGE_SIZE);
+    backend->ReadPage(3, frame);
+    for (size_t i = 0; i < PAGE_SIZE; ++i) {
+        ASSERT_EQ(0, frame[i]);
+    }
+
+    // Scenario: an aligned page round trips.
+    FillPage(frame, 3);
+    backend->WritePage(3, frame);
+    memset(frame, 0, PAGE_SIZE);
+    backend->ReadPage(3, frame);
+    EXPECT_TRUE(CheckPage(frame, 3));
+
+    // Scenario: unaligned buffers go through the bounce buffer.
+    std::vector<char> buffer(PAGE_SIZE + 1);
+    char* unaligned = buffer.data() + (reinterpret_cast<uintptr_t>(buffer.data()) % PAGE_SIZE == 0 ? 1 : 0);
+    FillPage(unaligned, 5);
+    backend->WritePage(5, unaligned);
+    memset(unaligned, 0, PAGE_SIZE);
+    backend->ReadPage(5, unaligned);
+    EXPECT_TRUE(CheckPage(unaligned, 5));
+    backend->ReadPage(3, unaligned);
+    EXPECT_TRUE(CheckPage(unaligned, 3));
+
+    allocator.Deallocate(frame, PAGE_SIZE);
+    delete backend;
+    remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(DirectIODiskBackendTest, BatchTest) {
+    const std::string db_name = "test.db";
+    remove(db_name.c_str());
+    auto* backend = new DirectIODiskBackend(db_name);
+    // more pages than the ring keeps in flight, in runs of various lengths
+    const size_t num_pages = 3 * DirectIODiskBackend::QUEUE_DEPTH;
+    DefaultFrameAllocator allocator;
+    char* frames = allocator.Allocate(num_pages * PAGE_SIZE);
+
+    // Scenario: a shuffled batch with holes, runs of 1 to 4 consecutive pages, is written and read back.
+    std::vector<PageIORequest> requests;
+    page_id_t page_id = 0;
+    for (size_t i = 0; i < num_pages; ++i) {
+        if (i % (1 + i % 4) == 0) {
+            ++page_id;
+        }
+        requests.push_back({page_id++, frames + i * PAGE_SIZE});
+        FillPage(requests.back().data_, requests.back().page_id_);
+    }
+    std::vector<PageIORequest> shuffled;
+    for (size_t i = 0; i < num_pages; i += 2) {
+        shuffled.push_back(requests[i]);
+    }
+    for (size_t i = 1; i < num_pages; i += 2) {
+        shuffled.push_back(requests[i]);
+    }
+    backend->WritePages(shuffled);
+
+    memset(frames, 0, num_pages * PAGE_SIZE);
+    backend->ReadPages(shuffled);
+    for (const auto& request : requests) {
+        EXPECT_TRUE(CheckPage(request.data_, request.page_id_)) << "page " << request.page_id_;
+    }
+
+    // Scenario: single page reads see the batched writes, the holes are zeroes.
+    char* frame = allocator.Allocate(PAGE_SIZE);
+    backend->ReadPage(requests[10].page_id_, frame);
+    EXPECT_TRUE(CheckPage(frame, requests[10].page_id_));
+    backend->ReadPage(0, frame);
+    EXPECT_EQ(0, frame[0]);
+
+    // Scenario: an empty batch is a no-op.
+    backend->WritePages({});
+    backend->ReadPages({});
+
+    allocator.Deallocate(frame, PAGE_SIZE);
+    allocator.Deallocate(frames, num_pages * PAGE_SIZE);
+    delete backend;
+    remove(db_name.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(DirectIODiskBackendTest, BufferPoolManagerTest) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 10;
+    remove(db_name.c_str());
+
+    auto* disk_manager = new DiskManager(db_name);
+    auto* backend = new DirectIODiskBackend(db_name);
+    auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, BufferPoolManager::ReplacerType::LRU,
+                                      nullptr, backend);
+
+    // Scenario: evictions write through the backend, misses read through it.
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < 3 * buffer_pool_size; ++i) {
+        auto* page = bpm->NewPage(&page_id_temp);
+        ASSERT_NE(nullptr, page);
+        FillPage(page->GetData(), page_id_temp);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(3 * buffer_pool_size); ++page_id) {
+        auto* page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_TRUE(CheckPage(page->GetData(), page_id));
+        // dirty them again for FlushAllPages
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+
+    // Scenario: FlushAllPages writes the resident pages as one batch.
+    bpm->FlushAllPages();
+    delete bpm;
+    delete backend;
+    backend = new DirectIODiskBackend(db_name);
+    char* frame = DefaultFrameAllocator::Instance()->Allocate(PAGE_SIZE);
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(3 * buffer_pool_size); ++page_id) {
+        backend->ReadPage(page_id, frame);
+        EXPECT_TRUE(CheckPage(frame, page_id)) << "page " << page_id;
+    }
+    DefaultFrameAllocator::Instance()->Deallocate(frame, PAGE_SIZE);
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.log");
+
+    delete backend;
+    delete disk_manager;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// FlushAllPages of a pool full of dirty pages, through the DiskManager and through the direct I/O backend.
+// NOLINTNEXTLINE
+TEST(DirectIODiskBackendTest, DISABLED_FlushAllPagesBenchmark) {
+    const std::string db_name = "test.db";
+    const size_t buffer_pool_size = 16384;  // 64MB of frames
+    const int num_rounds = 5;
+
+    for (bool direct : {false, true}) {
+        remove(db_name.c_str());
+        auto* disk_manager = new DiskManager(db_name);
+        DirectIODiskBackend* backend = direct ? new DirectIODiskBackend(db_name) : nullptr;
+        auto* bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr,
+                                          BufferPoolManager::ReplacerType::LRU, nullptr, backend);
+
+        page_id_t page_id_temp;
+        for (size_t i = 0; i < buffer_pool_size; ++i) {
+            ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+            EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+        }
+
+        std::chrono::duration<double> elapsed(0);
+        for (int round = 0; round < num_rounds; ++round) {
+            for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+                auto* page = bpm->FetchPage(page_id);
+                page->GetData()[0] = static_cast<char>(round);
+                bpm->UnpinPage(page_id, true);
+            }
+            auto start = std::chrono::steady_clock::now();
+            bpm->FlushAllPages();
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+        std::string name = !direct                   ? "disk manager"
+                           : !backend->IsDirectIO() ? "buffered"
+                           : backend->UsesIoUring() ? "O_DIRECT + io_uring"
+                                                    : "O_DIRECT + pwritev";
+        printf("%-24s %10.1f MB/s\n", name.c_str(),
+               num_rounds * buffer_pool_size * PAGE_SIZE / elapsed.count() / (1 << 20));
+
+        disk_manager->ShutDown();
+        remove("test.db");
+        remove("test.log");
+
+        delete bpm;
+        delete backend;
+        delete disk_manager;
+    }
+}
+
+}  // namespace bustub
@@ -26,14 +26,26 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   for (size_t i = 0; i < pool_size_; ++i) {
     free_list_.emplace_back(static_cast<frame_id_t>(i));
   }
+
+  for (size_t i = 0; i < PREFETCH_IO_THREADS; ++i) {
+    prefetch_workers_.emplace_back(&BufferPoolManager::PrefetchWorkerLoop, this);
+  }
 }
 
 BufferPoolManager::~BufferPoolManager() {
+  {
+    const std::lock_guard<std::mutex> guard(prefetch_mutex_);
+    prefetch_shutdown_ = true;
+  }
+  prefetch_cv_.notify_all();
+  for (auto &worker : prefetch_workers_) {
+    worker.join();
+  }
   delete[] pages_;
   delete replacer_;
 }
 
-Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
+Page *BufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the
@@ -43,7 +55,10 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to
   // P.
-  const std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // a prefetch of the page may be reading it in right now
+  io_cv_.wait(lock, [&] { return prefetching_pages_.count(page_id) == 0; });
 
   // try to find the page_id page in the bufferPool
   // use bufferPool map <page, frame> , the buffer contains frames to storage page
@@ -64,44 +79,74 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
     return the_page_in_frame;
   }
 
-  if (!free_list_.empty()) {
-    // use the free list the first front frame as frame will be used to storage the page
-    // move the needed page in the frame
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    bool victim_found = replacer_->Victim(&frame_id);
-    // try to find victim frame to storage the needed page
-    // the frame_id will be update to the victim frame id
-    if (!victim_found) {
-      return nullptr;
-    }
+  // try to find victim frame to storage the needed page
+  // the frame_id will be update to the victim frame id
+  if (!ClaimFrame(page_id, strategy, &frame_id)) {
+    return nullptr;
   }
   // find victim successfully, frame_id update to the victim frame id
   Page *replacedPage_in_frame = &pages_[frame_id];
 
-  if (replacedPage_in_frame->IsDirty()) {
-    disk_manager_->WritePage(replacedPage_in_frame->GetPageId(), replacedPage_in_frame->GetData());
-    replacedPage_in_frame->is_dirty_ = false;
-  }
-
-  page_table_.erase(replacedPage_in_frame->GetPageId());
-
-  // create new element <page_id_t, frame_id_t> in page_table
-  page_table_.emplace(page_id, frame_id);
-
-  replacedPage_in_frame->page_id_ = page_id;
-
-  ++replacedPage_in_frame->pin_count_;
-
-  replacer_->Pin(frame_id);
-
   disk_manager_->ReadPage(page_id, replacedPage_in_frame->GetData());
 
   // now the needed page is storaged in the frame_id frame's replaced page's position
   return replacedPage_in_frame;
 }
 
+void BufferPoolManager::Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  // Frames are claimed right here so that the strategy's ring is only touched by its owner, and only the reads are
+  // handed to the I/O threads. Pages already in the pool, or for which no frame is free, are skipped: read-ahead is
+  // a hint and never waits.
+  std::vector<std::pair<page_id_t, frame_id_t>> reads;
+  {
+    const std::lock_guard<std::mutex> guard(latch_);
+    for (page_id_t page_id : page_ids) {
+      frame_id_t frame_id;
+      if (page_id == INVALID_PAGE_ID || page_table_.count(page_id) != 0 || !ClaimFrame(page_id, strategy, &frame_id)) {
+        continue;
+      }
+      // the frame stays pinned until the read finished, so it can not be replaced in between
+      prefetching_pages_.insert(page_id);
+      reads.emplace_back(page_id, frame_id);
+    }
+  }
+  if (reads.empty()) {
+    return;
+  }
+  {
+    const std::lock_guard<std::mutex> guard(prefetch_mutex_);
+    prefetch_queue_.insert(prefetch_queue_.end(), reads.begin(), reads.end());
+  }
+  prefetch_cv_.notify_all();
+}
+
+void BufferPoolManager::PrefetchWorkerLoop() {
+  std::unique_lock<std::mutex> prefetch_lock(prefetch_mutex_);
+  while (true) {
+    // drain the queue before exiting, every queued page holds a pinned frame
+    prefetch_cv_.wait(prefetch_lock, [&] { return !prefetch_queue_.empty() || prefetch_shutdown_; });
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    auto [page_id, frame_id] = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    prefetch_lock.unlock();
+
+    disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+
+    {
+      const std::lock_guard<std::mutex> guard(latch_);
+      prefetching_pages_.erase(page_id);
+      // nobody could have pinned the page yet, hand it to the replacer like an unpin would
+      pages_[frame_id].pin_count_ = 0;
+      replacer_->Unpin(frame_id);
+    }
+    io_cv_.notify_all();
+
+    prefetch_lock.lock();
+  }
+}
+
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
   const std::lock_guard<std::mutex> guard(latch_);
 
@@ -142,7 +187,10 @@ bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
   // make sure the page_id is valid
   assert(page_id != INVALID_PAGE_ID);
 
-  const std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+
+  // the frame content is not valid until the prefetch read finished
+  io_cv_.wait(lock, [&] { return prefetching_pages_.count(page_id) == 0; });
 
   std::unordered_map<page_id_t, frame_id_t>::iterator table_item_it = page_table_.find(page_id);
 
@@ -184,14 +232,8 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
 
   frame_id_t frame_id;
 
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    bool victim_found = replacer_->Victim(&frame_id);
-    if (!victim_found) {
-      return nullptr;
-    }
+  if (!FindReplacementFrame(&frame_id)) {
+    return nullptr;
   }
 
   Page *replacedPage_in_frame = &pages_[frame_id];
@@ -228,7 +270,9 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return
   // it to the free list.
-  const std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+
+  io_cv_.wait(lock, [&] { return prefetching_pages_.count(page_id) == 0; });
 
   std::unordered_map<page_id_t, frame_id_t>::iterator table_item_it = page_table_.find(page_id);
 
@@ -277,4 +321,60 @@ void BufferPoolManager::FlushAllPagesImpl() {
   }
 }
 
+bool BufferPoolManager::FindReplacementFrame(frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    // use the free list the first front frame as frame will be used to storage the page
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  return replacer_->Victim(frame_id);
+}
+
+bool BufferPoolManager::ClaimFrame(page_id_t page_id, BufferAccessStrategy *strategy, frame_id_t *frame_id) {
+  bool victim_found = strategy != nullptr ? FindStrategyFrame(strategy, frame_id) : FindReplacementFrame(frame_id);
+  if (!victim_found) {
+    return false;
+  }
+  Page *replacedPage_in_frame = &pages_[*frame_id];
+
+  if (replacedPage_in_frame->IsDirty()) {
+    disk_manager_->WritePage(replacedPage_in_frame->GetPageId(), replacedPage_in_frame->GetData());
+    replacedPage_in_frame->is_dirty_ = false;
+  }
+
+  page_table_.erase(replacedPage_in_frame->GetPageId());
+
+  // create new element <page_id_t, frame_id_t> in page_table
+  page_table_.emplace(page_id, *frame_id);
+
+  replacedPage_in_frame->page_id_ = page_id;
+
+  ++replacedPage_in_frame->pin_count_;
+
+  replacer_->Pin(*frame_id);
+
+  if (strategy != nullptr) {
+    // remember the page in the ring, the frame is reused after the scan went once around the ring
+    strategy->ring_[strategy->current_] = {*frame_id, page_id};
+    strategy->current_ = (strategy->current_ + 1) % strategy->ring_.size();
+  }
+  return true;
+}
+
+bool BufferPoolManager::FindStrategyFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) {
+  const BufferAccessStrategy::RingSlot &slot = strategy->ring_[strategy->current_];
+  if (slot.frame_id_ != -1) {
+    Page *ring_page = &pages_[slot.frame_id_];
+    // the frame is only ours to recycle if nobody replaced its page or is still using it
+    if (ring_page->GetPageId() == slot.page_id_ && ring_page->GetPinCount() == 0) {
+      // take it out of the replacer, it is unpinned and therefore in there
+      replacer_->Pin(slot.frame_id_);
+      *frame_id = slot.frame_id_;
+      return true;
+    }
+  }
+  return FindReplacementFrame(frame_id);
+}
+
 }  // namespace bustub
@@ -11,6 +11,12 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include "common/exception.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "type/type.h"
+
 namespace bustub {
 
 // lab3 task2 modify
@@ -21,25 +27,134 @@ IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanP
 }
 // lab3 task2 modify
 void IndexScanExecutor::Init() {
-  index_iter = std::make_unique<INDEXITERATOR_TYPE>(GetBPlusTreeIndex()->GetBeginIterator());
+  std::optional<TupleBound> lower;
+  std::optional<TupleBound> upper;
+  DeriveKeyBounds(&lower, &upper);
+
+  if (auto *art_index = dynamic_cast<ArtIndex *>(index_info_->index_.get()); art_index != nullptr) {
+    index_iter.reset();
+    rids_.clear();
+    rid_pos_ = 0;
+    art_index->ScanRange(lower, upper, &rids_);
+    return;
+  }
+  // 哈希索引只支持等值查找, 不能按范围扫描
+  if (GetBPlusTreeIndex() == nullptr) {
+    throw NotImplementedException("IndexScan: the index does not support range scans");
+  }
+
+  auto to_key_bound = [this](const std::optional<TupleBound> &bound) -> std::optional<KeyBound> {
+    if (!bound.has_value()) {
+      return std::nullopt;
+    }
+    KeyBound key_bound{KeyType(), bound->inclusive_};
+    GetBPlusTreeIndex()->SetIndexKey(&key_bound.key_, bound->key_);
+    return key_bound;
+  };
+  index_iter = std::make_unique<INDEXITERATOR_TYPE>(
+      GetBPlusTreeIndex()->GetBeginIterator(to_key_bound(lower), to_key_bound(upper)));
 }
+
+/*
+ * ComparisonExpression 不暴露比较类型, 因此把索引列分别取最小值, 常量和最大值代入谓词,
+ * 由三次求值的结果得出范围: 小于常量的值不满足则有下界, 大于常量的值不满足则有上界,
+ * 常量本身是否满足决定界是否闭合. 谓词仍会对每个 tuple 求值, 界只用来缩小扫描范围.
+ */
+void IndexScanExecutor::DeriveKeyBounds(std::optional<TupleBound> *lower, std::optional<TupleBound> *upper) {
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(plan_->GetPredicate());
+  const auto &key_attrs = index_info_->index_->GetKeyAttrs();
+  if (comparison == nullptr || key_attrs.size() != 1) {
+    return;
+  }
+
+  const ColumnValueExpression *column = nullptr;
+  const ConstantValueExpression *constant = nullptr;
+  for (const auto *child : comparison->GetChildren()) {
+    if (const auto *column_child = dynamic_cast<const ColumnValueExpression *>(child); column_child != nullptr) {
+      column = column_child;
+    } else if (const auto *constant_child = dynamic_cast<const ConstantValueExpression *>(child);
+               constant_child != nullptr) {
+      constant = constant_child;
+    }
+  }
+  if (column == nullptr || constant == nullptr || column->GetColIdx() != key_attrs[0]) {
+    return;
+  }
+
+  // 只处理数值类型, 其最小值和最大值之间的所有值都可以作为键
+  const Column &key_column = table_info_->schema_.GetColumn(key_attrs[0]);
+  Value key_value = constant->Evaluate(nullptr, nullptr);
+  switch (key_column.GetType()) {
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      break;
+    default:
+      return;
+  }
+  Value min_value = Type::GetMinValue(key_column.GetType());
+  Value max_value = Type::GetMaxValue(key_column.GetType());
+  if (key_value.GetTypeId() != key_column.GetType() || key_value.IsNull() ||
+      key_value.CompareEquals(min_value) == CmpBool::CmpTrue ||
+      key_value.CompareEquals(max_value) == CmpBool::CmpTrue) {
+    return;
+  }
+
+  // 探测用的 schema 只含索引列的拷贝, 使 ColumnValueExpression 按原列号取到探测值
+  Schema probe_schema(std::vector<Column>(key_attrs[0] + 1, key_column));
+  auto satisfies = [&](const Value &value) {
+    Tuple probe_tuple(std::vector<Value>(key_attrs[0] + 1, value), &probe_schema);
+    return comparison->Evaluate(&probe_tuple, &probe_schema).GetAs<bool>();
+  };
+  bool below = satisfies(min_value);
+  bool at = satisfies(key_value);
+  bool above = satisfies(max_value);
+
+  TupleBound bound{Tuple({key_value}, &index_info_->key_schema_), at};
+  if (!below) {
+    *lower = bound;
+  }
+  if (!above) {
+    *upper = bound;
+  }
+}
+
+bool IndexScanExecutor::NextRid(RID *rid) {
+  if (index_iter == nullptr) {
+    if (rid_pos_ == rids_.size()) {
+      return false;
+    }
+    *rid = rids_[rid_pos_++];
+    return true;
+  }
+
+  if (index_iter->isEnd()) {
+    return false;
+  }
+  *rid = (*(*index_iter)).second;
+  ++(*index_iter);
+  return true;
+}
+
 // lab3 task2 modify
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
   // fetch raw tuple from table
   Tuple raw_tuple;
+  RID raw_rid;
 
   do {
-    if (*index_iter == GetBPlusTreeIndex()->GetEndIterator()) {
+    if (!NextRid(&raw_rid)) {
       return false;
     }
 
-    bool fetched = table_info_->table_->GetTuple((*(*index_iter)).second, &raw_tuple, exec_ctx_->GetTransaction());
+    bool fetched = table_info_->table_->GetTuple(raw_rid, &raw_tuple, exec_ctx_->GetTransaction());
 
     if (!fetched) {
       return false;
     }
-
-    ++(*index_iter);
   } while (plan_->GetPredicate() != nullptr &&
            !plan_->GetPredicate()->Evaluate(&raw_tuple, &(table_info_->schema_)).GetAs<bool>());
 
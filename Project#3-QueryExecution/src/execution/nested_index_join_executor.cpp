@@ -26,26 +26,44 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
 }
 
 // lab3 task2 modify
-void NestIndexJoinExecutor::Init() { child_executor_->Init(); }
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  outer_tuples_.clear();
+  inner_rids_.clear();
+  batch_pos_ = 0;
+  inner_pos_ = 0;
+}
 
 // lab3 task2 modify
 bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
-  Tuple left_tuple;
-  RID left_rid;
   Tuple right_raw_tuple;
 
   // fetch next qualified left tuple and right tuple pair
   // 获取下一个符合条件的的 (左元组,右元组) pair
   // 循环终止条件: Probe探测成功 且 谓词为空(无条件约束)或者满足谓词条件
-  do {
-    if (!child_executor_->Next(&left_tuple, &left_rid)) {
-      return false;
+  // 一个左元组可能匹配多个右元组(索引键不唯一), 依次输出每个 (左元组,右元组) pair
+  while (true) {
+    while (batch_pos_ < outer_tuples_.size() && inner_pos_ == inner_rids_[batch_pos_].size()) {
+      batch_pos_++;
+      inner_pos_ = 0;
     }
-  } while (!Probe(&left_tuple, &right_raw_tuple) ||
-           (plan_->Predicate() != nullptr &&
-            !plan_->Predicate()
-                 ->EvaluateJoin(&left_tuple, plan_->OuterTableSchema(), &right_raw_tuple, &(inner_table_info_->schema_))
-                 .GetAs<bool>()));
+    if (batch_pos_ == outer_tuples_.size()) {
+      if (!ProbeBatch()) {
+        return false;
+      }
+      continue;
+    }
+    if (inner_table_info_->table_->GetTuple(inner_rids_[batch_pos_][inner_pos_++], &right_raw_tuple,
+                                            exec_ctx_->GetTransaction()) &&
+        (plan_->Predicate() == nullptr ||
+         plan_->Predicate()
+             ->EvaluateJoin(&outer_tuples_[batch_pos_], plan_->OuterTableSchema(), &right_raw_tuple,
+                            &(inner_table_info_->schema_))
+             .GetAs<bool>())) {
+      break;
+    }
+  }
+  const Tuple &left_tuple = outer_tuples_[batch_pos_];
   // lock on to-read left and right rid
   // ...
   // ...
@@ -65,20 +83,29 @@ bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
   return true;
 }
 
-// 利用innerTable的索引查找符合 JOIN 条件的 right_tuple 存入right_raw_tuple
-bool NestIndexJoinExecutor::Probe(Tuple *left_tuple, Tuple *right_raw_tuple) {
-  Value key_value = plan_->Predicate()->GetChildAt(0)->EvaluateJoin(left_tuple, plan_->OuterTableSchema(),
-                                                                    right_raw_tuple, &(inner_table_info_->schema_));
-  Tuple probe_key = Tuple{{key_value}, inner_index_info_->index_->GetKeySchema()};
+// 从子执行器取出下一批左元组, 用innerTable的索引一次性查找所有左元组对应的 right_tuple 的RID
+// 批量查找按键排序后只遍历一次B+树, 相邻的键共用内部节点和叶子节点
+bool NestIndexJoinExecutor::ProbeBatch() {
+  outer_tuples_.clear();
+  batch_pos_ = 0;
+  inner_pos_ = 0;
 
-  std::vector<RID> result_set;
-  GetBPlusTreeIndex()->ScanKey(probe_key, &result_set, exec_ctx_->GetTransaction());
-
-  if (result_set.empty()) {
+  std::vector<Tuple> probe_keys;
+  Tuple left_tuple;
+  RID left_rid;
+  Tuple right_raw_tuple;
+  while (outer_tuples_.size() < PROBE_BATCH_SIZE && child_executor_->Next(&left_tuple, &left_rid)) {
+    Value key_value = plan_->Predicate()->GetChildAt(0)->EvaluateJoin(&left_tuple, plan_->OuterTableSchema(),
+                                                                      &right_raw_tuple, &(inner_table_info_->schema_));
+    probe_keys.push_back(Tuple{{key_value}, inner_index_info_->index_->GetKeySchema()});
+    outer_tuples_.push_back(left_tuple);
+  }
+  if (outer_tuples_.empty()) {
     return false;
   }
 
-  return inner_table_info_->table_->GetTuple(result_set[0], right_raw_tuple, exec_ctx_->GetTransaction());
+  inner_index_info_->index_->ScanKeys(probe_keys, &inner_rids_, exec_ctx_->GetTransaction());
+  return true;
 }
 
 }  // namespace bustub
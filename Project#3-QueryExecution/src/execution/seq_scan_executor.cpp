@@ -14,6 +14,9 @@
 #include <algorithm>
 #include <vector>
 
+#include "common/exception.h"
+#include "storage/page/table_page.h"
+
 namespace bustub {
 
 // lab3 task2 modify
@@ -24,22 +27,55 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
 }
 // lab3 task2 modify
 void SeqScanExecutor::Init() {
-  table_iter = std::make_unique<TableIterator>(table_info_->table_->Begin(exec_ctx_->GetTransaction()));
+  // 扫描只在一个小的frame环里换页,环大小不超过buffer pool的1/4
+  size_t ring_size = std::min(MAX_SCAN_RING_SIZE, exec_ctx_->GetBufferPoolManager()->GetPoolSize() / 4);
+  strategy_ = std::make_unique<BufferAccessStrategy>(ring_size);
+  next_page_id_ = table_info_->table_->GetFirstPageId();
+  page_tuples_.clear();
+  tuple_idx_ = 0;
+}
+
+void SeqScanExecutor::LoadNextPage() {
+  page_tuples_.clear();
+  tuple_idx_ = 0;
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  auto *page = reinterpret_cast<TablePage *>(bpm->FetchPage(next_page_id_, strategy_.get()));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "SeqScan: all pages are pinned");
+  }
+  page_id_t page_id = next_page_id_;
+  page->RLatch();
+  RID rid;
+  bool found = page->GetFirstTupleRid(&rid);
+  while (found) {
+    Tuple raw_tuple;
+    page->GetTuple(rid, &raw_tuple, exec_ctx_->GetTransaction(), exec_ctx_->GetLockManager());
+    page_tuples_.push_back(std::move(raw_tuple));
+    found = page->GetNextTupleRid(rid, &rid);
+  }
+  next_page_id_ = page->GetNextPageId();
+  page->RUnlatch();
+  bpm->UnpinPage(page_id, false);
+
+  // 预读下一页:在处理本页tuple的同时由I/O线程把下一页读进环里
+  if (next_page_id_ != INVALID_PAGE_ID) {
+    bpm->Prefetch({next_page_id_}, strategy_.get());
+  }
 }
 // lab3 task2 modify
 bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
   // fetch raw tuple from table
   Tuple raw_tuple;
 
-  // 利用迭代器顺序扫描table,直到SeqScanExecutor::table_iter指向遇到的第一个满足谓词条件的tuple
+  // 按页顺序扫描table,每页的tuple一次性拷出后立即unpin,直到遇到第一个满足谓词条件的tuple
   do {
-    if (*table_iter == table_info_->table_->End()) {
-      return false;
+    while (tuple_idx_ == page_tuples_.size()) {
+      if (next_page_id_ == INVALID_PAGE_ID) {
+        return false;
+      }
+      LoadNextPage();
     }
-    // TableIterator重载了运算符*,获取TableIterator.tuple_,即迭代器指向的table.tuple
-    raw_tuple = *(*table_iter);
-
-    ++(*table_iter);
+    raw_tuple = page_tuples_[tuple_idx_++];
   } while (plan_->GetPredicate() != nullptr &&
            !plan_->GetPredicate()->Evaluate(&raw_tuple, &(table_info_->schema_)).GetAs<bool>());
   // GetPredicate() 获取测试元组的谓词(判断是否存在满足某种条件的记录，存在返回TRUE、不存在返回FALSE),SQL eg:
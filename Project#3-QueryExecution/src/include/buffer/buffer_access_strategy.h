@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy confines the pages one access pattern brings into the buffer pool to a small private ring
+ * of frames.
+ *
+ * A sequential scan passes its strategy to BufferPoolManager::FetchPage. Pages that are already resident are
+ * fetched as usual, but a miss reuses the ring frame the scan filled ring-size misses ago, as long as that frame
+ * still holds the page and nobody has it pinned. Only while the ring is filling up, or when one of its frames was
+ * taken over, does the scan take a frame from the free list or the replacer. A full table scan therefore occupies
+ * at most ring-size frames and cannot push the working set of other queries out of the pool.
+ *
+ * A strategy is used by one executor at a time and is not thread-safe.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param ring_size the number of frames the access pattern may occupy, at least 1
+   */
+  explicit BufferAccessStrategy(size_t ring_size) : ring_(ring_size == 0 ? 1 : ring_size) {}
+
+  /** @return the number of frames in the ring */
+  size_t GetRingSize() const { return ring_.size(); }
+
+ private:
+  /** A ring frame and the page the strategy read into it. */
+  struct RingSlot {
+    frame_id_t frame_id_{-1};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** The ring of frames. */
+  std::vector<RingSlot> ring_;
+  /** The slot the next miss reuses. */
+  size_t current_{0};
+};
+
+}  // namespace bustub
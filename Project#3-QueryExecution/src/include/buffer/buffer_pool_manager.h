@@ -12,10 +12,17 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
@@ -52,6 +59,21 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetches a page like FetchPage, but a miss brings the page into the ring of frames of the access strategy
+   * instead of taking a frame from the whole pool.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy, nullptr for the default behavior
+   * @param callback grading callback
+   * @return the requested page, nullptr if no frame could be found
+   */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy, bufferpool_callback_fn callback = nullptr) {
+    GradingCallback(callback, CallbackType::BEFORE, page_id);
+    auto *result = FetchPageImpl(page_id, strategy);
+    GradingCallback(callback, CallbackType::AFTER, page_id);
+    return result;
+  }
+
   /** Grading function. Do not modify! */
   bool UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -97,6 +119,17 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /**
+   * Starts reading the given pages into the buffer pool in the background, so that fetching them later is a hit.
+   * The pages end up unpinned. Pages that are already in the pool, or for which no frame can be freed, are skipped.
+   * @param page_ids the pages that will be fetched soon, in the order they will be fetched
+   * @param strategy the access strategy the pages will be fetched with, nullptr for the default behavior
+   */
+  void Prefetch(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr);
+
+  /** Number of threads that read pages for Prefetch. */
+  static constexpr size_t PREFETCH_IO_THREADS = 2;
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -114,9 +147,10 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
+   * @param strategy access strategy whose ring a miss is served from, nullptr to use the whole pool
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Unpin the target page from the buffer pool.
@@ -153,6 +187,37 @@ class BufferPoolManager {
    */
   void FlushAllPagesImpl();
 
+  /**
+   * Picks a frame to hold a new page, from the free list first and from the replacer otherwise.
+   * Must be called with latch_ held.
+   * @param[out] frame_id the picked frame
+   * @return false if every frame is pinned
+   */
+  bool FindReplacementFrame(frame_id_t *frame_id);
+
+  /**
+   * Picks the frame for a page fetched through an access strategy: the current ring frame if it still holds the
+   * page the strategy read into it and is unpinned, otherwise a frame from FindReplacementFrame.
+   * Must be called with latch_ held.
+   * @param strategy the access strategy
+   * @param[out] frame_id the picked frame
+   * @return false if every frame is pinned
+   */
+  bool FindStrategyFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id);
+
+  /**
+   * Picks a frame for a page that is not in the buffer pool, writes back the page it holds if that is dirty, and
+   * maps the page to the frame, pinned once. The caller reads the page in. Must be called with latch_ held.
+   * @param page_id the page that is going to be read into the frame
+   * @param strategy the access strategy, nullptr to use the whole pool
+   * @param[out] frame_id the picked frame
+   * @return false if every frame is pinned
+   */
+  bool ClaimFrame(page_id_t page_id, BufferAccessStrategy *strategy, frame_id_t *frame_id);
+
+  /** Body of the prefetch I/O threads. */
+  void PrefetchWorkerLoop();
+
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
   /** Array of buffer pool pages. */
@@ -174,7 +239,19 @@ class BufferPoolManager {
    * latch protects:
    * - page_table_
    * - free_list_
+   * - prefetching_pages_
    */
   std::mutex latch_;
+  /** Pages whose prefetch read is still in flight. Their frames are pinned by the prefetch until it finished. */
+  std::unordered_set<page_id_t> prefetching_pages_;
+  /** Signalled whenever a prefetch read finished. */
+  std::condition_variable io_cv_;
+  /** Reads handed to the prefetch I/O threads, as <page, frame the page was mapped to>. */
+  std::deque<std::pair<page_id_t, frame_id_t>> prefetch_queue_;
+  /** Protects prefetch_queue_ and prefetch_shutdown_. */
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_cv_;
+  bool prefetch_shutdown_ = false;
+  std::vector<std::thread> prefetch_workers_;
 };
 }  // namespace bustub
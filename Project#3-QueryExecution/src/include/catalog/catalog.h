@@ -11,7 +11,10 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "storage/index/art_index.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/extendible_hash_table_index.h"
+#include "storage/index/external_sort.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
 
@@ -24,6 +27,12 @@ using table_oid_t = uint32_t;
 using column_oid_t = uint32_t;
 using index_oid_t = uint32_t;
 
+/**
+ * The data structure of an index. A B+ tree index lives in the buffer pool, an ART index in memory. An extendible
+ * hash index lives in the buffer pool too and only answers equality lookups, not index scans.
+ */
+enum class IndexType { BPlusTreeIndex, ArtIndex, ExtendibleHashTableIndex };
+
 /**
  * Metadata about a table.
  */
@@ -140,17 +149,28 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param index_type the data structure of the index, an ART index ignores the key template arguments
    * @return a pointer to the metadata of the new table
    * lab3 实现
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
+                         size_t keysize, IndexType index_type = IndexType::BPlusTreeIndex) {
     std::unique_ptr<IndexMetadata> index_meta_data =
         std::make_unique<IndexMetadata>(std::string(index_name), std::string(table_name), &schema, key_attrs);
 
-    std::unique_ptr<Index> index = std::make_unique<BPLUSTREE_INDEX_TYPE>(index_meta_data.release(), bpm_);
+    BPLUSTREE_INDEX_TYPE *b_plus_tree_index = nullptr;
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::ArtIndex) {
+      index = std::make_unique<ArtIndex>(index_meta_data.release());
+    } else if (index_type == IndexType::ExtendibleHashTableIndex) {
+      index = std::make_unique<ExtendibleHashTableIndex<KeyType, ValueType, KeyComparator>>(index_meta_data.release(),
+                                                                                            bpm_);
+    } else {
+      b_plus_tree_index = new BPLUSTREE_INDEX_TYPE(index_meta_data.release(), bpm_);
+      index.reset(b_plus_tree_index);
+    }
 
     std::unique_ptr<IndexInfo> index_info = std::make_unique<IndexInfo>(
         key_schema, std::string(index_name), std::move(index), next_index_oid_, std::string(table_name), keysize);
@@ -164,13 +184,26 @@ class Catalog {
     index_names_[result->table_name_].emplace(result->name_, result->index_oid_);
     next_index_oid_++;
 
-    // 填充表的现有数据
     TableMetadata *table_meta_data = GetTable(result->table_name_);
     TableHeap *table_heap = table_meta_data->table_.get();
+    // ART 和哈希索引没有批量构建, 逐条插入即可
+    if (b_plus_tree_index == nullptr) {
+      for (TableIterator it = table_heap->Begin(txn); it != table_heap->End(); it++) {
+        result->index_->InsertEntry(it->KeyFromTuple(schema, result->key_schema_, result->index_->GetKeyAttrs()),
+                                    it->GetRid(), txn);
+      }
+      return result;
+    }
+
+    // 填充表的现有数据: 先外部排序, 再自底向上批量构建B+树, 而不是逐条插入
+    ExternalSort<KeyType, ValueType, KeyComparator> sorter(KeyComparator(result->index_->GetKeySchema()));
     for (TableIterator it = table_heap->Begin(txn); it != table_heap->End(); it++) {
-      result->index_->InsertEntry(it->KeyFromTuple(schema, result->key_schema_, result->index_->GetKeyAttrs()),
-                                  it->GetRid(), txn);
+      KeyType index_key;
+      b_plus_tree_index->SetIndexKey(&index_key,
+                                     it->KeyFromTuple(schema, result->key_schema_, result->index_->GetKeyAttrs()));
+      sorter.Add(index_key, it->GetRid());
     }
+    b_plus_tree_index->BulkLoad([&sorter](KeyType *key, ValueType *value) { return sorter.Next(key, value); });
 
     return result;
   }
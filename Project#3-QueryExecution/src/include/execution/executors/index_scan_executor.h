@@ -13,12 +13,14 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/art_index.h"
 #include "storage/index/index_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -32,6 +34,8 @@ class IndexScanExecutor : public AbstractExecutor {
   using KeyType = GenericKey<8>;
   using ValueType = RID;
   using KeyComparator = GenericComparator<8>;
+  using KeyBound = IndexKeyBound<KeyType>;
+  using TupleBound = IndexKeyBound<Tuple>;
 
  public:
   /**
@@ -57,6 +61,15 @@ class IndexScanExecutor : public AbstractExecutor {
   const IndexInfo *index_info_;
 
   std::unique_ptr<INDEXITERATOR_TYPE> index_iter{nullptr};
+  /** ART 索引一次扫描出范围内的所有 RID, 按键的顺序 **/
+  std::vector<RID> rids_;
+  size_t rid_pos_ = 0;
+
+  /** 由谓词 (索引列 比较 常量) 推导出扫描的上下界, 推导不出的界为空 **/
+  void DeriveKeyBounds(std::optional<TupleBound> *lower, std::optional<TupleBound> *upper);
+
+  /** 取出下一个 RID, 扫描结束时返回 false **/
+  bool NextRid(RID *rid);
 
   BPlusTreeIndex<KeyType, ValueType, KeyComparator> *GetBPlusTreeIndex() {
     return dynamic_cast<BPlusTreeIndex<KeyType, ValueType, KeyComparator> *>(index_info_->index_.get());
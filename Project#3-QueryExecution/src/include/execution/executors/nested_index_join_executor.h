@@ -32,10 +32,6 @@ namespace bustub {
  * IndexJoinExecutor executes index join operations.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
-  using KeyType = GenericKey<8>;
-  using ValueType = RID;
-  using KeyComparator = GenericComparator<8>;
-
  public:
   /**
    * Creates a new nested index join executor.
@@ -65,10 +61,15 @@ class NestIndexJoinExecutor : public AbstractExecutor {
 
   std::unique_ptr<AbstractExecutor> child_executor_;
 
-  BPlusTreeIndex<KeyType, ValueType, KeyComparator> *GetBPlusTreeIndex() {
-    return dynamic_cast<BPlusTreeIndex<KeyType, ValueType, KeyComparator> *>(inner_index_info_->index_.get());
-  }
+  /** Outer tuples probed together in one batched index lookup. */
+  static constexpr size_t PROBE_BATCH_SIZE = 128;
+  /** The current batch of outer tuples, and the rids of the inner tuples matching each. */
+  std::vector<Tuple> outer_tuples_;
+  std::vector<std::vector<RID>> inner_rids_;
+  /** The next outer tuple of the batch to join, and the next of its matching inner rids. */
+  size_t batch_pos_ = 0;
+  size_t inner_pos_ = 0;
 
-  bool Probe(Tuple *left_tuple, Tuple *right_raw_tuple);
+  bool ProbeBatch();
 };
 }  // namespace bustub
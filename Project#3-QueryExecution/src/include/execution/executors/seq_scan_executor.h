@@ -15,10 +15,10 @@
 #include <memory>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
-#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -42,12 +42,23 @@ class SeqScanExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
 
  private:
+  /** Copy every tuple of the table page `next_page_id_` into `page_tuples_` and advance to the next page. */
+  void LoadNextPage();
+
+  /** Upper bound on the ring of frames a single scan is allowed to recycle. */
+  static constexpr size_t MAX_SCAN_RING_SIZE = 16;
+
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
   // lab3 task2 add
   /** 标识了应扫描的表的元数据 **/
   const TableMetadata *table_info_;
-  /** 表迭代器,TableIterator支持对表堆进行顺序扫描 **/
-  std::unique_ptr<TableIterator> table_iter{nullptr};
+  /** 扫描专用的frame环,避免一次全表扫描把buffer pool中的热点页全部换出 **/
+  std::unique_ptr<BufferAccessStrategy> strategy_{nullptr};
+  /** 下一个要读取的table page **/
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  /** 当前table page上的全部tuple,读完即可unpin该页 **/
+  std::vector<Tuple> page_tuples_;
+  size_t tuple_idx_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.h
+//
+// Identification: src/include/storage/index/art_index.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <vector>
+
+#include "common/rid.h"
+#include "storage/index/index.h"
+#include "storage/index/index_iterator.h"
+
+namespace bustub {
+
+enum class ArtNodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+/** Inner nodes store up to this many bytes of their compressed path, longer paths are read from a leaf below. */
+static constexpr uint32_t ART_MAX_PREFIX_LENGTH = 8;
+
+/**
+ * The header every node of an adaptive radix tree starts with.
+ *
+ * The version of an inner node is an optimistic lock: bit 0 marks the node obsolete, bit 1 write locked, and the
+ * rest counts the writes. Readers take no lock, they read the version before and after reading the node and restart
+ * if it changed. Leaves are immutable once they are linked into the tree, so their version is unused.
+ */
+struct ArtNode {
+  explicit ArtNode(ArtNodeType type) : type_(type) {}
+
+  std::atomic<uint64_t> version_{0};
+  const ArtNodeType type_;
+  uint16_t num_children_{0};
+  // the length of the compressed path above the children, in bytes of the key
+  uint32_t prefix_length_{0};
+  uint8_t prefix_[ART_MAX_PREFIX_LENGTH]{};
+};
+
+/**
+ * ArtIndex is an in-memory index on an adaptive radix tree, for indexes small enough to keep out of the buffer pool.
+ *
+ * The key tuple is turned into a byte string by NormalizeKey, in full, so that the bytes of keys order like the
+ * key tuples and no key is a prefix of another. The tree branches on one byte of the key per level, with inner nodes
+ * of 4, 16, 48 and 256 children that grow and shrink with the number of children, and a path of bytes shared by all
+ * keys below a node compressed into the node. A leaf holds a key and the rids of all entries with that key.
+ *
+ * Lookups and scans do not write to shared memory, writers lock the one or two nodes they change and readers
+ * validate the versions of the nodes they read (optimistic lock coupling). Nodes are replaced rather than changed
+ * when they grow, shrink, or are leaves, and the replaced nodes are freed once no operation that started before
+ * they were unlinked is running (epoch based reclamation).
+ */
+class ArtIndex : public Index {
+ public:
+  using KeyBound = IndexKeyBound<Tuple>;
+
+  explicit ArtIndex(IndexMetadata *metadata);
+
+  ~ArtIndex() override;
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Scans the keys within lower and upper in key order, appending the rids of each key to result.
+   * @return the number of keys scanned
+   */
+  size_t ScanRange(const std::optional<KeyBound> &lower, const std::optional<KeyBound> &upper,
+                   std::vector<RID> *result);
+
+ private:
+  struct Leaf;
+  struct Node4;
+  struct Node16;
+  struct Node48;
+  struct Node256;
+  class Epoch;
+  class EpochGuard;
+
+  // the normalized bytes of a key tuple
+  std::vector<uint8_t> EncodeKey(const Tuple &key) const;
+
+  bool TryInsert(const std::vector<uint8_t> &key, RID rid);
+  bool TryRemove(const std::vector<uint8_t> &key, RID rid);
+  bool TryLookup(const std::vector<uint8_t> &key, std::vector<RID> *result);
+  // appends the rids of the keys within the bounds below node, false if a node changed during the scan
+  bool ScanNode(ArtNode *node, uint64_t version, uint32_t depth, const std::vector<uint8_t> *lower,
+                bool lower_inclusive, const std::vector<uint8_t> *upper, bool upper_inclusive,
+                std::vector<RID> *result, size_t *num_keys);
+
+  // the length of the prefix of node that matches key from depth, reading the bytes past the stored ones from a leaf
+  uint32_t MatchPrefix(ArtNode *node, const std::vector<uint8_t> &key, uint32_t depth) const;
+  // the byte of the prefix of node at index, with node's path starting at depth
+  uint8_t PrefixByte(ArtNode *node, uint32_t depth, uint32_t index) const;
+  // remove the first length bytes of the prefix of node, and the branch byte after them
+  void CutPrefix(ArtNode *node, uint32_t depth, uint32_t length) const;
+
+  static ArtNode *FindChild(ArtNode *node, uint8_t byte);
+  static void AddChild(ArtNode *node, uint8_t byte, ArtNode *child);
+  static void ChangeChild(ArtNode *node, uint8_t byte, ArtNode *child);
+  static void RemoveChild(ArtNode *node, uint8_t byte);
+  // the children of node in key order
+  static void GetChildren(ArtNode *node, std::vector<std::pair<uint8_t, ArtNode *>> *children);
+  static bool IsFull(ArtNode *node);
+  static bool IsUnderfull(ArtNode *node);
+  // a copy of node with room for more, or fewer, children
+  static ArtNode *Grow(ArtNode *node);
+  static ArtNode *Shrink(ArtNode *node);
+  static void CopyPrefix(const ArtNode *from, ArtNode *to);
+  static Leaf *MinimumLeaf(ArtNode *node);
+  static void FreeNode(ArtNode *node);
+  static void FreeTree(ArtNode *node);
+
+  // optimistic lock coupling, the restart is reported as false
+  static bool ReadLock(ArtNode *node, uint64_t *version);
+  static bool Validate(ArtNode *node, uint64_t version);
+  static bool UpgradeToWriteLock(ArtNode *node, uint64_t version);
+  static void WriteUnlock(ArtNode *node);
+  static void WriteUnlockObsolete(ArtNode *node);
+
+  // the root never changes, a Node256 without prefix
+  ArtNode *root_;
+  Epoch *epoch_;
+};
+
+}  // namespace bustub
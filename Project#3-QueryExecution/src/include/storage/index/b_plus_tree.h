@@ -10,7 +10,10 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <mutex>  // NOLINT
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,6 +22,7 @@
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 
 namespace bustub {
 
@@ -26,24 +30,46 @@ namespace bustub {
 
 enum class Operation { SEARCH, INSERT, DELETE };
 
+/**
+ * How inserts and deletes latch the pages on their way down.
+ * PESSIMISTIC: write latch from the root, ancestors are released once a child is safe (will not split or merge).
+ * OPTIMISTIC: read latch down to the leaf and write latch only the leaf. If the leaf is not safe the operation
+ * releases it and starts over pessimistically.
+ * BLINK: Lehman-Yao B-link tree. Every page has a high key and a right link, readers and writers hold one latch at a
+ * time on the way down and move right past pages that were split under them. A split is posted to the parent after
+ * the split page is released. Deletes never merge or redistribute, emptied pages stay in the tree.
+ */
+enum class LatchMode { PESSIMISTIC, OPTIMISTIC, BLINK };
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, unless the tree is created with unique_keys = false. Then the values of a key with more
+ *     than one value are kept in a posting list outside the leaf, the key still has a single pair in its leaf
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Pages store the first key_size bytes of each key. Trees over keys whose bytes past that are always zero, keys
+ *     shorter than KeyType, may pass a smaller key_size and max sizes of TRUNCATED_LEAF_PAGE_SIZE(key_size) and
+ *     TRUNCATED_INTERNAL_PAGE_SIZE(key_size) to fit more pairs in a page
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>;
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using PostingPage = BPlusTreePostingPage<ValueType>;
+  using KeyBound = IndexKeyBound<KeyType>;
 
  public:
+  /** Share of a page bulk loading fills, the rest is left for later inserts. */
+  static constexpr double DEFAULT_FILL_FACTOR = 0.9;
+
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     LatchMode latch_mode = LatchMode::OPTIMISTIC, bool unique_keys = true,
+                     int key_size = sizeof(KeyType));
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -51,15 +77,27 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its value from this B+ tree, all of its values if the keys are not unique.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a single key-value pair from this B+ tree.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  // return the values associated with a batch of keys, looked up in key order in one pass down the tree
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                 Transaction *transaction = nullptr);
+
+  // Build an empty B+ tree bottom up from key-value pairs in key order.
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = DEFAULT_FILL_FACTOR);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
+  INDEXITERATOR_TYPE Begin(const std::optional<KeyBound> &lower, const std::optional<KeyBound> &upper,
+                           bool reverse = false);
   INDEXITERATOR_TYPE end();
 
   void Print(BufferPoolManager *bpm) {
@@ -81,6 +119,9 @@ class BPlusTree {
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
   // expose for test purpose
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
+  // used by reverse iterators to find their way back when the leaf to their left changed under them
+  Page *FindLeafPageBefore(const KeyBound *bound);
+  uint64_t GetLeafShiftsRight() const { return leaf_shifts_right_.load(); }
 
  private:
   void StartNewTree(const KeyType &key, const ValueType &value);
@@ -106,6 +147,25 @@ class BPlusTree {
 
   bool AdjustRoot(BPlusTreePage *node, bool is_root_page_id_latched = false);
 
+  void RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction);
+
+  /** What removing a pair does to the leaf holding its key. */
+  enum class LeafRemoval { NONE, POSTING_LIST_VALUE, PAIR };
+
+  LeafRemoval CheckLeafRemoval(LeafPage *leaf, const KeyType &key, const ValueType *value) const;
+
+  void RemoveFromLeaf(LeafPage *leaf, const KeyType &key, const ValueType *value, LeafRemoval removal);
+
+  void PostingListInsert(LeafPage *leaf, const KeyType &key, const ValueType &value);
+
+  void PostingListRemove(LeafPage *leaf, int index, const ValueType &value);
+
+  void PostingListCollect(const ValueType &reference, std::vector<ValueType> *result) const;
+
+  void PostingListFree(const ValueType &reference);
+
+  void LookupValues(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result) const;
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -115,20 +175,70 @@ class BPlusTree {
 
   void ClearTransactionPageSetAndUnpinEach(Transaction *transaction) const;
 
-  void ClearTransactionPageSet(Transaction *transaction) const;
-
   std::pair<Page *, bool> FindLeafPageByOperation(const KeyType &key, Operation operation = Operation::SEARCH,
                                                   Transaction *transaction = nullptr, bool leftMost = false,
                                                   bool rightMost = false);
 
+  Page *FindLeafPageOptimistically(const KeyType &key);
+
+  Page *FetchRootPageForRead();
+
+  bool InsertIntoLeafBLink(const KeyType &key, const ValueType &value);
+
+  void InsertIntoParentBLink(Page *page, const KeyType &key, BPlusTreePage *new_node, std::vector<page_id_t> *path);
+
+  template <typename N>
+  void LinkSplitBLink(N *node, N *new_node);
+
+  void LinkNextLeafBack(LeafPage *leaf, bool parent_latched);
+
+  /** A page on the path of a batched lookup, and the key its subtree ends before, unless it is the rightmost. */
+  struct BatchLevel {
+    Page *page_;
+    bool bounded_;
+    KeyType upper_key_;
+  };
+
+  BatchLevel MoveRightBatchLevel(Page *page, const KeyType &key);
+
+  void ReleaseBatchLevel(BatchLevel *level);
+
+  /** A level of a tree being bulk loaded: the page being filled, and the last finished page before it. */
+  struct BulkLoadLevel {
+    Page *page_ = nullptr;
+    Page *prev_page_ = nullptr;
+  };
+
+  void BulkLoadAppend(std::vector<BulkLoadLevel> *levels, size_t level, Page *child_page, int fill_size);
+
+  bool BulkLoadBalance(Page *prev_page, Page *page);
+
+  void BulkLoadAbort(std::vector<BulkLoadLevel> *levels);
+
+  Page *FindLeafPageBLink(const KeyType &key, Operation operation, std::vector<page_id_t> *path = nullptr);
+
+  template <typename N>
+  Page *MoveRightBLink(Page *page, const KeyType &key, bool exclusive);
+
+  template <typename N>
+  Page *MoveRightBeforeBLink(Page *page, const KeyBound *bound);
+
   // member variable
   std::string index_name_;
+  // taken by the writers that may replace the root, readers go by root_page_id_ alone
   std::mutex root_page_id_latch;
-  page_id_t root_page_id_;
+  // only written with root_page_id_latch held, and the write latch on the old root if there is one
+  std::atomic<page_id_t> root_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  LatchMode latch_mode_;
+  bool unique_keys_;
+  int key_size_;
+  // the number of times pairs were moved from a leaf into its right neighbor, which reverse iterators cannot see on
+  // the leaf they step left to. Only changed with both leaves write latched
+  std::atomic<uint64_t> leaf_shifts_right_{0};
 };
 
 }  // namespace bustub
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -25,7 +27,14 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager);
+  /**
+   * Keys are not unique by default, every row gets an entry and ScanKey returns the rids of all rows with the key.
+   * With truncate_keys the pages store keys of inlined columns in the length of the key schema instead of KeyType,
+   * the rest of a key is zero. Keys far shorter than KeyType then fit many more pairs in a page. A NormalizedKey is
+   * stored in the length of its encoding.
+   */
+  BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+                 LatchMode latch_mode = LatchMode::OPTIMISTIC, bool unique_keys = false, bool truncate_keys = false);
 
   void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
@@ -33,12 +42,26 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                Transaction *transaction) override;
+
+  /** Builds the empty index from pairs in key order, see BPlusTree::BulkLoad. */
+  bool BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next,
+                double fill_factor = BPlusTree<KeyType, ValueType, KeyComparator>::DEFAULT_FILL_FACTOR);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
+  /** Iterates over the keys within lower and upper, from upper down if reverse, until isEnd(). */
+  INDEXITERATOR_TYPE GetBeginIterator(const std::optional<IndexKeyBound<KeyType>> &lower,
+                                      const std::optional<IndexKeyBound<KeyType>> &upper, bool reverse = false);
+
   INDEXITERATOR_TYPE GetEndIterator();
 
+  /** Sets index_key from a tuple of the key schema, NormalizedKey encodes it with the key schema. */
+  void SetIndexKey(KeyType *index_key, const Tuple &key) const;
+
  protected:
   // comparator for key
   KeyComparator comparator_;
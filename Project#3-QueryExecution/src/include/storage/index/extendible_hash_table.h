@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/index/extendible_hash_table.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/rwlatch.h"
+#include "concurrency/transaction.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+
+namespace bustub {
+
+#define HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Extendible hash table on pages of the buffer pool: a directory page maps the low bits of the hash of a key to its
+ * bucket page. A full bucket splits in two by one more bit of the hash, doubling the directory if the bucket was
+ * held by a single entry. An emptied bucket merges with its split image, and the directory halves once no bucket
+ * needs all of its bits. A bucket whose pairs all hash alike in the bits the directory can use overflows into a chain
+ * of bucket pages instead, which is what becomes of the many values of a single key.
+ *
+ * Lookups, and inserts and removes that stay within a bucket, hold table_latch_ in read mode and latch the first
+ * page of the bucket. Splits, merges and overflows hold table_latch_ in write mode, which excludes every other
+ * operation, so they latch no page.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashTable {
+  using BucketPage = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+
+ public:
+  ExtendibleHashTable(std::string name, BufferPoolManager *buffer_pool_manager);
+
+  // Insert a key-value pair, false if the pair is in the table already.
+  bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove a key-value pair, false if the pair is not in the table.
+  bool Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
+
+  uint32_t GetGlobalDepth();
+
+  // Checks that the directory and the buckets agree: the entries of a bucket, its local depth and the hashes of its
+  // keys. For tests, without concurrent operations.
+  bool VerifyIntegrity();
+
+ private:
+  uint32_t Hash(const KeyType &key) const;
+  HashTableDirectoryPage *FetchDirectoryPage();
+  BucketPage *FetchBucketPage(page_id_t bucket_page_id);
+
+  // insert into the first page of the chain of first_page with room, false if all are full
+  bool InsertIntoChain(BucketPage *first_page, const KeyType &key, const ValueType &value, bool *exists);
+  // insert after all pages of the chain turned out full, splitting the bucket or growing its chain
+  bool SplitInsert(const KeyType &key, const ValueType &value);
+  // whether splitting could separate a pair of the chain of first_page from a key of hash
+  bool HashesDiffer(BucketPage *first_page, uint32_t hash);
+  // move the pairs of the chain of first_page to items, leaving first_page alone and empty
+  void TakeChain(BucketPage *first_page, std::vector<MappingType> *items);
+  // insert at the end of the chain of first_page, adding a page if the last one is full
+  void AddToChain(BucketPage *first_page, const KeyType &key, const ValueType &value);
+  // remove from the chain of first_page, dropping overflow pages it empties
+  bool RemoveFromChain(BucketPage *first_page, const KeyType &key, const ValueType &value);
+  // merge the bucket of key with its split image for as long as the bucket is empty
+  void Merge(const KeyType &key);
+
+  std::string index_name_;
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  ReaderWriterLatch table_latch_;
+};
+
+}  // namespace bustub
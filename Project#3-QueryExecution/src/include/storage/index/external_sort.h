@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORT_TYPE ExternalSort<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSort sorts key & value pairs that need not fit in memory, to feed BPlusTree::BulkLoad.
+ *
+ * Pairs are added in any order and gathered into runs of run_size pairs. A full run is sorted and written to a
+ * temporary file in one sequential write. Reading the output merges the runs, reading each run sequentially in blocks
+ * of BLOCK_SIZE pairs. If everything fits into one run, nothing goes to disk.
+ *
+ * The sort is stable: pairs with equal keys come out in the order they were added.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSort {
+ public:
+  /** Pairs per run, 1M pairs is 16MB for 8 byte keys. */
+  static constexpr size_t DEFAULT_RUN_SIZE = 1 << 20;
+  /** Pairs read from a run at a time while merging. */
+  static constexpr size_t BLOCK_SIZE = 1 << 12;
+
+  explicit ExternalSort(const KeyComparator &comparator, size_t run_size = DEFAULT_RUN_SIZE);
+
+  ~ExternalSort();
+
+  DISALLOW_COPY(ExternalSort);
+
+  /** Adds a pair, must not be called once Next has been. */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /**
+   * Returns the next pair in key order.
+   * @return false once all pairs have been returned
+   */
+  bool Next(KeyType *key, ValueType *value);
+
+  /** @return the number of runs written to disk */
+  size_t GetRunCount() const { return runs_.size(); }
+
+ private:
+  /** A sorted run on disk, and the block of it that is being merged. */
+  struct Run {
+    FILE *file_;
+    std::vector<MappingType> block_;
+    size_t pos_;
+  };
+
+  /** Sorts the buffered pairs and writes them out as a run. */
+  void SpillRun();
+
+  /** Sets up the merge of the runs on the first call of Next. */
+  void StartMerge();
+
+  /** Refills the block of a run, @return false if the run is used up */
+  bool ReadBlock(Run *run);
+
+  /** @return true if the head of run a goes after the head of run b, the heap is a max heap */
+  bool RunAfter(size_t a, size_t b) const;
+
+  KeyComparator comparator_;
+  size_t run_size_;
+  std::vector<MappingType> buffer_;
+  std::vector<Run> runs_;
+  bool merging_ = false;
+  /** Position in buffer_ when there is a single run that was never spilled. */
+  size_t buffer_pos_ = 0;
+  /** Heap of the runs that are not used up, by their head pair. */
+  std::vector<size_t> heap_;
+};
+
+}  // namespace bustub
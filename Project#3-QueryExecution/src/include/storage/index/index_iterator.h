@@ -14,20 +14,49 @@
  */
 #pragma once
 #include "buffer/buffer_pool_manager.h"
+#include <optional>
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/b_plus_tree_posting_page.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * One end of a range scan, the range holds key_ itself if inclusive_.
+ */
+template <typename KeyType>
+struct IndexKeyBound {
+  KeyType key_;
+  bool inclusive_;
+};
+
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+  using PostingPage = BPlusTreePostingPage<ValueType>;
+  using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
+  using KeyBound = IndexKeyBound<KeyType>;
 
  public:
   // you may define your own constructor based on your member variables
   IndexIterator(BufferPoolManager *bpm, Page *page, int idx = 0);
+  /**
+   * An iterator over the keys within lower and upper, see BPlusTree::Begin
+   * @param page    the read latched leaf to start from, nullptr if the tree is empty
+   * @param idx     the index to start at going forward, a reverse iterator finds the last key within upper itself
+   */
+  IndexIterator(Tree *tree, const KeyComparator *comparator, BufferPoolManager *bpm, Page *page, int idx,
+                std::optional<KeyBound> lower, std::optional<KeyBound> upper, bool reverse);
+  // the iterator holds the latch on its leaf, it is moved, never copied
+  IndexIterator(IndexIterator &&other) noexcept;
+  IndexIterator(const IndexIterator &other) = delete;
   ~IndexIterator();
 
   bool isEnd();
@@ -41,11 +70,46 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const;
 
  private:
+  /** Starts reading the next leaf in, so that moving onto it does not block on the disk. */
+  void ReadAhead();
+
+  /** Moves past the end of the current leaf onto the next item, skipping empty leaves. */
+  void SkipLeafEnd();
+
+  /** Moves onto the last item within bound, into the leaves to the left if the current leaf has none. */
+  void SeekBefore(const std::optional<KeyBound> &bound);
+
+  /** Moves onto the leaf to the left of the current one, false if it is the leftmost. */
+  bool StepLeft(const std::optional<KeyBound> &bound);
+
+  /** @return the index of the last key of the current leaf within bound, -1 if there is none */
+  int LastIndexBefore(const std::optional<KeyBound> &bound) const;
+
+  /** Ends the iteration once the current item is past the bound the iterator runs towards. */
+  void CheckBound();
+
+  /** Releases the current leaf, the iterator is then at its end. */
+  void Release();
+
+  /** Reads in the posting list of the current pair if it has one, its values are then visited one by one. */
+  void ReadPostingList();
+
   // add your own private member variables here
   BufferPoolManager *buffer_pool_manager_;
   Page *page;
   LeafPage *leaf = nullptr;
   int idx = 0;
+  // the values of the current pair if it refers to a posting list, and the one the iterator is at
+  std::vector<ValueType> posting_values_;
+  size_t posting_idx_ = 0;
+  // the pair the iterator is at, leaves may store keys truncated
+  MappingType item_;
+  // only set for range scans
+  Tree *tree_ = nullptr;
+  const KeyComparator *comparator_ = nullptr;
+  std::optional<KeyBound> lower_;
+  std::optional<KeyBound> upper_;
+  bool reverse_ = false;
 };
 
 }  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key.h
+//
+// Identification: src/include/storage/index/integer_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * IntegerKey is the key of an index over a single integer column, TINYINT to BIGINT, held as an int64_t.
+ *
+ * An index picks it over GenericKey<8> through its template arguments, BPlusTree<IntegerKey, RID, IntegerComparator>.
+ * Comparing two keys is then a single integer compare instead of deserializing a Value of each key. Leaf and internal
+ * pages of integer keys also keep their keys in one array ahead of the values, and search it with SIMD compares, see
+ * IntegerKeyLowerBound.
+ */
+class IntegerKey {
+ public:
+  /** A key tuple of one integer column is that column, 1 to 8 bytes of little endian two's complement. */
+  inline void SetFromKey(const Tuple &tuple) {
+    switch (tuple.GetLength()) {
+      case 1:
+        key_ = Read<int8_t>(tuple.GetData());
+        break;
+      case 2:
+        key_ = Read<int16_t>(tuple.GetData());
+        break;
+      case 4:
+        key_ = Read<int32_t>(tuple.GetData());
+        break;
+      default:
+        key_ = Read<int64_t>(tuple.GetData());
+        break;
+    }
+  }
+
+  // NOLINTNEXTLINE
+  inline void SetFromInteger(int64_t key) { key_ = key; }
+
+  inline int64_t ToInteger() const { return key_; }
+
+  friend std::ostream &operator<<(std::ostream &os, const IntegerKey &key) {
+    os << key.key_;
+    return os;
+  }
+
+ private:
+  template <typename IntType>
+  static int64_t Read(const char *data) {
+    IntType value;
+    std::memcpy(&value, data, sizeof(IntType));
+    return value;
+  }
+
+  int64_t key_;
+};
+
+/**
+ * IntegerComparator orders integer keys by value. The key schema is taken only to be constructed like
+ * GenericComparator.
+ */
+class IntegerComparator {
+ public:
+  explicit IntegerComparator(Schema *key_schema) {}
+
+  inline int operator()(const IntegerKey &lhs, const IntegerKey &rhs) const {
+    return lhs.ToInteger() < rhs.ToInteger() ? -1 : static_cast<int>(lhs.ToInteger() > rhs.ToInteger());
+  }
+};
+
+/**
+ * Find the first of size sorted int64_t keys at keys, which need not be aligned, that is not less than key.
+ * The range is halved down to a few cache lines of keys, which are then compared with key all at once: with AVX2 four
+ * keys per instruction, with SSE4.2 two, one at a time on CPUs without either.
+ * @return the index of that key, size if all keys are less than key
+ */
+int IntegerKeyLowerBound(const char *keys, int size, int64_t key);
+
+}  // namespace bustub
@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.h
+//
+// Identification: src/include/storage/index/normalized_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * Encode the key tuple into size bytes at data, such that memcmp orders two encodings like the key tuples order
+ * column by column. Each column is a flag byte, 0 if the column is null and 1 if not, followed by:
+ *  - integers, booleans and timestamps: big endian, with the sign bit flipped for signed types
+ *  - decimals: big endian, with the sign bit flipped for positive values and all bits flipped for negative ones
+ *  - varchars: the bytes, with each 0x00 escaped as 0x00 0xFF, ended by 0x00 0x00
+ * A null column is its flag and zeroed value bytes, nothing for a varchar. Bytes past the encoding are zeroed, an
+ * encoding longer than size is cut, so that keys equal in their first size bytes compare equal.
+ * @return the length of the whole encoding, which is more than size if it was cut
+ */
+size_t NormalizeKey(const Tuple &tuple, const Schema *key_schema, char *data, size_t size);
+
+/**
+ * The length of the encoding of a key of key_schema, which must be inlined.
+ */
+uint32_t NormalizedKeyLength(const Schema *key_schema);
+
+/**
+ * NormalizedKey is the key of an index over any columns, stored in the order-preserving encoding of NormalizeKey.
+ *
+ * Unlike GenericKey, which keeps the key tuple and is compared by deserializing a Value per column, a NormalizedKey
+ * is encoded once when it is set and compared with a single memcmp. It takes the key schema to be set, see
+ * BPlusTreeIndex. A key of a single bigint column can also be set from and read as an integer.
+ */
+template <size_t KeySize>
+class NormalizedKey {
+ public:
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
+    NormalizeKey(tuple, key_schema, data_, KeySize);
+  }
+
+  // NOLINTNEXTLINE
+  inline void SetFromInteger(int64_t key) {
+    static_assert(KeySize >= 1 + sizeof(int64_t), "a bigint column does not fit in the key");
+    std::memset(data_, 0, KeySize);
+    data_[0] = 1;
+    auto bits = static_cast<uint64_t>(key) ^ (uint64_t{1} << 63);
+    for (size_t i = 0; i < sizeof(int64_t); i++) {
+      data_[1 + i] = static_cast<char>(bits >> (8 * (sizeof(int64_t) - 1 - i)));
+    }
+  }
+
+  inline int64_t ToInteger() const {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < sizeof(int64_t); i++) {
+      bits = (bits << 8) | static_cast<uint8_t>(data_[1 + i]);
+    }
+    return static_cast<int64_t>(bits ^ (uint64_t{1} << 63));
+  }
+
+  friend std::ostream &operator<<(std::ostream &os, const NormalizedKey &key) {
+    os << key.ToInteger();
+    return os;
+  }
+
+  char data_[KeySize];
+};
+
+/**
+ * NormalizedComparator orders normalized keys by their bytes. The key schema is taken only to be constructed like
+ * GenericComparator.
+ */
+template <size_t KeySize>
+class NormalizedComparator {
+ public:
+  explicit NormalizedComparator(Schema *key_schema) {}
+
+  inline int operator()(const NormalizedKey<KeySize> &lhs, const NormalizedKey<KeySize> &rhs) const {
+    return std::memcmp(lhs.data_, rhs.data_, KeySize);
+  }
+};
+
+template <typename KeyType>
+struct IsNormalizedKey : std::false_type {};
+
+template <size_t KeySize>
+struct IsNormalizedKey<NormalizedKey<KeySize>> : std::true_type {};
+
+}  // namespace bustub
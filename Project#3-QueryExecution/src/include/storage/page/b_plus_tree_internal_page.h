@@ -11,14 +11,17 @@
 #pragma once
 
 #include <queue>
+#include <type_traits>
 
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
+#define INTERNAL_PAGE_HEADER_SIZE 28
 #define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define TRUNCATED_INTERNAL_PAGE_SIZE(key_size) \
+  ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / ((key_size) + sizeof(page_id_t)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,24 +34,41 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * In a B-link tree the pair right after the last one a full page holds, at index max size, stores the high key and
+ * the right link: HIGH_KEY+NEXT_PAGE_ID.
+ *
+ * The header is the common page header followed by KeySize (4). KEY(i) takes KeySize bytes, the leading bytes of the
+ * key. Pages of IntegerKey keep all keys ahead of all values, see b_plus_tree_leaf_page.h.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            int key_size = sizeof(KeyType));
 
+  int GetKeySize() const;
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
   int ValueIndex(const ValueType &value) const;
   ValueType ValueAt(int index) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  ValueType LookupBefore(const KeyType &key, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  int Insert(const KeyType &new_key, const ValueType &new_value, const KeyComparator &comparator);
+  int Append(const KeyType &new_key, const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
 
+  // B-link tree high key and right link
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  KeyType GetHighKey() const;
+  void SetHighKey(const KeyType &key);
+
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
@@ -58,9 +78,26 @@ class BPlusTreeInternalPage : public BPlusTreePage {
                          BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  static constexpr bool SEPARATE_KEYS = std::is_same_v<KeyType, IntegerKey>;
+  static_assert(SEPARATE_KEYS || sizeof(MappingType) == sizeof(KeyType) + sizeof(ValueType),
+                "pairs are stored without padding");
+
+  int SlotSize() const;
+  char *SlotAt(int index);
+  const char *SlotAt(int index) const;
+  char *KeyAddress(int index);
+  const char *KeyAddress(int index) const;
+  char *ValueAddress(int index);
+  const char *ValueAddress(int index) const;
+  int LowerBound(const KeyType &key, const KeyComparator &comparator) const;
+  int UpperBound(const KeyType &key, const KeyComparator &comparator) const;
+  void SetValueAt(int index, const ValueType &value);
+  void MoveItems(int from, int to, int size);
+  void CopyNFrom(BPlusTreeInternalPage *source, int start_index, int size, BufferPoolManager *buffer_pool_manager);
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
+  int key_size_;
+  // pairs of full size keys, only indexed as such if key_size_ is the size of KeyType
   MappingType array[0];
 };
 }  // namespace bustub
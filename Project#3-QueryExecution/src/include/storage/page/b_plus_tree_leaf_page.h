@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -18,39 +19,65 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 36
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define TRUNCATED_LEAF_PAGE_SIZE(key_size) ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / ((key_size) + sizeof(ValueType)))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
- * page. Only support unique key.
+ * page. Keys are unique within the page, in a tree with non-unique keys the
+ * value of a key with more than one value refers to a posting list, see
+ * b_plus_tree_posting_page.h.
  *
  * Leaf page format (keys are stored in order):
  *  ----------------------------------------------------------------------
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 36 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  -----------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4) | KeySize (4)
+ *  -----------------------------------------------------------------------------------
+ *
+ * PrevPageId links back to the leaf whose NextPageId is this leaf, for reverse scans. It is only changed with this
+ * leaf write latched.
+ *
+ * KEY(i) takes KeySize bytes, the leading bytes of the key. It is the size of KeyType unless the tree truncates its
+ * keys, then the bytes past KeySize are zero in every key and are not stored.
+ *
+ * Pages of IntegerKey keep all keys first, then all values, so that in-page searches compare the keys with SIMD:
+ *  -------------------------------------------------------------------
+ * | HEADER | KEY(1) | KEY(2) | ... | free keys | RID(1) | RID(2) | ...
+ *  -------------------------------------------------------------------
+ * The values start after room for the keys of as many pairs as fit in the page.
+ *
+ * In a B-link tree NextPageId is the right link, and the key of the pair right after the last one a full page holds,
+ * at index max size, is the high key.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            int key_size = sizeof(KeyType));
   // helper methods
+  int GetKeySize() const;
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  KeyType GetHighKey() const;
+  void SetHighKey(const KeyType &key);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
@@ -64,10 +91,28 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
+  static constexpr bool SEPARATE_KEYS = std::is_same_v<KeyType, IntegerKey>;
+  static_assert(SEPARATE_KEYS || sizeof(MappingType) == sizeof(KeyType) + sizeof(ValueType),
+                "pairs are stored without padding");
+
+  int SlotSize() const;
+  char *SlotAt(int index);
+  const char *SlotAt(int index) const;
+  char *KeyAddress(int index);
+  const char *KeyAddress(int index) const;
+  char *ValueAddress(int index);
+  const char *ValueAddress(int index) const;
+  int LowerBound(const KeyType &key, const KeyComparator &comparator) const;
+  void SetKeyAt(int index, const KeyType &key);
+  void SetItem(int index, const MappingType &item);
+  void MoveItems(int from, int to, int size);
+  void CopyNFrom(BPlusTreeLeafPage *source, int start_index, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
+  int key_size_;
+  // pairs of full size keys, only indexed as such if key_size_ is the size of KeyType
   MappingType array[0];
 };
 }  // namespace bustub
@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/b_plus_tree_posting_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define B_PLUS_TREE_POSTING_PAGE_TYPE BPlusTreePostingPage<ValueType>
+#define POSTING_PAGE_HEADER_SIZE 12
+
+/**
+ * Holds the values of a key that has more than one value in a B+ tree with non-unique keys. The leaf keeps a single
+ * pair for such a key, whose value refers to the first page of the key's posting list, see Reference. The pages of a
+ * posting list are chained by NextPageId and only ever accessed with the leaf holding the reference latched, so they
+ * are not latched themselves. All pages but the last one are full.
+ *
+ * Posting page format:
+ *  ---------------------------------------------------------------------------------
+ * | NextPageId (4) | LastPageId (4) | CurrentSize (4) | VALUE(1) | ... | VALUE(n) |
+ *  ---------------------------------------------------------------------------------
+ * LastPageId is only kept up to date in the first page.
+ */
+template <typename ValueType>
+class BPlusTreePostingPage {
+ public:
+  /** Slot number of the RIDs that refer to a posting list, heap pages never have that many slots. */
+  static constexpr uint32_t POSTING_LIST_SLOT = UINT32_MAX;
+
+  // After creating a new posting page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id);
+  // helper methods
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetLastPageId() const;
+  void SetLastPageId(page_id_t last_page_id);
+  int GetSize() const;
+  int GetMaxSize() const;
+  bool IsFull() const;
+  ValueType ValueAt(int index) const;
+  void SetValueAt(int index, const ValueType &value);
+  int ValueIndex(const ValueType &value) const;
+
+  // insert and delete methods
+  void Append(const ValueType &value);
+  ValueType RemoveLast();
+
+  /** @return the leaf value referring to the posting list starting at page_id */
+  static ValueType Reference(page_id_t page_id);
+  static bool IsReference(const ValueType &value);
+  static page_id_t ReferencedPageId(const ValueType &value);
+
+ private:
+  page_id_t next_page_id_;
+  page_id_t last_page_id_;
+  int size_;
+  ValueType array[0];
+};
+}  // namespace bustub
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+#define BUCKET_PAGE_HEADER_SIZE 8
+#define BUCKET_ARRAY_SIZE ((PAGE_SIZE - BUCKET_PAGE_HEADER_SIZE) / sizeof(MappingType))
+
+/**
+ * Stores the pairs of a bucket of an extendible hash table, in no particular order. A key may have many values, but
+ * a pair is stored once. Keys are matched by their bytes, the same bytes the table hashes, so a lookup scanning a
+ * full page does not deserialize a single value.
+ *
+ * The pairs of a bucket that cannot be split, because all of them hash alike, overflow into a chain of bucket pages
+ * linked by NextPageId. The pages of a chain are only accessed with its first page latched, so they are not latched
+ * themselves. Every page of a chain but the first is non-empty.
+ *
+ * Bucket page format:
+ *  ----------------------------------------------------------------------------------
+ * | NextPageId (4) | CurrentSize (4) | KEY(1) + VALUE(1) | ... | KEY(n) + VALUE(n) |
+ *  ----------------------------------------------------------------------------------
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class HashTableBucketPage {
+ public:
+  // After creating a new bucket page from buffer pool, must call initialize method to set default values
+  void Init();
+  // helper methods
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  int GetSize() const;
+  int GetMaxSize() const;
+  bool IsFull() const;
+  bool IsEmpty() const;
+  KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
+  const MappingType &GetItem(int index) const;
+
+  /** Appends the values of key to result, @return whether key has any value in this page */
+  bool GetValue(const KeyType &key, std::vector<ValueType> *result) const;
+  bool Contains(const KeyType &key, const ValueType &value) const;
+
+  // insert and delete methods, the page must not be full to insert
+  void Insert(const KeyType &key, const ValueType &value);
+  bool Remove(const KeyType &key, const ValueType &value);
+  /** Removes the pair at index, the last pair takes its place */
+  void RemoveAt(int index);
+
+ private:
+  static bool KeyEquals(const KeyType &lhs, const KeyType &rhs) { return memcmp(&lhs, &rhs, sizeof(KeyType)) == 0; }
+
+  page_id_t next_page_id_;
+  int size_;
+  MappingType array[0];
+};
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/include/page/hash_table_directory_page.h
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+#define DIRECTORY_MAX_DEPTH 9
+#define DIRECTORY_ARRAY_SIZE (1 << DIRECTORY_MAX_DEPTH)
+
+/**
+ * The directory of an extendible hash table. Entry i holds the bucket of the keys whose hash ends in the low
+ * GlobalDepth bits of i, and the local depth of that bucket: the number of low hash bits all keys of the bucket
+ * share. A bucket of local depth d is held by the 2^(GlobalDepth - d) entries that end in the same d bits.
+ *
+ * Directory page format:
+ *  --------------------------------------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (4) | LocalDepth(1) (1) | ... | LocalDepth(512) (1) | BucketPageId(1) (4) | ...
+ *  --------------------------------------------------------------------------------------------------
+ */
+class HashTableDirectoryPage {
+ public:
+  // After creating a new directory page from buffer pool, must call initialize method to set default values
+  void Init(page_id_t page_id);
+  page_id_t GetPageId() const;
+
+  // helper methods
+  uint32_t GetGlobalDepth() const;
+  /** @return the mask of the low GlobalDepth bits of a hash */
+  uint32_t GetGlobalDepthMask() const;
+  /** @return the number of entries in use, 2^GlobalDepth */
+  uint32_t Size() const;
+  bool CanGrow() const;
+  /** Doubles the directory, the new upper half holds the same buckets as the lower half. */
+  void IncrGlobalDepth();
+  /** @return whether every bucket is held by at least two entries, so that the directory can halve */
+  bool CanShrink() const;
+  void DecrGlobalDepth();
+
+  page_id_t GetBucketPageId(uint32_t bucket_idx) const;
+  void SetBucketPageId(uint32_t bucket_idx, page_id_t bucket_page_id);
+  uint32_t GetLocalDepth(uint32_t bucket_idx) const;
+  void SetLocalDepth(uint32_t bucket_idx, uint32_t local_depth);
+  uint32_t GetLocalDepthMask(uint32_t bucket_idx) const;
+  /** @return an entry of the bucket that the bucket at bucket_idx was split from, or split into */
+  uint32_t GetSplitImageIndex(uint32_t bucket_idx) const;
+
+ private:
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "the directory does not fit in a page");
+
+}  // namespace bustub
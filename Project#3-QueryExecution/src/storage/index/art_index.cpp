@@ -0,0 +1,900 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// art_index.cpp
+//
+// Identification: src/storage/index/art_index.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/art_index.h"
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "common/macros.h"
+#include "storage/index/normalized_key.h"
+
+namespace bustub {
+
+struct ArtIndex::Leaf : public ArtNode {
+  Leaf(std::vector<uint8_t> key, std::vector<RID> rids)
+      : ArtNode(ArtNodeType::LEAF), key_(std::move(key)), rids_(std::move(rids)) {}
+
+  const std::vector<uint8_t> key_;
+  const std::vector<RID> rids_;
+};
+
+struct ArtIndex::Node4 : public ArtNode {
+  Node4() : ArtNode(ArtNodeType::NODE4) {}
+
+  // sorted
+  uint8_t keys_[4]{};
+  std::atomic<ArtNode *> children_[4]{};
+};
+
+struct ArtIndex::Node16 : public ArtNode {
+  Node16() : ArtNode(ArtNodeType::NODE16) {}
+
+  // sorted
+  uint8_t keys_[16]{};
+  std::atomic<ArtNode *> children_[16]{};
+};
+
+struct ArtIndex::Node48 : public ArtNode {
+  Node48() : ArtNode(ArtNodeType::NODE48) {}
+
+  // one more than the slot of the child of each byte, 0 if the byte has no child
+  uint8_t child_index_[256]{};
+  std::atomic<ArtNode *> children_[48]{};
+};
+
+struct ArtIndex::Node256 : public ArtNode {
+  Node256() : ArtNode(ArtNodeType::NODE256) {}
+
+  std::atomic<ArtNode *> children_[256]{};
+};
+
+/*
+ * Epoch based reclamation. Operations register in the epoch they start in, and nodes are retired in the epoch they
+ * are unlinked in. Only operations of that epoch or earlier can still reach a retired node, so it is freed two epochs
+ * later. The epoch advances when no operation of the epoch before the current one is running.
+ */
+class ArtIndex::Epoch {
+ public:
+  ~Epoch() {
+    for (auto &retired : retired_) {
+      for (auto *node : retired) {
+        FreeNode(node);
+      }
+    }
+  }
+
+  uint64_t Enter() {
+    while (true) {
+      uint64_t epoch = epoch_.load();
+      active_[epoch % 3].fetch_add(1);
+      if (epoch_.load() == epoch) {
+        return epoch;
+      }
+      active_[epoch % 3].fetch_sub(1);
+    }
+  }
+
+  void Exit(uint64_t epoch) { active_[epoch % 3].fetch_sub(1); }
+
+  void Retire(ArtNode *node) {
+    std::lock_guard<std::mutex> guard(latch_);
+    uint64_t epoch = epoch_.load();
+    retired_[epoch % 3].push_back(node);
+    // operations of epoch - 1 are done, nodes of epoch - 1 are then safe to free once the epoch is epoch + 1
+    if (++num_retired_ % RECLAIM_INTERVAL == 0 && active_[(epoch + 2) % 3].load() == 0) {
+      epoch_.store(epoch + 1);
+      for (auto *retired_node : retired_[(epoch + 2) % 3]) {
+        FreeNode(retired_node);
+      }
+      retired_[(epoch + 2) % 3].clear();
+    }
+  }
+
+ private:
+  static constexpr uint64_t RECLAIM_INTERVAL = 64;
+
+  std::atomic<uint64_t> epoch_{2};
+  std::atomic<int> active_[3]{};
+  std::mutex latch_;
+  std::vector<ArtNode *> retired_[3];
+  uint64_t num_retired_{0};
+};
+
+class ArtIndex::EpochGuard {
+ public:
+  explicit EpochGuard(Epoch *epoch) : epoch_(epoch), entered_(epoch->Enter()) {}
+  ~EpochGuard() { epoch_->Exit(entered_); }
+
+  DISALLOW_COPY_AND_MOVE(EpochGuard);
+
+ private:
+  Epoch *epoch_;
+  uint64_t entered_;
+};
+
+ArtIndex::ArtIndex(IndexMetadata *metadata) : Index(metadata), root_(new Node256()), epoch_(new Epoch()) {}
+
+ArtIndex::~ArtIndex() {
+  FreeTree(root_);
+  delete epoch_;
+}
+
+void ArtIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  auto index_key = EncodeKey(key);
+  EpochGuard guard(epoch_);
+  while (!TryInsert(index_key, rid)) {
+  }
+}
+
+void ArtIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  auto index_key = EncodeKey(key);
+  EpochGuard guard(epoch_);
+  while (!TryRemove(index_key, rid)) {
+  }
+}
+
+void ArtIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  auto index_key = EncodeKey(key);
+  EpochGuard guard(epoch_);
+  while (!TryLookup(index_key, result)) {
+  }
+}
+
+size_t ArtIndex::ScanRange(const std::optional<KeyBound> &lower, const std::optional<KeyBound> &upper,
+                           std::vector<RID> *result) {
+  std::vector<uint8_t> lower_key;
+  std::vector<uint8_t> upper_key;
+  if (lower.has_value()) {
+    lower_key = EncodeKey(lower->key_);
+  }
+  if (upper.has_value()) {
+    upper_key = EncodeKey(upper->key_);
+  }
+
+  EpochGuard guard(epoch_);
+  size_t start = result->size();
+  while (true) {
+    size_t num_keys = 0;
+    uint64_t version;
+    if (ReadLock(root_, &version) &&
+        ScanNode(root_, version, 0, lower.has_value() ? &lower_key : nullptr, lower.has_value() && lower->inclusive_,
+                 upper.has_value() ? &upper_key : nullptr, upper.has_value() && upper->inclusive_, result,
+                 &num_keys)) {
+      return num_keys;
+    }
+    result->resize(start);
+  }
+}
+
+std::vector<uint8_t> ArtIndex::EncodeKey(const Tuple &key) const {
+  std::vector<uint8_t> index_key(64);
+  size_t length = NormalizeKey(key, GetKeySchema(), reinterpret_cast<char *>(index_key.data()), index_key.size());
+  if (length > index_key.size()) {
+    index_key.resize(length);
+    NormalizeKey(key, GetKeySchema(), reinterpret_cast<char *>(index_key.data()), index_key.size());
+  }
+  index_key.resize(length);
+  return index_key;
+}
+
+/*
+ * Keys are normalized in full, so no key is a prefix of another: a key and the path to any node it does not reach
+ * differ in some byte before the key ends.
+ */
+bool ArtIndex::TryInsert(const std::vector<uint8_t> &key, RID rid) {
+  ArtNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  ArtNode *node = root_;
+  uint64_t version;
+  if (!ReadLock(node, &version)) {
+    return false;
+  }
+
+  uint32_t depth = 0;
+  while (true) {
+    uint32_t match = MatchPrefix(node, key, depth);
+    if (match < node->prefix_length_) {
+      // the key leaves the path of node: a new node takes the matching part, with node and the new leaf below it
+      if (!UpgradeToWriteLock(parent, parent_version)) {
+        return false;
+      }
+      if (!UpgradeToWriteLock(node, version)) {
+        WriteUnlock(parent);
+        return false;
+      }
+      auto *branch = new Node4();
+      branch->prefix_length_ = match;
+      std::copy_n(key.begin() + depth, std::min(match, ART_MAX_PREFIX_LENGTH), branch->prefix_);
+      AddChild(branch, key[depth + match], new Leaf(key, {rid}));
+      AddChild(branch, PrefixByte(node, depth, match), node);
+      CutPrefix(node, depth, match + 1);
+      ChangeChild(parent, parent_byte, branch);
+      WriteUnlock(node);
+      WriteUnlock(parent);
+      return true;
+    }
+
+    depth += node->prefix_length_;
+    uint8_t byte = key[depth];
+    ArtNode *child = FindChild(node, byte);
+    if (!Validate(node, version)) {
+      return false;
+    }
+
+    if (child == nullptr) {
+      if (IsFull(node)) {
+        // the root is never full, so node has a parent
+        if (!UpgradeToWriteLock(parent, parent_version)) {
+          return false;
+        }
+        if (!UpgradeToWriteLock(node, version)) {
+          WriteUnlock(parent);
+          return false;
+        }
+        ArtNode *grown = Grow(node);
+        AddChild(grown, byte, new Leaf(key, {rid}));
+        ChangeChild(parent, parent_byte, grown);
+        WriteUnlockObsolete(node);
+        WriteUnlock(parent);
+        epoch_->Retire(node);
+        return true;
+      }
+      if (!UpgradeToWriteLock(node, version)) {
+        return false;
+      }
+      AddChild(node, byte, new Leaf(key, {rid}));
+      WriteUnlock(node);
+      return true;
+    }
+
+    if (child->type_ == ArtNodeType::LEAF) {
+      auto *leaf = static_cast<Leaf *>(child);
+      if (!UpgradeToWriteLock(node, version)) {
+        return false;
+      }
+      if (leaf->key_ == key) {
+        if (std::find(leaf->rids_.begin(), leaf->rids_.end(), rid) == leaf->rids_.end()) {
+          std::vector<RID> rids = leaf->rids_;
+          rids.push_back(rid);
+          ChangeChild(node, byte, new Leaf(key, std::move(rids)));
+          epoch_->Retire(leaf);
+        }
+        WriteUnlock(node);
+        return true;
+      }
+      // a new node takes the bytes both keys share past byte, with the two leaves below it
+      uint32_t length = 0;
+      while (leaf->key_[depth + 1 + length] == key[depth + 1 + length]) {
+        length++;
+      }
+      auto *branch = new Node4();
+      branch->prefix_length_ = length;
+      std::copy_n(key.begin() + depth + 1, std::min(length, ART_MAX_PREFIX_LENGTH), branch->prefix_);
+      AddChild(branch, key[depth + 1 + length], new Leaf(key, {rid}));
+      AddChild(branch, leaf->key_[depth + 1 + length], leaf);
+      ChangeChild(node, byte, branch);
+      WriteUnlock(node);
+      return true;
+    }
+
+    uint64_t child_version;
+    if (!ReadLock(child, &child_version) || !Validate(node, version)) {
+      return false;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = child;
+    version = child_version;
+    depth++;
+  }
+}
+
+/*
+ * A node left with a single child is replaced by the child, which takes over its path. Other nodes left with few
+ * children are replaced by a smaller node. The root is never replaced.
+ */
+bool ArtIndex::TryRemove(const std::vector<uint8_t> &key, RID rid) {
+  ArtNode *parent = nullptr;
+  uint64_t parent_version = 0;
+  uint8_t parent_byte = 0;
+  ArtNode *node = root_;
+  uint64_t version;
+  if (!ReadLock(node, &version)) {
+    return false;
+  }
+
+  uint32_t depth = 0;
+  while (true) {
+    if (MatchPrefix(node, key, depth) < node->prefix_length_) {
+      return Validate(node, version);
+    }
+    uint32_t node_depth = depth;
+    depth += node->prefix_length_;
+    uint8_t byte = key[depth];
+    ArtNode *child = FindChild(node, byte);
+    if (!Validate(node, version)) {
+      return false;
+    }
+    if (child == nullptr) {
+      return true;
+    }
+
+    if (child->type_ == ArtNodeType::LEAF) {
+      auto *leaf = static_cast<Leaf *>(child);
+      if (leaf->key_ != key || std::find(leaf->rids_.begin(), leaf->rids_.end(), rid) == leaf->rids_.end()) {
+        return true;
+      }
+
+      if (leaf->rids_.size() > 1) {
+        if (!UpgradeToWriteLock(node, version)) {
+          return false;
+        }
+        std::vector<RID> rids;
+        std::copy_if(leaf->rids_.begin(), leaf->rids_.end(), std::back_inserter(rids),
+                     [&rid](const RID &other) { return !(other == rid); });
+        ChangeChild(node, byte, new Leaf(key, std::move(rids)));
+        WriteUnlock(node);
+        epoch_->Retire(leaf);
+        return true;
+      }
+
+      bool collapse = node != root_ && node->type_ == ArtNodeType::NODE4 && node->num_children_ == 2;
+      bool shrink = node != root_ && IsUnderfull(node);
+      if (!collapse && !shrink) {
+        if (!UpgradeToWriteLock(node, version)) {
+          return false;
+        }
+        RemoveChild(node, byte);
+        WriteUnlock(node);
+        epoch_->Retire(leaf);
+        return true;
+      }
+
+      if (!UpgradeToWriteLock(parent, parent_version)) {
+        return false;
+      }
+      if (!UpgradeToWriteLock(node, version)) {
+        WriteUnlock(parent);
+        return false;
+      }
+      if (shrink) {
+        RemoveChild(node, byte);
+        ChangeChild(parent, parent_byte, Shrink(node));
+      } else {
+        std::vector<std::pair<uint8_t, ArtNode *>> children;
+        GetChildren(node, &children);
+        auto [sibling_byte, sibling] = children[0].first == byte ? children[1] : children[0];
+        if (sibling->type_ != ArtNodeType::LEAF) {
+          // the sibling takes the path of node, then its byte, then its own path
+          uint64_t sibling_version;
+          if (!ReadLock(sibling, &sibling_version) || !UpgradeToWriteLock(sibling, sibling_version)) {
+            WriteUnlock(node);
+            WriteUnlock(parent);
+            return false;
+          }
+          uint32_t length = node->prefix_length_ + 1 + sibling->prefix_length_;
+          uint8_t prefix[ART_MAX_PREFIX_LENGTH];
+          for (uint32_t i = 0; i < std::min(length, ART_MAX_PREFIX_LENGTH); i++) {
+            if (i < node->prefix_length_) {
+              prefix[i] = PrefixByte(node, node_depth, i);
+            } else if (i == node->prefix_length_) {
+              prefix[i] = sibling_byte;
+            } else {
+              prefix[i] = PrefixByte(sibling, depth + 1, i - node->prefix_length_ - 1);
+            }
+          }
+          sibling->prefix_length_ = length;
+          std::copy_n(prefix, std::min(length, ART_MAX_PREFIX_LENGTH), sibling->prefix_);
+          WriteUnlock(sibling);
+        }
+        ChangeChild(parent, parent_byte, sibling);
+      }
+      WriteUnlockObsolete(node);
+      WriteUnlock(parent);
+      epoch_->Retire(node);
+      epoch_->Retire(leaf);
+      return true;
+    }
+
+    uint64_t child_version;
+    if (!ReadLock(child, &child_version) || !Validate(node, version)) {
+      return false;
+    }
+    parent = node;
+    parent_version = version;
+    parent_byte = byte;
+    node = child;
+    version = child_version;
+    depth++;
+  }
+}
+
+bool ArtIndex::TryLookup(const std::vector<uint8_t> &key, std::vector<RID> *result) {
+  ArtNode *node = root_;
+  uint64_t version;
+  if (!ReadLock(node, &version)) {
+    return false;
+  }
+
+  uint32_t depth = 0;
+  while (true) {
+    if (MatchPrefix(node, key, depth) < node->prefix_length_) {
+      return Validate(node, version);
+    }
+    depth += node->prefix_length_;
+    ArtNode *child = FindChild(node, key[depth]);
+    if (!Validate(node, version)) {
+      return false;
+    }
+    if (child == nullptr) {
+      return true;
+    }
+
+    if (child->type_ == ArtNodeType::LEAF) {
+      auto *leaf = static_cast<Leaf *>(child);
+      if (leaf->key_ == key) {
+        result->insert(result->end(), leaf->rids_.begin(), leaf->rids_.end());
+      }
+      return true;
+    }
+
+    uint64_t child_version;
+    if (!ReadLock(child, &child_version) || !Validate(node, version)) {
+      return false;
+    }
+    node = child;
+    version = child_version;
+    depth++;
+  }
+}
+
+/*
+ * A bound is null once the keys below node are known to be past it, only the nodes on the path to a bound compare
+ * their bytes with it. A longer key that starts like a bound is greater than the bound.
+ */
+bool ArtIndex::ScanNode(ArtNode *node, uint64_t version, uint32_t depth, const std::vector<uint8_t> *lower,
+                        bool lower_inclusive, const std::vector<uint8_t> *upper, bool upper_inclusive,
+                        std::vector<RID> *result, size_t *num_keys) {
+  for (uint32_t i = 0; i < node->prefix_length_ && (lower != nullptr || upper != nullptr); i++) {
+    uint8_t byte = PrefixByte(node, depth, i);
+    if (lower != nullptr) {
+      if (depth + i >= lower->size() || byte > (*lower)[depth + i]) {
+        lower = nullptr;
+      } else if (byte < (*lower)[depth + i]) {
+        return Validate(node, version);
+      }
+    }
+    if (upper != nullptr) {
+      if (depth + i >= upper->size() || byte > (*upper)[depth + i]) {
+        return Validate(node, version);
+      }
+      if (byte < (*upper)[depth + i]) {
+        upper = nullptr;
+      }
+    }
+  }
+  depth += node->prefix_length_;
+
+  std::vector<std::pair<uint8_t, ArtNode *>> children;
+  GetChildren(node, &children);
+  if (!Validate(node, version)) {
+    return false;
+  }
+
+  for (auto [byte, child] : children) {
+    const std::vector<uint8_t> *child_lower = lower;
+    const std::vector<uint8_t> *child_upper = upper;
+    if (child_lower != nullptr) {
+      if (depth >= child_lower->size() || byte > (*child_lower)[depth]) {
+        child_lower = nullptr;
+      } else if (byte < (*child_lower)[depth]) {
+        continue;
+      }
+    }
+    if (child_upper != nullptr) {
+      if (depth >= child_upper->size() || byte > (*child_upper)[depth]) {
+        break;
+      }
+      if (byte < (*child_upper)[depth]) {
+        child_upper = nullptr;
+      }
+    }
+
+    if (child->type_ == ArtNodeType::LEAF) {
+      auto *leaf = static_cast<Leaf *>(child);
+      if (child_lower != nullptr && (leaf->key_ < *child_lower || (leaf->key_ == *child_lower && !lower_inclusive))) {
+        continue;
+      }
+      if (child_upper != nullptr && (leaf->key_ > *child_upper || (leaf->key_ == *child_upper && !upper_inclusive))) {
+        continue;
+      }
+      result->insert(result->end(), leaf->rids_.begin(), leaf->rids_.end());
+      (*num_keys)++;
+      continue;
+    }
+
+    uint64_t child_version;
+    if (!ReadLock(child, &child_version) || !Validate(node, version) ||
+        !ScanNode(child, child_version, depth + 1, child_lower, lower_inclusive, child_upper, upper_inclusive, result,
+                  num_keys)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t ArtIndex::MatchPrefix(ArtNode *node, const std::vector<uint8_t> &key, uint32_t depth) const {
+  for (uint32_t i = 0; i < node->prefix_length_; i++) {
+    if (depth + i >= key.size() || key[depth + i] != PrefixByte(node, depth, i)) {
+      return i;
+    }
+  }
+  return node->prefix_length_;
+}
+
+uint8_t ArtIndex::PrefixByte(ArtNode *node, uint32_t depth, uint32_t index) const {
+  if (index < ART_MAX_PREFIX_LENGTH) {
+    return node->prefix_[index];
+  }
+  // every key below node has the path of node, a concurrent change of node is caught by validating its version
+  Leaf *leaf = MinimumLeaf(node);
+  return leaf != nullptr && depth + index < leaf->key_.size() ? leaf->key_[depth + index] : 0;
+}
+
+void ArtIndex::CutPrefix(ArtNode *node, uint32_t depth, uint32_t length) const {
+  uint32_t remaining = node->prefix_length_ - length;
+  uint8_t prefix[ART_MAX_PREFIX_LENGTH];
+  for (uint32_t i = 0; i < std::min(remaining, ART_MAX_PREFIX_LENGTH); i++) {
+    prefix[i] = PrefixByte(node, depth, length + i);
+  }
+  node->prefix_length_ = remaining;
+  std::copy_n(prefix, std::min(remaining, ART_MAX_PREFIX_LENGTH), node->prefix_);
+}
+
+ArtNode *ArtIndex::FindChild(ArtNode *node, uint8_t byte) {
+  switch (node->type_) {
+    case ArtNodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      for (int i = 0; i < std::min<int>(node4->num_children_, 4); i++) {
+        if (node4->keys_[i] == byte) {
+          return node4->children_[i].load();
+        }
+      }
+      return nullptr;
+    }
+    case ArtNodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      int num_children = std::min<int>(node16->num_children_, 16);
+#if defined(__SSE2__)
+      __m128i equal = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i *>(node16->keys_)));
+      int mask = _mm_movemask_epi8(equal) & ((1 << num_children) - 1);
+      return mask != 0 ? node16->children_[__builtin_ctz(mask)].load() : nullptr;
+#else
+      for (int i = 0; i < num_children; i++) {
+        if (node16->keys_[i] == byte) {
+          return node16->children_[i].load();
+        }
+      }
+      return nullptr;
+#endif
+    }
+    case ArtNodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      uint8_t slot = node48->child_index_[byte];
+      return slot != 0 ? node48->children_[slot - 1].load() : nullptr;
+    }
+    case ArtNodeType::NODE256:
+      return static_cast<Node256 *>(node)->children_[byte].load();
+    default:
+      return nullptr;
+  }
+}
+
+/*
+ * Node4 and Node16 keep their keys sorted
+ */
+template <typename NodeType>
+static void InsertSorted(NodeType *node, uint8_t byte, ArtNode *child) {
+  int pos = 0;
+  while (pos < node->num_children_ && node->keys_[pos] < byte) {
+    pos++;
+  }
+  for (int i = node->num_children_; i > pos; i--) {
+    node->keys_[i] = node->keys_[i - 1];
+    node->children_[i].store(node->children_[i - 1].load());
+  }
+  node->keys_[pos] = byte;
+  node->children_[pos].store(child);
+}
+
+template <typename NodeType>
+static void RemoveSorted(NodeType *node, uint8_t byte) {
+  int pos = 0;
+  while (node->keys_[pos] != byte) {
+    pos++;
+  }
+  for (int i = pos; i + 1 < node->num_children_; i++) {
+    node->keys_[i] = node->keys_[i + 1];
+    node->children_[i].store(node->children_[i + 1].load());
+  }
+}
+
+void ArtIndex::AddChild(ArtNode *node, uint8_t byte, ArtNode *child) {
+  switch (node->type_) {
+    case ArtNodeType::NODE4:
+      InsertSorted(static_cast<Node4 *>(node), byte, child);
+      break;
+    case ArtNodeType::NODE16:
+      InsertSorted(static_cast<Node16 *>(node), byte, child);
+      break;
+    case ArtNodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      uint8_t slot = 0;
+      while (node48->children_[slot].load() != nullptr) {
+        slot++;
+      }
+      node48->children_[slot].store(child);
+      node48->child_index_[byte] = slot + 1;
+      break;
+    }
+    case ArtNodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte].store(child);
+      break;
+    default:
+      break;
+  }
+  node->num_children_++;
+}
+
+void ArtIndex::ChangeChild(ArtNode *node, uint8_t byte, ArtNode *child) {
+  switch (node->type_) {
+    case ArtNodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      node4->children_[std::find(node4->keys_, node4->keys_ + node4->num_children_, byte) - node4->keys_].store(child);
+      break;
+    }
+    case ArtNodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      node16->children_[std::find(node16->keys_, node16->keys_ + node16->num_children_, byte) - node16->keys_].store(
+          child);
+      break;
+    }
+    case ArtNodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte] - 1].store(child);
+      break;
+    }
+    case ArtNodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte].store(child);
+      break;
+    default:
+      break;
+  }
+}
+
+void ArtIndex::RemoveChild(ArtNode *node, uint8_t byte) {
+  switch (node->type_) {
+    case ArtNodeType::NODE4:
+      RemoveSorted(static_cast<Node4 *>(node), byte);
+      break;
+    case ArtNodeType::NODE16:
+      RemoveSorted(static_cast<Node16 *>(node), byte);
+      break;
+    case ArtNodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte] - 1].store(nullptr);
+      node48->child_index_[byte] = 0;
+      break;
+    }
+    case ArtNodeType::NODE256:
+      static_cast<Node256 *>(node)->children_[byte].store(nullptr);
+      break;
+    default:
+      break;
+  }
+  node->num_children_--;
+}
+
+void ArtIndex::GetChildren(ArtNode *node, std::vector<std::pair<uint8_t, ArtNode *>> *children) {
+  switch (node->type_) {
+    case ArtNodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      for (int i = 0; i < std::min<int>(node4->num_children_, 4); i++) {
+        children->emplace_back(node4->keys_[i], node4->children_[i].load());
+      }
+      break;
+    }
+    case ArtNodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      for (int i = 0; i < std::min<int>(node16->num_children_, 16); i++) {
+        children->emplace_back(node16->keys_[i], node16->children_[i].load());
+      }
+      break;
+    }
+    case ArtNodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        uint8_t slot = node48->child_index_[byte];
+        if (slot != 0) {
+          children->emplace_back(byte, node48->children_[slot - 1].load());
+        }
+      }
+      break;
+    }
+    case ArtNodeType::NODE256: {
+      auto *node256 = static_cast<Node256 *>(node);
+      for (int byte = 0; byte < 256; byte++) {
+        ArtNode *child = node256->children_[byte].load();
+        if (child != nullptr) {
+          children->emplace_back(byte, child);
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  // a concurrent change can leave an unset child in view, the read is then invalidated
+  children->erase(std::remove_if(children->begin(), children->end(),
+                                 [](const std::pair<uint8_t, ArtNode *> &child) { return child.second == nullptr; }),
+                  children->end());
+}
+
+bool ArtIndex::IsFull(ArtNode *node) {
+  switch (node->type_) {
+    case ArtNodeType::NODE4:
+      return node->num_children_ == 4;
+    case ArtNodeType::NODE16:
+      return node->num_children_ == 16;
+    case ArtNodeType::NODE48:
+      return node->num_children_ == 48;
+    default:
+      return false;
+  }
+}
+
+/*
+ * Whether the node, after removing a child, fits in the next smaller node with room to spare
+ */
+bool ArtIndex::IsUnderfull(ArtNode *node) {
+  switch (node->type_) {
+    case ArtNodeType::NODE16:
+      return node->num_children_ <= 4;
+    case ArtNodeType::NODE48:
+      return node->num_children_ <= 13;
+    case ArtNodeType::NODE256:
+      return node->num_children_ <= 38;
+    default:
+      return false;
+  }
+}
+
+ArtNode *ArtIndex::Grow(ArtNode *node) {
+  ArtNode *grown;
+  switch (node->type_) {
+    case ArtNodeType::NODE4:
+      grown = new Node16();
+      break;
+    case ArtNodeType::NODE16:
+      grown = new Node48();
+      break;
+    default:
+      grown = new Node256();
+      break;
+  }
+  CopyPrefix(node, grown);
+  std::vector<std::pair<uint8_t, ArtNode *>> children;
+  GetChildren(node, &children);
+  for (auto [byte, child] : children) {
+    AddChild(grown, byte, child);
+  }
+  return grown;
+}
+
+ArtNode *ArtIndex::Shrink(ArtNode *node) {
+  ArtNode *shrunk;
+  switch (node->type_) {
+    case ArtNodeType::NODE256:
+      shrunk = new Node48();
+      break;
+    case ArtNodeType::NODE48:
+      shrunk = new Node16();
+      break;
+    default:
+      shrunk = new Node4();
+      break;
+  }
+  CopyPrefix(node, shrunk);
+  std::vector<std::pair<uint8_t, ArtNode *>> children;
+  GetChildren(node, &children);
+  for (auto [byte, child] : children) {
+    AddChild(shrunk, byte, child);
+  }
+  return shrunk;
+}
+
+void ArtIndex::CopyPrefix(const ArtNode *from, ArtNode *to) {
+  to->prefix_length_ = from->prefix_length_;
+  std::copy_n(from->prefix_, ART_MAX_PREFIX_LENGTH, to->prefix_);
+}
+
+ArtIndex::Leaf *ArtIndex::MinimumLeaf(ArtNode *node) {
+  std::vector<std::pair<uint8_t, ArtNode *>> children;
+  while (node != nullptr && node->type_ != ArtNodeType::LEAF) {
+    children.clear();
+    GetChildren(node, &children);
+    node = children.empty() ? nullptr : children[0].second;
+  }
+  return static_cast<Leaf *>(node);
+}
+
+void ArtIndex::FreeNode(ArtNode *node) {
+  switch (node->type_) {
+    case ArtNodeType::LEAF:
+      delete static_cast<Leaf *>(node);
+      break;
+    case ArtNodeType::NODE4:
+      delete static_cast<Node4 *>(node);
+      break;
+    case ArtNodeType::NODE16:
+      delete static_cast<Node16 *>(node);
+      break;
+    case ArtNodeType::NODE48:
+      delete static_cast<Node48 *>(node);
+      break;
+    case ArtNodeType::NODE256:
+      delete static_cast<Node256 *>(node);
+      break;
+  }
+}
+
+void ArtIndex::FreeTree(ArtNode *node) {
+  if (node->type_ != ArtNodeType::LEAF) {
+    std::vector<std::pair<uint8_t, ArtNode *>> children;
+    GetChildren(node, &children);
+    for (auto [byte, child] : children) {
+      FreeTree(child);
+    }
+  }
+  FreeNode(node);
+}
+
+bool ArtIndex::ReadLock(ArtNode *node, uint64_t *version) {
+  uint64_t current = node->version_.load();
+  while ((current & 0b10) != 0) {
+    std::this_thread::yield();
+    current = node->version_.load();
+  }
+  *version = current;
+  return (current & 0b01) == 0;
+}
+
+bool ArtIndex::Validate(ArtNode *node, uint64_t version) { return node->version_.load() == version; }
+
+bool ArtIndex::UpgradeToWriteLock(ArtNode *node, uint64_t version) {
+  return node->version_.compare_exchange_strong(version, version + 0b10);
+}
+
+void ArtIndex::WriteUnlock(ArtNode *node) { node->version_.fetch_add(0b10); }
+
+void ArtIndex::WriteUnlockObsolete(ArtNode *node) { node->version_.fetch_add(0b11); }
+
+}  // namespace bustub
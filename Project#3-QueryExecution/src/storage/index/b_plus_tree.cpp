@@ -12,6 +12,7 @@
 #include "storage/index/b_plus_tree.h"
 
 #include <algorithm>
+#include <numeric>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -20,44 +21,156 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, LatchMode latch_mode, bool unique_keys,
+                          int key_size)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      latch_mode_(latch_mode),
+      unique_keys_(unique_keys),
+      key_size_(key_size) {
+  if (latch_mode_ == LatchMode::BLINK) {
+    // keep the pair at index max size free for the high key and right link
+    leaf_max_size_ = std::min(leaf_max_size_, static_cast<int>(TRUNCATED_LEAF_PAGE_SIZE(key_size_)) - 1);
+    internal_max_size_ = std::min(internal_max_size_, static_cast<int>(TRUNCATED_INTERNAL_PAGE_SIZE(key_size_)) - 1);
+  }
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_.load() == INVALID_PAGE_ID; }
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values associated with input key, the only one if the keys are unique
  * This method is used for point query
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  auto leaf_page = FindLeafPageByOperation(key, Operation::SEARCH, transaction).first;
+  auto leaf_page = latch_mode_ == LatchMode::BLINK ? FindLeafPageBLink(key, Operation::SEARCH)
+                                                   : FindLeafPageByOperation(key, Operation::SEARCH, transaction).first;
+  if (leaf_page == nullptr) {
+    return false;
+  }
   LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
-  ValueType v;
-  auto existed = node->Lookup(key, &v, comparator_);
+  auto size = result->size();
+  LookupValues(node, key, result);
 
   leaf_page->RUnlatch();
   buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
 
-  if (!existed) {
-    return false;
+  return result->size() != size;
+}
+
+/*
+ * Append the values of key in a latched leaf to result, reading its posting list if it has one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LookupValues(LeafPage *leaf, const KeyType &key, std::vector<ValueType> *result) const {
+  ValueType value;
+  if (!leaf->Lookup(key, &value, comparator_)) {
+    return;
+  }
+  if (!unique_keys_ && PostingPage::IsReference(value)) {
+    PostingListCollect(value, result);
+    return;
   }
+  result->push_back(value);
+}
 
-  result->push_back(v);
-  return true;
+/*
+ * Batched point lookups
+ * @param   results       results[i] gets the values of keys[i]
+ * The keys are looked up in key order, keeping the read latched path from the root to the leaf of the last key. The
+ * next key only releases the pages whose subtree ends at or before it and descends again from the lowest page left,
+ * so keys on the same leaf share the leaf and keys close to each other share most of the internal pages. The path
+ * is latched top down like any other descent, in a B-link tree pages split under it are passed by moving right.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *results,
+                               Transaction *transaction) {
+  results->assign(keys.size(), {});
+
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b) { return comparator_(keys[a], keys[b]) < 0; });
+
+  auto blink = latch_mode_ == LatchMode::BLINK;
+  std::vector<BatchLevel> path;
+  for (auto i : order) {
+    const auto &key = keys[i];
+    while (!path.empty() && path.back().bounded_ && comparator_(key, path.back().upper_key_) >= 0) {
+      ReleaseBatchLevel(&path.back());
+      path.pop_back();
+    }
+
+    if (path.empty()) {
+      auto root_page = FetchRootPageForRead();
+      if (root_page == nullptr) {
+        return;
+      }
+      path.push_back(blink ? MoveRightBatchLevel(root_page, key) : BatchLevel{root_page, false, KeyType()});
+    }
+
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(path.back().page_->GetData());
+    while (!node->IsLeafPage()) {
+      InternalPage *parent_node = reinterpret_cast<InternalPage *>(node);
+      auto child_page_id = parent_node->Lookup(key, comparator_);
+      auto child_page = buffer_pool_manager_->FetchPage(child_page_id);
+      child_page->RLatch();
+
+      if (blink) {
+        path.push_back(MoveRightBatchLevel(child_page, key));
+      } else {
+        // the child ends where the next child starts, the last child ends where its parent does
+        BatchLevel level{child_page, path.back().bounded_, path.back().upper_key_};
+        auto index = parent_node->ValueIndex(child_page_id);
+        if (index + 1 < parent_node->GetSize()) {
+          level.bounded_ = true;
+          level.upper_key_ = parent_node->KeyAt(index + 1);
+        }
+        path.push_back(level);
+      }
+      node = reinterpret_cast<BPlusTreePage *>(path.back().page_->GetData());
+    }
+
+    LookupValues(reinterpret_cast<LeafPage *>(node), key, &(*results)[i]);
+  }
+
+  while (!path.empty()) {
+    ReleaseBatchLevel(&path.back());
+    path.pop_back();
+  }
+}
+
+/*
+ * Move right from a read latched page of a B-link tree to the page covering key, which ends at its own high key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::BatchLevel BPLUSTREE_TYPE::MoveRightBatchLevel(Page *page, const KeyType &key) {
+  if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    page = MoveRightBLink<LeafPage>(page, key, false);
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    return BatchLevel{page, leaf->GetNextPageId() != INVALID_PAGE_ID, leaf->GetHighKey()};
+  }
+  page = MoveRightBLink<InternalPage>(page, key, false);
+  InternalPage *internal = reinterpret_cast<InternalPage *>(page->GetData());
+  return BatchLevel{page, internal->GetNextPageId() != INVALID_PAGE_ID, internal->GetHighKey()};
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseBatchLevel(BatchLevel *level) {
+  level->page_->RUnlatch();
+  buffer_pool_manager_->UnpinPage(level->page_->GetPageId(), false);
 }
 
 /*****************************************************************************
@@ -67,8 +180,9 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if the keys are unique and user try to insert duplicate keys
+ * return false, otherwise return true. If the keys are not unique a duplicate
+ * key adds the value to the posting list of the key.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
@@ -91,18 +205,22 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
-  auto page = buffer_pool_manager_->NewPage(&root_page_id_);
+  page_id_t root_page_id;
+  auto page = buffer_pool_manager_->NewPage(&root_page_id);
 
   if (page == nullptr) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
   }
 
   LeafPage *leaf = reinterpret_cast<LeafPage *>(page->GetData());
-  leaf->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
+  leaf->Init(root_page_id, INVALID_PAGE_ID, leaf_max_size_, key_size_);
 
   // directly insert into leaf page
   leaf->Insert(key, value, comparator_);
 
+  // publish the root only once it is filled in, readers do not wait for root_page_id_latch
+  root_page_id_.store(root_page_id);
+
   buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 
   UpdateRootPageId(1);
@@ -115,12 +233,56 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
  * immediately, otherwise insert entry. Remember to deal with split if necessary.
  * Perform split if insertion triggers current number of key/value pairs after insertion equals to
  * `max_size`
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * In OPTIMISTIC latch mode the insert is first tried with only the leaf write latched, and only redone
+ * pessimistically if it splits the leaf.
+ * @return: if the keys are unique and user try to insert duplicate keys
+ * return false, otherwise return true. If the keys are not unique a duplicate
+ * key adds the value to the posting list of the key.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (latch_mode_ == LatchMode::BLINK) {
+    return InsertIntoLeafBLink(key, value);
+  }
+
+  if (latch_mode_ == LatchMode::OPTIMISTIC) {
+    auto leaf_page = FindLeafPageOptimistically(key);
+    // a concurrent remove emptied the tree, the pessimistic path starts a new one
+    if (leaf_page != nullptr) {
+      LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+
+      ValueType v;
+      // duplicate key, a posting list never changes the size of the leaf
+      if (node->Lookup(key, &v, comparator_)) {
+        if (!unique_keys_) {
+          PostingListInsert(node, key, value);
+        }
+        leaf_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), !unique_keys_);
+        return !unique_keys_;
+      }
+
+      // leaf stays not full, no ancestor is touched
+      if (node->GetSize() < leaf_max_size_ - 1) {
+        node->Insert(key, value, comparator_);
+        leaf_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+        return true;
+      }
+
+      // leaf would split, start over with the ancestors write latched
+      leaf_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    }
+  }
+
   auto [leaf_page, is_root_page_id_latched] = FindLeafPageByOperation(key, Operation::INSERT, transaction);
+  // the tree was emptied since Insert checked, root_page_id_latch is held
+  if (leaf_page == nullptr) {
+    StartNewTree(key, value);
+    root_page_id_latch.unlock();
+    return true;
+  }
   LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
   auto size = node->GetSize();
@@ -132,9 +294,12 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
       root_page_id_latch.unlock();
     }
     ClearTransactionPageSetAndUnpinEach(transaction);
+    if (!unique_keys_) {
+      PostingListInsert(node, key, value);
+    }
     leaf_page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
-    return false;
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), !unique_keys_);
+    return !unique_keys_;
   }
 
   // leaf is not full
@@ -147,7 +312,9 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   // leaf is full, need to split
   auto sibling_leaf_node = Split(node);
   sibling_leaf_node->SetNextPageId(node->GetNextPageId());
+  sibling_leaf_node->SetPrevPageId(node->GetPageId());
   node->SetNextPageId(sibling_leaf_node->GetPageId());
+  LinkNextLeafBack(sibling_leaf_node, true);
 
   auto risen_key = sibling_leaf_node->KeyAt(0);
   InsertIntoParent(node, risen_key, sibling_leaf_node, transaction);
@@ -182,14 +349,15 @@ N *BPLUSTREE_TYPE::Split(N *node) {
     LeafPage *leaf = reinterpret_cast<LeafPage *>(node);
     LeafPage *new_leaf = reinterpret_cast<LeafPage *>(new_node);
 
-    new_leaf->Init(page->GetPageId(), node->GetParentPageId(), leaf_max_size_);
+    new_leaf->Init(page->GetPageId(), node->GetParentPageId(), leaf_max_size_, key_size_);
     leaf->MoveHalfTo(new_leaf);
   } else {
     InternalPage *internal = reinterpret_cast<InternalPage *>(node);
     InternalPage *new_internal = reinterpret_cast<InternalPage *>(new_node);
 
-    new_internal->Init(page->GetPageId(), node->GetParentPageId(), internal_max_size_);
-    internal->MoveHalfTo(new_internal, buffer_pool_manager_);
+    new_internal->Init(page->GetPageId(), node->GetParentPageId(), internal_max_size_, key_size_);
+    // B-link trees do not keep parent page ids, the moved children are not touched
+    internal->MoveHalfTo(new_internal, latch_mode_ == LatchMode::BLINK ? nullptr : buffer_pool_manager_);
   }
 
   return new_node;
@@ -210,27 +378,31 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                                       Transaction *transaction) {
   if (old_node->IsRootPage()) {
-    auto page = buffer_pool_manager_->NewPage(&root_page_id_);
+    page_id_t root_page_id;
+    auto page = buffer_pool_manager_->NewPage(&root_page_id);
 
     if (page == nullptr) {
       throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
     }
 
     InternalPage *new_root = reinterpret_cast<InternalPage *>(page->GetData());
-    new_root->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
+    new_root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_, key_size_);
 
     new_root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
 
     old_node->SetParentPageId(new_root->GetPageId());
     new_node->SetParentPageId(new_root->GetPageId());
 
+    // publish the new root once it is filled in, readers waiting on the old root see it changed
+    root_page_id_.store(root_page_id);
+
     buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
 
     UpdateRootPageId(0);
 
     root_page_id_latch.unlock();
 
-    ClearTransactionPageSet(transaction);
+    ClearTransactionPageSetAndUnpinEach(transaction);
     return;
   }
 
@@ -240,7 +412,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
 
   // parent node is not full
   if (new_size < internal_max_size_) {
-    ClearTransactionPageSet(transaction);
+    ClearTransactionPageSetAndUnpinEach(transaction);
     buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
     return;
   }
@@ -254,6 +426,394 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   buffer_pool_manager_->UnpinPage(parent_new_sibling_node->GetPageId(), true);
 }
 
+/*
+ * Insert constant key & value pair into the leaf page of a B-link tree
+ * The leaf is found holding one latch at a time. A full leaf is split, linked to its new right sibling, and released
+ * before the split is posted to the parent.
+ * @return: false for a duplicate key if the keys are unique, otherwise true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertIntoLeafBLink(const KeyType &key, const ValueType &value) {
+  std::vector<page_id_t> path;
+  auto leaf_page = FindLeafPageBLink(key, Operation::INSERT, &path);
+  LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+
+  auto size = node->GetSize();
+  auto new_size = node->Insert(key, value, comparator_);
+
+  // duplicate key
+  if (new_size == size) {
+    if (!unique_keys_) {
+      PostingListInsert(node, key, value);
+    }
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), !unique_keys_);
+    return !unique_keys_;
+  }
+
+  // leaf is not full
+  if (new_size < leaf_max_size_) {
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
+    return true;
+  }
+
+  auto sibling_leaf_node = Split(node);
+  LinkSplitBLink(node, sibling_leaf_node);
+  sibling_leaf_node->SetPrevPageId(node->GetPageId());
+  LinkNextLeafBack(sibling_leaf_node, false);
+  InsertIntoParentBLink(leaf_page, sibling_leaf_node->KeyAt(0), sibling_leaf_node, &path);
+  return true;
+}
+
+/*
+ * Post the split of a B-link tree page to its parent, splitting the parent in turn if it fills up
+ * @param   page          the split page, write latched, released by this method
+ * @param   key           the low key of new_node
+ * @param   new_node      the new right sibling of page, unpinned by this method
+ * @param   path          the internal pages passed on the way down to the leaf, from the root
+ * The parent is taken from path and moved right from until it covers key. The new pair is inserted ordered by key,
+ * because other splits of the same page may be posted first. If the tree grew above the path in the meantime, the
+ * path is rebuilt from the current root.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParentBLink(Page *page, const KeyType &key, BPlusTreePage *new_node,
+                                           std::vector<page_id_t> *path) {
+  auto risen_key = key;
+  // levels above the leaves of the page that is split
+  size_t level = 0;
+  while (true) {
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+
+    // only the writer of the root page replaces the root, so with the root write latched the root stays put
+    if (root_page_id_.load() == node->GetPageId()) {
+      const std::lock_guard<std::mutex> guard(root_page_id_latch);
+      page_id_t root_page_id;
+      auto root_page = buffer_pool_manager_->NewPage(&root_page_id);
+
+      if (root_page == nullptr) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+      }
+
+      InternalPage *new_root = reinterpret_cast<InternalPage *>(root_page->GetData());
+      new_root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_, key_size_);
+      new_root->SetNextPageId(INVALID_PAGE_ID);
+      new_root->PopulateNewRoot(node->GetPageId(), risen_key, new_node->GetPageId());
+      root_page_id_.store(root_page_id);
+      UpdateRootPageId(0);
+
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
+      buffer_pool_manager_->UnpinPage(root_page_id, true);
+      return;
+    }
+
+    // the right link keeps new_node reachable, the split page can go before the parent is latched
+    auto new_page_id = new_node->GetPageId();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+
+    level++;
+    if (path->size() < level) {
+      path->clear();
+      auto leaf_page = FindLeafPageBLink(risen_key, Operation::SEARCH, path);
+      leaf_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    }
+
+    auto parent_page = buffer_pool_manager_->FetchPage((*path)[path->size() - level]);
+    parent_page->WLatch();
+    parent_page = MoveRightBLink<InternalPage>(parent_page, risen_key, true);
+    InternalPage *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+
+    // parent node is not full
+    if (parent_node->Insert(risen_key, new_page_id, comparator_) < internal_max_size_) {
+      parent_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+      return;
+    }
+
+    // parent node is full, need to split
+    auto parent_new_sibling_node = Split(parent_node);
+    LinkSplitBLink(parent_node, parent_new_sibling_node);
+    risen_key = parent_new_sibling_node->KeyAt(0);
+    page = parent_page;
+    new_node = parent_new_sibling_node;
+  }
+}
+
+/*
+ * Link the new right sibling of a split B-link tree page in between the page and its old right sibling. The new page
+ * takes over the high key, the low key of the new page becomes the high key of the split one.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::LinkSplitBLink(N *node, N *new_node) {
+  new_node->SetNextPageId(node->GetNextPageId());
+  new_node->SetHighKey(node->GetHighKey());
+  node->SetNextPageId(new_node->GetPageId());
+  node->SetHighKey(new_node->KeyAt(0));
+}
+
+/*
+ * Point the prev page id of the leaf after leaf back at it, once leaf took the place of that leaf's left neighbour by
+ * a split or a merge. The leaf after it is write latched for that, leaves are latched left to right.
+ * @param   parent_latched    whether the caller holds the parent of leaf write latched, as the latch crabbing writers
+ * do. The leaf after leaf is then only latched if it hangs off that parent too: a writer holding a leaf under another
+ * parent may be waiting for a sibling of that parent. Its prev page id is left behind, which index iterators detect.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::LinkNextLeafBack(LeafPage *leaf, bool parent_latched) {
+  if (leaf->GetNextPageId() == INVALID_PAGE_ID) {
+    return;
+  }
+  if (parent_latched) {
+    auto parent_page = buffer_pool_manager_->FetchPage(leaf->GetParentPageId());
+    InternalPage *parent_node = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    auto same_parent = parent_node->ValueIndex(leaf->GetNextPageId()) < parent_node->GetSize();
+    buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
+    if (!same_parent) {
+      return;
+    }
+  }
+  auto next_page = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
+  next_page->WLatch();
+  reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(leaf->GetPageId());
+  next_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(next_page->GetPageId(), true);
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * Build an empty tree bottom up from key & value pairs in key order
+ * @param   next          yields the next pair, returns false once there is none
+ * @param   fill_factor   the share of a page to fill, between half a page and a full page
+ * Leaves are filled one after the other and every finished page is appended to the page being filled on the level
+ * above, so that only one page per level is being built at a time. The last page of a level is balanced with the
+ * page before it if it ends up below the min size. Pairs with the key of the pair before them are skipped if the keys
+ * are unique, the first one is kept, and go to the key's posting list otherwise, as if the pairs were inserted one by
+ * one. Out of order keys throw, the tree then stays empty.
+ * @return: false if the tree is not empty, otherwise true
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  const std::lock_guard<std::mutex> guard(root_page_id_latch);
+  if (!IsEmpty()) {
+    return false;
+  }
+
+  // pages split once they reach their max size, and must not go below their min size
+  auto fill_size = [fill_factor](int max_size, int min_fill_size) {
+    return std::clamp(static_cast<int>(fill_factor * (max_size - 1)), min_fill_size, max_size - 1);
+  };
+  auto leaf_fill_size = fill_size(leaf_max_size_, std::max(1, leaf_max_size_ / 2));
+  auto internal_fill_size = fill_size(internal_max_size_, std::max(2, internal_max_size_ / 2));
+
+  // levels[0] are the leaves
+  std::vector<BulkLoadLevel> levels(1);
+  KeyType key;
+  KeyType last_key;
+  ValueType value;
+  auto has_last_key = false;
+  while (next(&key, &value)) {
+    if (has_last_key) {
+      auto cmp = comparator_(key, last_key);
+      if (cmp == 0) {
+        if (!unique_keys_) {
+          try {
+            PostingListInsert(reinterpret_cast<LeafPage *>(levels[0].page_->GetData()), key, value);
+          } catch (Exception &e) {
+            BulkLoadAbort(&levels);
+            throw;
+          }
+        }
+        continue;
+      }
+      if (cmp < 0) {
+        BulkLoadAbort(&levels);
+        throw Exception(ExceptionType::INVALID, "Bulk load input is not in key order");
+      }
+    }
+    last_key = key;
+    has_last_key = true;
+
+    auto leaf_page = levels[0].page_;
+    if (leaf_page == nullptr || reinterpret_cast<LeafPage *>(leaf_page->GetData())->GetSize() == leaf_fill_size) {
+      if (leaf_page != nullptr) {
+        BulkLoadAppend(&levels, 1, leaf_page, internal_fill_size);
+      }
+
+      page_id_t page_id;
+      leaf_page = buffer_pool_manager_->NewPage(&page_id);
+      if (leaf_page == nullptr) {
+        BulkLoadAbort(&levels);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+      }
+      reinterpret_cast<LeafPage *>(leaf_page->GetData())->Init(page_id, INVALID_PAGE_ID, leaf_max_size_, key_size_);
+      levels[0].page_ = leaf_page;
+    }
+    reinterpret_cast<LeafPage *>(leaf_page->GetData())->Insert(key, value, comparator_);
+  }
+
+  if (levels[0].page_ == nullptr) {
+    return true;
+  }
+
+  // finish the last page of every level, bottom up, until a level has a single page
+  Page *root_page = nullptr;
+  for (size_t level = 0; root_page == nullptr; level++) {
+    auto page = levels[level].page_;
+    auto prev_page = levels[level].prev_page_;
+
+    if (prev_page != nullptr && BulkLoadBalance(prev_page, page)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      buffer_pool_manager_->DeletePage(page->GetPageId());
+    } else if (prev_page == nullptr && level + 1 == levels.size()) {
+      root_page = page;
+    } else {
+      BulkLoadAppend(&levels, level + 1, page, internal_fill_size);
+    }
+
+    if (levels[level].prev_page_ != nullptr) {
+      buffer_pool_manager_->UnpinPage(levels[level].prev_page_->GetPageId(), true);
+    }
+  }
+
+  // merging the last two pages of the level below may have left the root with a single child
+  BPlusTreePage *root = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+  while (!root->IsLeafPage() && root->GetSize() == 1) {
+    auto child_page = buffer_pool_manager_->FetchPage(reinterpret_cast<InternalPage *>(root)->ValueAt(0));
+    buffer_pool_manager_->UnpinPage(root_page->GetPageId(), false);
+    buffer_pool_manager_->DeletePage(root_page->GetPageId());
+    root_page = child_page;
+    root = reinterpret_cast<BPlusTreePage *>(root_page->GetData());
+    root->SetParentPageId(INVALID_PAGE_ID);
+  }
+
+  root_page_id_.store(root_page->GetPageId());
+  buffer_pool_manager_->UnpinPage(root_page->GetPageId(), true);
+  UpdateRootPageId(1);
+  return true;
+}
+
+/*
+ * Append a finished page to the page being filled on the level above, linking it to the finished page before it
+ * @param   level         the level of the parent, the leaves are level 0
+ * @param   child_page    the finished page, pinned until the page after it is finished
+ * Once the page on the level above is filled, it is finished and appended to the level above it in turn.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAppend(std::vector<BulkLoadLevel> *levels, size_t level, Page *child_page,
+                                    int fill_size) {
+  BPlusTreePage *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+  // bulk loaded internal pages keep their low key in the unused first key
+  auto low_key = child->IsLeafPage() ? reinterpret_cast<LeafPage *>(child)->KeyAt(0)
+                                     : reinterpret_cast<InternalPage *>(child)->KeyAt(0);
+
+  auto prev_page = (*levels)[level - 1].prev_page_;
+  if (prev_page != nullptr) {
+    if (child->IsLeafPage()) {
+      LeafPage *prev = reinterpret_cast<LeafPage *>(prev_page->GetData());
+      prev->SetNextPageId(child->GetPageId());
+      reinterpret_cast<LeafPage *>(child)->SetPrevPageId(prev_page->GetPageId());
+      if (latch_mode_ == LatchMode::BLINK) {
+        prev->SetHighKey(low_key);
+      }
+    } else if (latch_mode_ == LatchMode::BLINK) {
+      InternalPage *prev = reinterpret_cast<InternalPage *>(prev_page->GetData());
+      prev->SetNextPageId(child->GetPageId());
+      prev->SetHighKey(low_key);
+    }
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+  }
+  (*levels)[level - 1].prev_page_ = child_page;
+
+  if (levels->size() == level) {
+    levels->emplace_back();
+  }
+  auto page = (*levels)[level].page_;
+  if (page == nullptr || reinterpret_cast<InternalPage *>(page->GetData())->GetSize() == fill_size) {
+    if (page != nullptr) {
+      BulkLoadAppend(levels, level + 1, page, fill_size);
+    }
+
+    page_id_t page_id;
+    page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      BulkLoadAbort(levels);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    InternalPage *node = reinterpret_cast<InternalPage *>(page->GetData());
+    node->Init(page_id, INVALID_PAGE_ID, internal_max_size_, key_size_);
+    if (latch_mode_ == LatchMode::BLINK) {
+      node->SetNextPageId(INVALID_PAGE_ID);
+    }
+    (*levels)[level].page_ = page;
+  }
+
+  InternalPage *node = reinterpret_cast<InternalPage *>(page->GetData());
+  node->Append(low_key, child->GetPageId());
+  child->SetParentPageId(node->GetPageId());
+}
+
+/*
+ * Bring the last page of a level up to the min size, by merging it into the page before it if they fit into one page,
+ * and by moving pairs over from the page before it otherwise
+ * @return: true if the last page was merged and should be deleted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoadBalance(Page *prev_page, Page *page) {
+  BPlusTreePage *prev = reinterpret_cast<BPlusTreePage *>(prev_page->GetData());
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+
+  auto merge = prev->GetSize() + node->GetSize() < node->GetMaxSize();
+  if (node->IsLeafPage()) {
+    LeafPage *prev_leaf = reinterpret_cast<LeafPage *>(prev);
+    LeafPage *leaf = reinterpret_cast<LeafPage *>(node);
+    if (merge) {
+      leaf->MoveAllTo(prev_leaf);
+      return true;
+    }
+    while (prev_leaf->GetSize() > leaf->GetSize() + 1) {
+      prev_leaf->MoveLastToFrontOf(leaf);
+    }
+    return false;
+  }
+
+  InternalPage *prev_internal = reinterpret_cast<InternalPage *>(prev);
+  InternalPage *internal = reinterpret_cast<InternalPage *>(node);
+  if (merge) {
+    internal->MoveAllTo(prev_internal, internal->KeyAt(0), buffer_pool_manager_);
+    return true;
+  }
+  while (prev_internal->GetSize() > internal->GetSize() + 1) {
+    prev_internal->MoveLastToFrontOf(internal, internal->KeyAt(0), buffer_pool_manager_);
+  }
+  return false;
+}
+
+/*
+ * Unpin the pages of a bulk load that failed, the tree stays empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BulkLoadAbort(std::vector<BulkLoadLevel> *levels) {
+  for (auto &level : *levels) {
+    for (auto page : {level.page_, level.prev_page_}) {
+      if (page != nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      }
+    }
+  }
+  levels->clear();
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -263,23 +823,84 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * In OPTIMISTIC latch mode the delete is first tried with only the leaf write latched, and only redone
+ * pessimistically if the leaf would underflow.
+ * In BLINK latch mode the entry is only removed from its leaf.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  RemoveEntry(key, nullptr, transaction);
+}
+
+/*
+ * Delete a single key & value pair. Removing one of the values in a posting list leaves the leaf as it is, only
+ * removing the last value of a key removes its pair from the leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  RemoveEntry(key, &value, transaction);
+}
+
+/*
+ * @param   value         the value to remove, nullptr to remove the key with all of its values
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, const ValueType *value, Transaction *transaction) {
   if (IsEmpty()) {
     return;
   }
 
+  if (latch_mode_ == LatchMode::BLINK) {
+    auto leaf_page = FindLeafPageBLink(key, Operation::DELETE);
+    LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    auto removal = CheckLeafRemoval(node, key, value);
+    RemoveFromLeaf(node, key, value, removal);
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), removal != LeafRemoval::NONE);
+    return;
+  }
+
+  if (latch_mode_ == LatchMode::OPTIMISTIC) {
+    auto leaf_page = FindLeafPageOptimistically(key);
+    // a concurrent remove emptied the tree
+    if (leaf_page == nullptr) {
+      return;
+    }
+    LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+
+    auto removal = CheckLeafRemoval(node, key, value);
+    // the root leaf may shrink down to one pair, the other leaves down to their min size
+    auto is_safe = node->IsRootPage() ? node->GetSize() > 1 : node->GetSize() > node->GetMinSize();
+
+    if (removal != LeafRemoval::PAIR || is_safe) {
+      RemoveFromLeaf(node, key, value, removal);
+      leaf_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), removal != LeafRemoval::NONE);
+      return;
+    }
+
+    // leaf would underflow, start over with the ancestors write latched
+    leaf_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+  }
+
   auto [leaf_page, is_root_page_id_latched] = FindLeafPageByOperation(key, Operation::DELETE, transaction);
+  // the tree was emptied since RemoveEntry checked, root_page_id_latch is held
+  if (leaf_page == nullptr) {
+    root_page_id_latch.unlock();
+    return;
+  }
   LeafPage *node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
 
-  if (node->GetSize() == node->RemoveAndDeleteRecord(key, comparator_)) {
+  auto removal = CheckLeafRemoval(node, key, value);
+  RemoveFromLeaf(node, key, value, removal);
+  if (removal != LeafRemoval::PAIR) {
     if (is_root_page_id_latched) {
       root_page_id_latch.unlock();
     }
     ClearTransactionPageSetAndUnpinEach(transaction);
     leaf_page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), false);
+    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), removal != LeafRemoval::NONE);
     return;
   }
 
@@ -309,12 +930,12 @@ template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, bool is_root_page_id_latched) {
   if (node->IsRootPage()) {
     auto root_should_delete = AdjustRoot(node, is_root_page_id_latched);
-    ClearTransactionPageSet(transaction);
+    ClearTransactionPageSetAndUnpinEach(transaction);
     return root_should_delete;
   }
 
   if (node->GetSize() >= node->GetMinSize()) {
-    ClearTransactionPageSet(transaction);
+    ClearTransactionPageSetAndUnpinEach(transaction);
     return false;
   }
 
@@ -330,7 +951,7 @@ bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, b
     // redistribute
     Redistribute(sibling_node, node, parent_node, idx, is_root_page_id_latched);
 
-    ClearTransactionPageSet(transaction);
+    ClearTransactionPageSetAndUnpinEach(transaction);
 
     buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
     sibling_page->WUnlatch();
@@ -380,6 +1001,9 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
     LeafPage *leaf_node = reinterpret_cast<LeafPage *>((*node));
     LeafPage *prev_leaf_node = reinterpret_cast<LeafPage *>((*neighbor_node));
     leaf_node->MoveAllTo(prev_leaf_node);
+    LinkNextLeafBack(prev_leaf_node, true);
+    // a reverse iterator holding on to the merged leaf sees that it is no longer linked in
+    leaf_node->SetNextPageId(INVALID_PAGE_ID);
   } else {
     InternalPage *internal_node = reinterpret_cast<InternalPage *>((*node));
     InternalPage *prev_internal_node = reinterpret_cast<InternalPage *>((*neighbor_node));
@@ -419,6 +1043,7 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node,
     } else {
       neighbor_leaf_node->MoveLastToFrontOf(leaf_node);
       parent->SetKeyAt(index, leaf_node->KeyAt(0));
+      leaf_shifts_right_++;
     }
   } else {
     InternalPage *internal_node = reinterpret_cast<InternalPage *>(node);
@@ -453,7 +1078,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node, bool is_root_page_
     BPlusTreePage *only_child_node = reinterpret_cast<BPlusTreePage *>(only_child_page->GetData());
     only_child_node->SetParentPageId(INVALID_PAGE_ID);
 
-    root_page_id_ = only_child_node->GetPageId();
+    root_page_id_.store(only_child_node->GetPageId());
 
     UpdateRootPageId(0);
     if (is_root_page_id_latched) {
@@ -465,10 +1090,197 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node, bool is_root_page_
   }
 
   // case 2: when you delete the last element in whole b+ tree
+  // the tree is empty from now on, writers that found it non-empty before find out under root_page_id_latch
+  auto root_should_delete = old_root_node->IsLeafPage() && old_root_node->GetSize() == 0;
+  if (root_should_delete) {
+    root_page_id_.store(INVALID_PAGE_ID);
+    UpdateRootPageId(0);
+  }
   if (is_root_page_id_latched) {
     root_page_id_latch.unlock();
   }
-  return old_root_node->IsLeafPage() && old_root_node->GetSize() == 0;
+  return root_should_delete;
+}
+
+/*****************************************************************************
+ * POSTING LISTS
+ *****************************************************************************/
+/*
+ * Decide what removing a pair does to the latched leaf holding its key, without changing anything yet
+ * @param   value         the value to remove, nullptr to remove the key with all of its values
+ */
+INDEX_TEMPLATE_ARGUMENTS
+typename BPLUSTREE_TYPE::LeafRemoval BPLUSTREE_TYPE::CheckLeafRemoval(LeafPage *leaf, const KeyType &key,
+                                                                      const ValueType *value) const {
+  ValueType v;
+  if (!leaf->Lookup(key, &v, comparator_)) {
+    return LeafRemoval::NONE;
+  }
+  if (value == nullptr) {
+    return LeafRemoval::PAIR;
+  }
+  if (!unique_keys_ && PostingPage::IsReference(v)) {
+    // a posting list holds two values at least, taking one away leaves the pair in place
+    return LeafRemoval::POSTING_LIST_VALUE;
+  }
+  return v == *value ? LeafRemoval::PAIR : LeafRemoval::NONE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveFromLeaf(LeafPage *leaf, const KeyType &key, const ValueType *value, LeafRemoval removal) {
+  if (removal == LeafRemoval::NONE) {
+    return;
+  }
+
+  auto index = leaf->KeyIndex(key, comparator_);
+  if (removal == LeafRemoval::POSTING_LIST_VALUE) {
+    PostingListRemove(leaf, index, *value);
+    return;
+  }
+
+  if (!unique_keys_ && PostingPage::IsReference(leaf->ValueAt(index))) {
+    PostingListFree(leaf->ValueAt(index));
+  }
+  leaf->RemoveAndDeleteRecord(key, comparator_);
+}
+
+/*
+ * Add a value to a key that is already in the write latched leaf. A key with a single value keeps it in the leaf,
+ * its second value moves both into a new posting list. Values are appended to the last page of the list.
+ * The same pair inserted twice is kept twice.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PostingListInsert(LeafPage *leaf, const KeyType &key, const ValueType &value) {
+  auto index = leaf->KeyIndex(key, comparator_);
+  auto leaf_value = leaf->ValueAt(index);
+
+  page_id_t page_id;
+  if (!PostingPage::IsReference(leaf_value)) {
+    auto page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    PostingPage *posting = reinterpret_cast<PostingPage *>(page->GetData());
+    posting->Init(page_id);
+    posting->Append(leaf_value);
+    posting->Append(value);
+    leaf->SetValueAt(index, PostingPage::Reference(page_id));
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    return;
+  }
+
+  auto first_page = buffer_pool_manager_->FetchPage(PostingPage::ReferencedPageId(leaf_value));
+  PostingPage *first = reinterpret_cast<PostingPage *>(first_page->GetData());
+  auto last_page = buffer_pool_manager_->FetchPage(first->GetLastPageId());
+  PostingPage *last = reinterpret_cast<PostingPage *>(last_page->GetData());
+
+  if (last->IsFull()) {
+    auto page = buffer_pool_manager_->NewPage(&page_id);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
+      buffer_pool_manager_->UnpinPage(first_page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    reinterpret_cast<PostingPage *>(page->GetData())->Init(page_id);
+    last->SetNextPageId(page_id);
+    first->SetLastPageId(page_id);
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+    last_page = page;
+    last = reinterpret_cast<PostingPage *>(page->GetData());
+  }
+  last->Append(value);
+
+  buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(first_page->GetPageId(), true);
+}
+
+/*
+ * Remove a value from the posting list of the pair at index in the write latched leaf. The last value of the list
+ * takes its place, so that all pages but the last stay full. A list left with a single value is turned back into a
+ * plain value in the leaf.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PostingListRemove(LeafPage *leaf, int index, const ValueType &value) {
+  std::vector<page_id_t> page_ids;
+  for (auto page_id = PostingPage::ReferencedPageId(leaf->ValueAt(index)); page_id != INVALID_PAGE_ID;) {
+    page_ids.push_back(page_id);
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    page_id = reinterpret_cast<PostingPage *>(page->GetData())->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+
+  Page *page = nullptr;
+  auto value_index = -1;
+  for (auto page_id : page_ids) {
+    page = buffer_pool_manager_->FetchPage(page_id);
+    value_index = reinterpret_cast<PostingPage *>(page->GetData())->ValueIndex(value);
+    if (value_index != -1) {
+      break;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+  }
+  if (value_index == -1) {
+    return;
+  }
+
+  auto last_page = buffer_pool_manager_->FetchPage(page_ids.back());
+  PostingPage *last = reinterpret_cast<PostingPage *>(last_page->GetData());
+  reinterpret_cast<PostingPage *>(page->GetData())->SetValueAt(value_index, last->ValueAt(last->GetSize() - 1));
+  last->RemoveLast();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+
+  if (last->GetSize() == 0) {
+    // the pages before it are full, so there are two values left at least
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
+    buffer_pool_manager_->DeletePage(last_page->GetPageId());
+    page_ids.pop_back();
+
+    auto prev_page = buffer_pool_manager_->FetchPage(page_ids.back());
+    reinterpret_cast<PostingPage *>(prev_page->GetData())->SetNextPageId(INVALID_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(prev_page->GetPageId(), true);
+    auto first_page = buffer_pool_manager_->FetchPage(page_ids.front());
+    reinterpret_cast<PostingPage *>(first_page->GetData())->SetLastPageId(page_ids.back());
+    buffer_pool_manager_->UnpinPage(first_page->GetPageId(), true);
+    return;
+  }
+
+  if (page_ids.size() == 1 && last->GetSize() == 1) {
+    leaf->SetValueAt(index, last->ValueAt(0));
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
+    buffer_pool_manager_->DeletePage(last_page->GetPageId());
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+}
+
+/*
+ * Append the values of the posting list a leaf value refers to, the leaf has to be latched
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PostingListCollect(const ValueType &reference, std::vector<ValueType> *result) const {
+  for (auto page_id = PostingPage::ReferencedPageId(reference); page_id != INVALID_PAGE_ID;) {
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    PostingPage *posting = reinterpret_cast<PostingPage *>(page->GetData());
+    for (int i = 0; i < posting->GetSize(); i++) {
+      result->push_back(posting->ValueAt(i));
+    }
+    page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+}
+
+/*
+ * Delete the pages of the posting list a leaf value refers to, the leaf has to be write latched
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::PostingListFree(const ValueType &reference) {
+  for (auto page_id = PostingPage::ReferencedPageId(reference); page_id != INVALID_PAGE_ID;) {
+    auto page = buffer_pool_manager_->FetchPage(page_id);
+    auto next_page_id = reinterpret_cast<PostingPage *>(page->GetData())->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
 }
 
 /*****************************************************************************
@@ -492,12 +1304,47 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
-  auto leaf_page = FindLeafPageByOperation(key, Operation::SEARCH).first;
+  auto leaf_page = latch_mode_ == LatchMode::BLINK ? FindLeafPageBLink(key, Operation::SEARCH)
+                                                   : FindLeafPageByOperation(key, Operation::SEARCH).first;
   LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
   auto idx = leaf_node->KeyIndex(key, comparator_);
   return INDEXITERATOR_TYPE(buffer_pool_manager_, leaf_page, idx);
 }
 
+/*
+ * Input parameters are the bounds of a range scan, either may be missing. A forward iterator starts at the first key
+ * within lower and ends after the last key within upper, a reverse iterator goes the other way. Both are run until
+ * isEnd(), they do not compare equal to end().
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const std::optional<KeyBound> &lower, const std::optional<KeyBound> &upper,
+                                         bool reverse) {
+  if (reverse) {
+    // the iterator moves onto the last key within upper itself
+    auto leaf_page = FindLeafPageBefore(upper.has_value() ? &*upper : nullptr);
+    return INDEXITERATOR_TYPE(this, &comparator_, buffer_pool_manager_, leaf_page, 0, lower, upper, true);
+  }
+
+  if (!lower.has_value()) {
+    auto leftmost_page = FindLeafPageByOperation(KeyType(), Operation::SEARCH, nullptr, true).first;
+    return INDEXITERATOR_TYPE(this, &comparator_, buffer_pool_manager_, leftmost_page, 0, lower, upper, false);
+  }
+
+  auto leaf_page = latch_mode_ == LatchMode::BLINK ? FindLeafPageBLink(lower->key_, Operation::SEARCH)
+                                                   : FindLeafPageByOperation(lower->key_, Operation::SEARCH).first;
+  auto idx = 0;
+  if (leaf_page != nullptr) {
+    LeafPage *leaf_node = reinterpret_cast<LeafPage *>(leaf_page->GetData());
+    idx = leaf_node->KeyIndex(lower->key_, comparator_);
+    // keys are unique within a leaf
+    if (!lower->inclusive_ && idx < leaf_node->GetSize() && comparator_(leaf_node->KeyAt(idx), lower->key_) == 0) {
+      idx++;
+    }
+  }
+  return INDEXITERATOR_TYPE(this, &comparator_, buffer_pool_manager_, leaf_page, idx, lower, upper, false);
+}
+
 /*
  * Input parameter is void, construct an index iterator representing the end
  * of the key/value pair in the leaf node
@@ -506,7 +1353,19 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() {
   auto rightmost_page = FindLeafPageByOperation(KeyType(), Operation::SEARCH, nullptr, false, true).first;
+  if (rightmost_page == nullptr) {
+    return INDEXITERATOR_TYPE(buffer_pool_manager_, nullptr);
+  }
   LeafPage *leaf_node = reinterpret_cast<LeafPage *>(rightmost_page->GetData());
+  // in a B-link tree the rightmost child may have been split without its parent knowing yet
+  while (leaf_node->GetNextPageId() != INVALID_PAGE_ID) {
+    auto next_page = buffer_pool_manager_->FetchPage(leaf_node->GetNextPageId());
+    next_page->RLatch();
+    rightmost_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(rightmost_page->GetPageId(), false);
+    rightmost_page = next_page;
+    leaf_node = reinterpret_cast<LeafPage *>(rightmost_page->GetData());
+  }
   return INDEXITERATOR_TYPE(buffer_pool_manager_, rightmost_page, leaf_node->GetSize());
 }
 
@@ -528,16 +1387,25 @@ std::pair<Page *, bool> BPLUSTREE_TYPE::FindLeafPageByOperation(const KeyType &k
                                                                 bool rightMost) {
   assert(operation == Operation::SEARCH ? !(leftMost && rightMost) : transaction != nullptr);
 
-  root_page_id_latch.lock();
-  auto is_root_page_id_latched = true;
-  assert(root_page_id_ != INVALID_PAGE_ID);
-  auto page = buffer_pool_manager_->FetchPage(root_page_id_);
-  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  Page *page;
+  auto is_root_page_id_latched = false;
   if (operation == Operation::SEARCH) {
-    page->RLatch();
-    is_root_page_id_latched = false;
-    root_page_id_latch.unlock();
+    page = FetchRootPageForRead();
+    if (page == nullptr) {
+      return std::make_pair(nullptr, false);
+    }
   } else {
+    root_page_id_latch.lock();
+    is_root_page_id_latched = true;
+    // writers check IsEmpty() without root_page_id_latch, the tree may have been emptied since, tell them with the
+    // latch still held
+    if (root_page_id_.load() == INVALID_PAGE_ID) {
+      return std::make_pair(nullptr, true);
+    }
+    page = buffer_pool_manager_->FetchPage(root_page_id_.load());
+  }
+  BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (operation != Operation::SEARCH) {
     page->WLatch();
     if ((operation == Operation::INSERT && node->GetSize() < node->GetMaxSize() - 1) ||
         (operation == Operation::DELETE && node->GetSize() > 2)) {
@@ -599,8 +1467,241 @@ std::pair<Page *, bool> BPLUSTREE_TYPE::FindLeafPageByOperation(const KeyType &k
   return std::make_pair(page, is_root_page_id_latched);
 }
 
+/*
+ * Find the leaf page containing key for an optimistic insert or delete. Internal pages are read latched like in a
+ * search, only the leaf is write latched. Optimistic writers never modify internal pages, so the read latch on the
+ * parent keeps the leaf from being split or merged while its read latch is traded for the write latch.
+ * @return : the pinned, write latched leaf page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageOptimistically(const KeyType &key) {
+  Page *page;
+  BPlusTreePage *node;
+  while (true) {
+    page = FetchRootPageForRead();
+    // IsEmpty() was checked without a latch, a concurrent remove may have emptied the tree since
+    if (page == nullptr) {
+      return nullptr;
+    }
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (!node->IsLeafPage()) {
+      break;
+    }
+
+    // nothing keeps a root leaf in place while its read latch is traded, so check that it is still the root after
+    page->RUnlatch();
+    page->WLatch();
+    if (root_page_id_.load() == page->GetPageId()) {
+      return page;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+
+  while (!node->IsLeafPage()) {
+    InternalPage *i_node = reinterpret_cast<InternalPage *>(node);
+    auto child_page = buffer_pool_manager_->FetchPage(i_node->Lookup(key, comparator_));
+    auto child_node = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+
+    child_page->RLatch();
+    if (child_node->IsLeafPage()) {
+      child_page->RUnlatch();
+      child_page->WLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+    page = child_page;
+    node = child_node;
+  }
+
+  return page;
+}
+
+/*
+ * Find the leaf page covering key in a B-link tree, holding one latch at a time. A page split after its parent was
+ * read has handed the keys from its high key on to its right sibling, so a search landing on it moves right.
+ * @param   operation     SEARCH read latches the leaf, INSERT and DELETE write latch it
+ * @param   path          if not nullptr, gets the internal pages the search went down from, from the root
+ * @return : the pinned, latched leaf page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBLink(const KeyType &key, Operation operation, std::vector<page_id_t> *path) {
+  auto page = FetchRootPageForRead();
+  if (page == nullptr) {
+    return nullptr;
+  }
+
+  while (true) {
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      auto exclusive = operation != Operation::SEARCH;
+      // the leaf may be split while its latch is traded, moving right takes care of that
+      if (exclusive) {
+        page->RUnlatch();
+        page->WLatch();
+      }
+      return MoveRightBLink<LeafPage>(page, key, exclusive);
+    }
+
+    page = MoveRightBLink<InternalPage>(page, key, false);
+    InternalPage *i_node = reinterpret_cast<InternalPage *>(page->GetData());
+    if (path != nullptr) {
+      path->push_back(page->GetPageId());
+    }
+
+    auto child_page_id = i_node->Lookup(key, comparator_);
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = buffer_pool_manager_->FetchPage(child_page_id);
+    page->RLatch();
+  }
+}
+
+/*
+ * Follow the right links of a B-link tree page until reaching the page whose high key is above key.
+ * @param   page          a latched page of type N
+ * @param   exclusive     whether the pages are write latched, otherwise read latched
+ * @return : the pinned, latched page covering key, the pages passed are released
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+Page *BPLUSTREE_TYPE::MoveRightBLink(Page *page, const KeyType &key, bool exclusive) {
+  N *node = reinterpret_cast<N *>(page->GetData());
+  while (node->GetNextPageId() != INVALID_PAGE_ID && comparator_(key, node->GetHighKey()) >= 0) {
+    auto next_page_id = node->GetNextPageId();
+    if (exclusive) {
+      page->WUnlatch();
+    } else {
+      page->RUnlatch();
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+
+    page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (exclusive) {
+      page->WLatch();
+    } else {
+      page->RLatch();
+    }
+    node = reinterpret_cast<N *>(page->GetData());
+  }
+  return page;
+}
+
+/*
+ * Find the leaf page holding the last keys within bound, the rightmost leaf page if bound is nullptr. The pages are
+ * read latched top down like in a search. In a B-link tree the search moves right past pages that were split under it
+ * as long as the right sibling may hold keys within bound.
+ * A separator stays behind when the first keys of its subtree are removed, so the leaf found may hold no keys within
+ * bound. Unless leaves are only ever split, as in a B-link tree, the search then starts over for the keys before the
+ * deepest separator passed, which lie left of the subtree it leads to.
+ * @return : the pinned, read latched leaf page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBefore(const KeyBound *bound) {
+  auto page = FetchRootPageForRead();
+  if (page == nullptr) {
+    return nullptr;
+  }
+
+  std::optional<KeyType> separator;
+  while (true) {
+    BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (latch_mode_ == LatchMode::BLINK) {
+      page = node->IsLeafPage() ? MoveRightBeforeBLink<LeafPage>(page, bound)
+                                : MoveRightBeforeBLink<InternalPage>(page, bound);
+      node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    }
+    if (node->IsLeafPage()) {
+      LeafPage *leaf_node = reinterpret_cast<LeafPage *>(node);
+      if (latch_mode_ == LatchMode::BLINK || bound == nullptr || !separator.has_value()) {
+        return page;
+      }
+      auto cmp = leaf_node->GetSize() == 0 ? 1 : comparator_(leaf_node->KeyAt(0), bound->key_);
+      if (cmp < 0 || (cmp == 0 && bound->inclusive_)) {
+        return page;
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      KeyBound before_separator{*separator, false};
+      return FindLeafPageBefore(&before_separator);
+    }
+
+    InternalPage *i_node = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id;
+    if (bound == nullptr) {
+      child_page_id = i_node->ValueAt(i_node->GetSize() - 1);
+    } else if (bound->inclusive_) {
+      child_page_id = i_node->Lookup(bound->key_, comparator_);
+    } else {
+      child_page_id = i_node->LookupBefore(bound->key_, comparator_);
+    }
+    auto child_idx = i_node->ValueIndex(child_page_id);
+    if (child_idx > 0) {
+      separator = i_node->KeyAt(child_idx);
+    }
+
+    auto child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+  }
+}
+
+/*
+ * Follow the right links of a read latched B-link tree page while the right sibling may hold keys within bound, all
+ * the way right if bound is nullptr.
+ * @return : the pinned, read latched page, the pages passed are released
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+Page *BPLUSTREE_TYPE::MoveRightBeforeBLink(Page *page, const KeyBound *bound) {
+  N *node = reinterpret_cast<N *>(page->GetData());
+  while (node->GetNextPageId() != INVALID_PAGE_ID) {
+    if (bound != nullptr) {
+      auto cmp = comparator_(node->GetHighKey(), bound->key_);
+      if (cmp > 0 || (cmp == 0 && !bound->inclusive_)) {
+        break;
+      }
+    }
+    auto next_page_id = node->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = buffer_pool_manager_->FetchPage(next_page_id);
+    page->RLatch();
+    node = reinterpret_cast<N *>(page->GetData());
+  }
+  return page;
+}
+
+/*
+ * Fetch and read latch the root page without taking root_page_id_latch. The root only changes while its writer holds
+ * the write latch on the old root, so if root_page_id_ still names the page once it is latched, it is the root and
+ * stays the root until it is unlatched. Otherwise the reader raced with a root split or collapse and tries again.
+ * @return : the pinned, read latched root page, nullptr if the tree is empty
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchRootPageForRead() {
+  while (true) {
+    page_id_t root_page_id = root_page_id_.load();
+    if (root_page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+
+    auto page = buffer_pool_manager_->FetchPage(root_page_id);
+    page->RLatch();
+    if (root_page_id_.load() == root_page_id) {
+      return page;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(root_page_id, false);
+  }
+}
+
 /**
  * Clear all page sets of transaction and unpin each page
+ * The pages that are modified are fetched again for that and unpinned dirty through their own pin.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::ClearTransactionPageSetAndUnpinEach(Transaction *transaction) const {
@@ -612,16 +1713,6 @@ void BPLUSTREE_TYPE::ClearTransactionPageSetAndUnpinEach(Transaction *transactio
   transaction->GetPageSet()->clear();
 }
 
-/**
- * Clear all page sets of transaction
- */
-INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::ClearTransactionPageSet(Transaction *transaction) const {
-  std::for_each(transaction->GetPageSet()->begin(), transaction->GetPageSet()->end(),
-                [](Page *page) { page->WUnlatch(); });
-  transaction->GetPageSet()->clear();
-}
-
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -802,5 +1893,9 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<IntegerKey, RID, IntegerComparator>;
+template class BPlusTree<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTree<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTree<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
@@ -11,21 +11,41 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+
 namespace bustub {
+/*
+ * The number of leading bytes of a key the pages store. SetFromKey copies the key tuple into the key and zeroes the
+ * rest, a tuple of inlined columns takes the length of the key schema. A normalized key takes the length of its
+ * encoding instead.
+ */
+template <typename KeyType>
+static int StoredKeySize(const Schema *key_schema, bool truncate_keys) {
+  if (!truncate_keys || !key_schema->IsInlined()) {
+    return sizeof(KeyType);
+  }
+  uint32_t length = IsNormalizedKey<KeyType>::value ? NormalizedKeyLength(key_schema) : key_schema->GetLength();
+  return std::min(static_cast<int>(length), static_cast<int>(sizeof(KeyType)));
+}
+
 /*
  * Constructor
  */
 INDEX_TEMPLATE_ARGUMENTS
-BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
+BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager,
+                                     LatchMode latch_mode, bool unique_keys, bool truncate_keys)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_,
+                 TRUNCATED_LEAF_PAGE_SIZE(StoredKeySize<KeyType>(metadata->GetKeySchema(), truncate_keys)),
+                 TRUNCATED_INTERNAL_PAGE_SIZE(StoredKeySize<KeyType>(metadata->GetKeySchema(), truncate_keys)),
+                 latch_mode, unique_keys, StoredKeySize<KeyType>(metadata->GetKeySchema(), truncate_keys)) {}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(&index_key, key);
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,33 +54,70 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(&index_key, key);
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(&index_key, key);
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                                    Transaction *transaction) {
+  // construct scan index keys
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    SetIndexKey(&index_keys[i], keys[i]);
+  }
+
+  container_.GetValues(index_keys, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  return container_.BulkLoad(next, fill_factor);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) { return container_.Begin(key); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const std::optional<IndexKeyBound<KeyType>> &lower,
+                                                          const std::optional<IndexKeyBound<KeyType>> &upper,
+                                                          bool reverse) {
+  return container_.Begin(lower, upper, reverse);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SetIndexKey(KeyType *index_key, const Tuple &key) const {
+  if constexpr (IsNormalizedKey<KeyType>::value) {
+    index_key->SetFromKey(key, GetKeySchema());
+  } else {
+    index_key->SetFromKey(key);
+  }
+}
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<IntegerKey, RID, IntegerComparator>;
+template class BPlusTreeIndex<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeIndex<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeIndex<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 
 }  // namespace bustub
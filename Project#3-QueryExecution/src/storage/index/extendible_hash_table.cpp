@@ -0,0 +1,485 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/index/extendible_hash_table.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/extendible_hash_table.h"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+HASH_TABLE_TYPE::ExtendibleHashTable(std::string name, BufferPoolManager *buffer_pool_manager)
+    : index_name_(std::move(name)), buffer_pool_manager_(buffer_pool_manager) {
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(&bucket_page_id);
+  if (bucket_page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  reinterpret_cast<BucketPage *>(bucket_page->GetData())->Init();
+
+  Page *directory_page = buffer_pool_manager_->NewPage(&directory_page_id_);
+  if (directory_page == nullptr) {
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+  }
+  auto *directory = reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData());
+  directory->Init(directory_page_id_);
+  directory->SetBucketPageId(0, bucket_page_id);
+
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+/*
+ * The hash of the bytes of a key. Keys set from equal tuples have equal bytes, the directory uses the low bits.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t HASH_TABLE_TYPE::Hash(const KeyType &key) const {
+  return static_cast<uint32_t>(
+      std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char *>(&key), sizeof(KeyType))));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename HASH_TABLE_TYPE::BucketPage *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  return reinterpret_cast<BucketPage *>(buffer_pool_manager_->FetchPage(bucket_page_id)->GetData());
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+/*
+ * Return the values associated with the input key
+ * This method is used for point query
+ * @return : true means key exists
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  page_id_t bucket_page_id = directory->GetBucketPageId(Hash(key) & directory->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->RLatch();
+  auto *bucket = reinterpret_cast<BucketPage *>(page->GetData());
+  bool found = bucket->GetValue(key, result);
+  for (page_id_t page_id = bucket->GetNextPageId(); page_id != INVALID_PAGE_ID;) {
+    BucketPage *overflow = FetchBucketPage(page_id);
+    found = overflow->GetValue(key, result) || found;
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert the pair into the bucket of its key, false if the pair exists. If every page of the bucket is full, start
+ * over with the whole table latched and make room.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  page_id_t bucket_page_id = directory->GetBucketPageId(Hash(key) & directory->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  bool exists = false;
+  bool inserted = InsertIntoChain(reinterpret_cast<BucketPage *>(page->GetData()), key, value, &exists);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  table_latch_.RUnlock();
+
+  if (inserted || exists) {
+    return inserted;
+  }
+  return SplitInsert(key, value);
+}
+
+/*
+ * Check every page of the chain for the pair first, then insert into the first page with room
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::InsertIntoChain(BucketPage *first_page, const KeyType &key, const ValueType &value,
+                                      bool *exists) {
+  if (first_page->Contains(key, value)) {
+    *exists = true;
+    return false;
+  }
+  page_id_t room_page_id = INVALID_PAGE_ID;
+  for (page_id_t page_id = first_page->GetNextPageId(); page_id != INVALID_PAGE_ID;) {
+    BucketPage *overflow = FetchBucketPage(page_id);
+    if (overflow->Contains(key, value)) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      *exists = true;
+      return false;
+    }
+    if (room_page_id == INVALID_PAGE_ID && !overflow->IsFull()) {
+      room_page_id = page_id;
+    }
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+
+  if (!first_page->IsFull()) {
+    first_page->Insert(key, value);
+    return true;
+  }
+  if (room_page_id != INVALID_PAGE_ID) {
+    FetchBucketPage(room_page_id)->Insert(key, value);
+    buffer_pool_manager_->UnpinPage(room_page_id, true);
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Every page of the bucket of key is full. If some pair of the bucket differs from key in a hash bit the directory
+ * can still use, split the bucket by its next bit and try again, else the bucket would not split and overflows.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::SplitInsert(const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  uint32_t hash = Hash(key);
+  bool directory_dirty = false;
+  bool inserted = false;
+
+  while (true) {
+    uint32_t bucket_idx = hash & directory->GetGlobalDepthMask();
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    BucketPage *bucket = FetchBucketPage(bucket_page_id);
+    bool exists = false;
+    if (InsertIntoChain(bucket, key, value, &exists) || exists) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, !exists);
+      inserted = !exists;
+      break;
+    }
+
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    if (local_depth == DIRECTORY_MAX_DEPTH || !HashesDiffer(bucket, hash)) {
+      AddToChain(bucket, key, value);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+      inserted = true;
+      break;
+    }
+
+    page_id_t image_page_id;
+    Page *image_page = buffer_pool_manager_->NewPage(&image_page_id);
+    if (image_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+      table_latch_.WUnlock();
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    auto *image = reinterpret_cast<BucketPage *>(image_page->GetData());
+    image->Init();
+
+    if (local_depth == directory->GetGlobalDepth()) {
+      directory->IncrGlobalDepth();
+    }
+    // the entries of the bucket with the new bit set move to the image
+    uint32_t split_bit = 1U << local_depth;
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      if ((i & (split_bit - 1)) == (bucket_idx & (split_bit - 1))) {
+        directory->SetLocalDepth(i, local_depth + 1);
+        if ((i & split_bit) != 0) {
+          directory->SetBucketPageId(i, image_page_id);
+        }
+      }
+    }
+    directory_dirty = true;
+
+    std::vector<MappingType> items;
+    TakeChain(bucket, &items);
+    for (const auto &item : items) {
+      AddToChain((Hash(item.first) & split_bit) != 0 ? image : bucket, item.first, item.second);
+    }
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  }
+
+  buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+  table_latch_.WUnlock();
+  return inserted;
+}
+
+/*
+ * Whether a pair of the chain differs from hash in the bits the directory can use, which splitting would separate
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::HashesDiffer(BucketPage *first_page, uint32_t hash) {
+  uint32_t usable_mask = (1U << DIRECTORY_MAX_DEPTH) - 1;
+  auto differs = [&](BucketPage *bucket) {
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      if (((Hash(bucket->KeyAt(i)) ^ hash) & usable_mask) != 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  bool found = differs(first_page);
+  for (page_id_t page_id = first_page->GetNextPageId(); page_id != INVALID_PAGE_ID && !found;) {
+    BucketPage *overflow = FetchBucketPage(page_id);
+    found = differs(overflow);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return found;
+}
+
+/*
+ * Move all pairs of the chain into items, leaving the first page empty and deleting the others
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::TakeChain(BucketPage *first_page, std::vector<MappingType> *items) {
+  for (int i = 0; i < first_page->GetSize(); i++) {
+    items->push_back(first_page->GetItem(i));
+  }
+  for (page_id_t page_id = first_page->GetNextPageId(); page_id != INVALID_PAGE_ID;) {
+    BucketPage *overflow = FetchBucketPage(page_id);
+    for (int i = 0; i < overflow->GetSize(); i++) {
+      items->push_back(overflow->GetItem(i));
+    }
+    page_id_t next_page_id = overflow->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+  first_page->Init();
+}
+
+/*
+ * Insert into the last page of the chain, or into a new page after it if the last page is full. The pages before
+ * the last one are full as the chain is filled in order.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::AddToChain(BucketPage *first_page, const KeyType &key, const ValueType &value) {
+  page_id_t last_page_id = INVALID_PAGE_ID;
+  BucketPage *last_page = first_page;
+  while (last_page->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = last_page->GetNextPageId();
+    if (last_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(last_page_id, false);
+    }
+    last_page_id = next_page_id;
+    last_page = FetchBucketPage(last_page_id);
+  }
+
+  if (last_page->IsFull()) {
+    page_id_t overflow_page_id;
+    Page *overflow_page = buffer_pool_manager_->NewPage(&overflow_page_id);
+    if (overflow_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate new page");
+    }
+    last_page->SetNextPageId(overflow_page_id);
+    if (last_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(last_page_id, true);
+    }
+    last_page_id = overflow_page_id;
+    last_page = reinterpret_cast<BucketPage *>(overflow_page->GetData());
+    last_page->Init();
+  }
+  last_page->Insert(key, value);
+  if (last_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Remove the pair from the bucket of its key. A bucket left without pairs is merged with the whole table latched.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  table_latch_.RLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  uint32_t bucket_idx = Hash(key) & directory->GetGlobalDepthMask();
+  page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+  bool mergeable = directory->GetLocalDepth(bucket_idx) > 0;
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+
+  Page *page = buffer_pool_manager_->FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket = reinterpret_cast<BucketPage *>(page->GetData());
+  bool removed = RemoveFromChain(bucket, key, value);
+  bool empty = bucket->IsEmpty() && bucket->GetNextPageId() == INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  table_latch_.RUnlock();
+
+  if (removed && empty && mergeable) {
+    Merge(key);
+  }
+  return removed;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::RemoveFromChain(BucketPage *first_page, const KeyType &key, const ValueType &value) {
+  if (first_page->Remove(key, value)) {
+    return true;
+  }
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  BucketPage *prev_page = first_page;
+  bool removed = false;
+  for (page_id_t page_id = first_page->GetNextPageId(); page_id != INVALID_PAGE_ID;) {
+    BucketPage *overflow = FetchBucketPage(page_id);
+    page_id_t next_page_id = overflow->GetNextPageId();
+    if (overflow->Remove(key, value)) {
+      removed = true;
+      if (overflow->IsEmpty()) {
+        prev_page->SetNextPageId(next_page_id);
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        buffer_pool_manager_->DeletePage(page_id);
+      } else {
+        buffer_pool_manager_->UnpinPage(page_id, true);
+      }
+      break;
+    }
+    if (prev_page_id != INVALID_PAGE_ID) {
+      buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    }
+    prev_page_id = page_id;
+    prev_page = overflow;
+    page_id = next_page_id;
+  }
+  if (prev_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, removed);
+  }
+  return removed;
+}
+
+/*
+ * Fold the empty bucket of key into its split image, if the image has the same local depth, then halve the directory
+ * while it can. The merged bucket may be empty as well and merges again.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::Merge(const KeyType &key) {
+  table_latch_.WLock();
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  uint32_t hash = Hash(key);
+  bool directory_dirty = false;
+
+  while (true) {
+    uint32_t bucket_idx = hash & directory->GetGlobalDepthMask();
+    uint32_t local_depth = directory->GetLocalDepth(bucket_idx);
+    uint32_t image_idx = directory->GetSplitImageIndex(bucket_idx);
+    if (local_depth == 0 || directory->GetLocalDepth(image_idx) != local_depth) {
+      break;
+    }
+    page_id_t bucket_page_id = directory->GetBucketPageId(bucket_idx);
+    page_id_t image_page_id = directory->GetBucketPageId(image_idx);
+    BucketPage *bucket = FetchBucketPage(bucket_page_id);
+    bool empty = bucket->IsEmpty() && bucket->GetNextPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    if (!empty) {
+      break;
+    }
+
+    for (uint32_t i = 0; i < directory->Size(); i++) {
+      if (directory->GetBucketPageId(i) == bucket_page_id || directory->GetBucketPageId(i) == image_page_id) {
+        directory->SetBucketPageId(i, image_page_id);
+        directory->SetLocalDepth(i, local_depth - 1);
+      }
+    }
+    buffer_pool_manager_->DeletePage(bucket_page_id);
+    while (directory->CanShrink()) {
+      directory->DecrGlobalDepth();
+    }
+    directory_dirty = true;
+  }
+
+  buffer_pool_manager_->UnpinPage(directory_page_id_, directory_dirty);
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * UTILITIES AND DEBUG
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
+  table_latch_.RLock();
+  uint32_t global_depth = FetchDirectoryPage()->GetGlobalDepth();
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::VerifyIntegrity() {
+  HashTableDirectoryPage *directory = FetchDirectoryPage();
+  std::unordered_map<page_id_t, uint32_t> num_entries;
+  std::unordered_map<page_id_t, uint32_t> local_depths;
+  bool valid = true;
+  for (uint32_t i = 0; i < directory->Size() && valid; i++) {
+    page_id_t bucket_page_id = directory->GetBucketPageId(i);
+    uint32_t local_depth = directory->GetLocalDepth(i);
+    valid = local_depth <= directory->GetGlobalDepth() &&
+            local_depths.emplace(bucket_page_id, local_depth).first->second == local_depth;
+    if (num_entries[bucket_page_id]++ > 0 || !valid) {
+      continue;
+    }
+
+    // the pairs of the bucket hash to its entries, and the overflow pages are not empty
+    uint32_t local_mask = directory->GetLocalDepthMask(i);
+    for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID && valid;) {
+      BucketPage *bucket = FetchBucketPage(page_id);
+      valid = page_id == bucket_page_id || !bucket->IsEmpty();
+      for (int j = 0; j < bucket->GetSize(); j++) {
+        valid = valid && (Hash(bucket->KeyAt(j)) & local_mask) == (i & local_mask);
+      }
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+  for (const auto &[bucket_page_id, count] : num_entries) {
+    valid = valid && count == 1U << (directory->GetGlobalDepth() - local_depths[bucket_page_id]);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return valid;
+}
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
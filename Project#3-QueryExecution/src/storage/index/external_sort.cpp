@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.cpp
+//
+// Identification: src/storage/index/external_sort.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_sort.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::ExternalSort(const KeyComparator &comparator, size_t run_size)
+    : comparator_(comparator), run_size_(std::max<size_t>(run_size, 1)) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_SORT_TYPE::~ExternalSort() {
+  for (auto &run : runs_) {
+    fclose(run.file_);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::Add(const KeyType &key, const ValueType &value) {
+  assert(!merging_);
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() == run_size_) {
+    SpillRun();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::SpillRun() {
+  std::stable_sort(buffer_.begin(), buffer_.end(),
+                   [&](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+
+  // tmpfile is removed once it is closed
+  FILE *file = tmpfile();
+  if (file == nullptr || fwrite(buffer_.data(), sizeof(MappingType), buffer_.size(), file) != buffer_.size()) {
+    if (file != nullptr) {
+      fclose(file);
+    }
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot write sort run");
+  }
+  rewind(file);
+
+  runs_.push_back(Run{file, {}, 0});
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_SORT_TYPE::StartMerge() {
+  merging_ = true;
+  if (runs_.empty()) {
+    // everything fits into memory
+    std::stable_sort(buffer_.begin(), buffer_.end(),
+                     [&](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+    return;
+  }
+
+  if (!buffer_.empty()) {
+    SpillRun();
+  }
+  buffer_.shrink_to_fit();
+
+  auto run_after = [this](size_t a, size_t b) { return RunAfter(a, b); };
+  for (size_t i = 0; i < runs_.size(); i++) {
+    if (ReadBlock(&runs_[i])) {
+      heap_.push_back(i);
+      std::push_heap(heap_.begin(), heap_.end(), run_after);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORT_TYPE::ReadBlock(Run *run) {
+  run->block_.resize(BLOCK_SIZE);
+  auto read = fread(run->block_.data(), sizeof(MappingType), BLOCK_SIZE, run->file_);
+  run->block_.resize(read);
+  run->pos_ = 0;
+  return read > 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORT_TYPE::RunAfter(size_t a, size_t b) const {
+  const auto &run_a = runs_[a];
+  const auto &run_b = runs_[b];
+  auto cmp = comparator_(run_a.block_[run_a.pos_].first, run_b.block_[run_b.pos_].first);
+  // earlier runs hold the pairs that were added earlier
+  return cmp > 0 || (cmp == 0 && a > b);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_SORT_TYPE::Next(KeyType *key, ValueType *value) {
+  if (!merging_) {
+    StartMerge();
+  }
+
+  if (runs_.empty()) {
+    if (buffer_pos_ == buffer_.size()) {
+      return false;
+    }
+    *key = buffer_[buffer_pos_].first;
+    *value = buffer_[buffer_pos_].second;
+    buffer_pos_++;
+    return true;
+  }
+
+  if (heap_.empty()) {
+    return false;
+  }
+
+  auto run_after = [this](size_t a, size_t b) { return RunAfter(a, b); };
+  std::pop_heap(heap_.begin(), heap_.end(), run_after);
+  auto &run = runs_[heap_.back()];
+  *key = run.block_[run.pos_].first;
+  *value = run.block_[run.pos_].second;
+
+  run.pos_++;
+  if (run.pos_ < run.block_.size() || ReadBlock(&run)) {
+    std::push_heap(heap_.begin(), heap_.end(), run_after);
+  } else {
+    heap_.pop_back();
+  }
+  return true;
+}
+
+template class ExternalSort<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSort<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSort<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSort<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExternalSort<IntegerKey, RID, IntegerComparator>;
+template class ExternalSort<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class ExternalSort<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class ExternalSort<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
+}  // namespace bustub
@@ -1,8 +1,11 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -13,25 +16,93 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, Page *page, int idx)
-    : buffer_pool_manager_(bpm), page(page), idx(idx) {
+    : IndexIterator(nullptr, nullptr, bpm, page, idx, std::nullopt, std::nullopt, false) {}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(Tree *tree, const KeyComparator *comparator, BufferPoolManager *bpm, Page *page,
+                                  int idx, std::optional<KeyBound> lower, std::optional<KeyBound> upper, bool reverse)
+    : buffer_pool_manager_(bpm),
+      page(page),
+      idx(idx),
+      tree_(tree),
+      comparator_(comparator),
+      lower_(std::move(lower)),
+      upper_(std::move(upper)),
+      reverse_(reverse) {
+  if (page == nullptr) {
+    return;
+  }
   leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ReadAhead();
+  if (reverse_) {
+    SeekBefore(upper_);
+  } else {
+    SkipLeafEnd();
+  }
+  CheckBound();
+  ReadPostingList();
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+    : buffer_pool_manager_(other.buffer_pool_manager_),
+      page(std::exchange(other.page, nullptr)),
+      leaf(other.leaf),
+      idx(other.idx),
+      posting_values_(std::move(other.posting_values_)),
+      posting_idx_(other.posting_idx_),
+      item_(other.item_),
+      tree_(other.tree_),
+      comparator_(other.comparator_),
+      lower_(std::move(other.lower_)),
+      upper_(std::move(other.upper_)),
+      reverse_(other.reverse_) {}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() {
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::isEnd() { return leaf->GetNextPageId() == INVALID_PAGE_ID && idx == leaf->GetSize(); }
+bool INDEXITERATOR_TYPE::isEnd() {
+  return page == nullptr || (!reverse_ && leaf->GetNextPageId() == INVALID_PAGE_ID && idx == leaf->GetSize());
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { return leaf->GetItem(idx); }
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  if (!posting_values_.empty()) {
+    item_ = {leaf->KeyAt(idx), posting_values_[posting_idx_]};
+  } else {
+    item_ = leaf->GetItem(idx);
+  }
+  return item_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
-  if (idx == leaf->GetSize() - 1 && leaf->GetNextPageId() != INVALID_PAGE_ID) {
+  if (++posting_idx_ < posting_values_.size()) {
+    return *this;
+  }
+
+  if (reverse_) {
+    SeekBefore(KeyBound{leaf->KeyAt(idx), false});
+  } else {
+    idx++;
+    SkipLeafEnd();
+  }
+  CheckBound();
+  ReadPostingList();
+
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipLeafEnd() {
+  // B-link trees leave emptied leaves in the chain, a start key may also be past the last key of its leaf
+  while (idx == leaf->GetSize() && leaf->GetNextPageId() != INVALID_PAGE_ID) {
     auto next_page = buffer_pool_manager_->FetchPage(leaf->GetNextPageId());
 
     next_page->RLatch();
@@ -41,21 +112,144 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     page = next_page;
     leaf = reinterpret_cast<LeafPage *>(page->GetData());
     idx = 0;
+    ReadAhead();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SeekBefore(const std::optional<KeyBound> &bound) {
+  idx = LastIndexBefore(bound);
+  while (idx < 0) {
+    if (!StepLeft(bound)) {
+      Release();
+      return;
+    }
+    idx = LastIndexBefore(bound);
+  }
+}
+
+/*
+ * Leaves are latched left to right, like when moving forward, so the current leaf is released before the leaf to its
+ * left is latched. The prev page id is a hint only: writers do not latch a leaf under another parent to update it, so
+ * it may still name a leaf that was split or merged away since. If the leaf to the left no longer links to the current
+ * leaf once latched, or pairs were moved right from a leaf into its neighbor in between, the leaf to move to is looked
+ * up from the root instead.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool INDEXITERATOR_TYPE::StepLeft(const std::optional<KeyBound> &bound) {
+  auto prev_page_id = leaf->GetPrevPageId();
+  if (prev_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+
+  auto page_id = page->GetPageId();
+  auto leaf_shifts_right = tree_->GetLeafShiftsRight();
+  auto prev_page = buffer_pool_manager_->FetchPage(prev_page_id);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+
+  prev_page->RLatch();
+  LeafPage *prev_leaf = reinterpret_cast<LeafPage *>(prev_page->GetData());
+  if (prev_leaf->GetNextPageId() == page_id && tree_->GetLeafShiftsRight() == leaf_shifts_right) {
+    page = prev_page;
   } else {
-    idx++;
+    prev_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    page = tree_->FindLeafPageBefore(bound.has_value() ? &*bound : nullptr);
+    if (page == nullptr) {
+      return false;
+    }
   }
+  leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ReadAhead();
+  return true;
+}
 
-  return *this;
+INDEX_TEMPLATE_ARGUMENTS
+int INDEXITERATOR_TYPE::LastIndexBefore(const std::optional<KeyBound> &bound) const {
+  if (!bound.has_value()) {
+    return leaf->GetSize() - 1;
+  }
+  auto index = leaf->KeyIndex(bound->key_, *comparator_);
+  if (bound->inclusive_ && index < leaf->GetSize() && (*comparator_)(leaf->KeyAt(index), bound->key_) == 0) {
+    return index;
+  }
+  return index - 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::CheckBound() {
+  if (page == nullptr || idx == leaf->GetSize()) {
+    return;
+  }
+  const auto &bound = reverse_ ? lower_ : upper_;
+  if (!bound.has_value()) {
+    return;
+  }
+  auto cmp = (*comparator_)(leaf->KeyAt(idx), bound->key_);
+  if (reverse_) {
+    cmp = -cmp;
+  }
+  if (cmp > 0 || (cmp == 0 && !bound->inclusive_)) {
+    Release();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Release() {
+  if (page != nullptr) {
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  page = nullptr;
+  leaf = nullptr;
+  posting_values_.clear();
+  posting_idx_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadPostingList() {
+  posting_values_.clear();
+  posting_idx_ = 0;
+  if (page == nullptr || idx == leaf->GetSize() || !PostingPage::IsReference(leaf->ValueAt(idx))) {
+    return;
+  }
+
+  // the posting pages are only changed with the leaf write latched
+  for (auto page_id = PostingPage::ReferencedPageId(leaf->ValueAt(idx)); page_id != INVALID_PAGE_ID;) {
+    auto posting_page = buffer_pool_manager_->FetchPage(page_id);
+    PostingPage *posting = reinterpret_cast<PostingPage *>(posting_page->GetData());
+    for (int i = 0; i < posting->GetSize(); i++) {
+      posting_values_.push_back(posting->ValueAt(i));
+    }
+    page_id = posting->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(posting_page->GetPageId(), false);
+  }
+  if (reverse_) {
+    std::reverse(posting_values_.begin(), posting_values_.end());
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  // only the sibling links of the current leaf are known, so read-ahead is one leaf deep
+  auto neighbor_page_id = reverse_ ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+  if (neighbor_page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->Prefetch({neighbor_page_id});
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
-  return leaf->GetPageId() == itr.leaf->GetPageId() && idx == itr.idx;
+  if (page == nullptr || itr.page == nullptr) {
+    return page == itr.page;
+  }
+  return leaf->GetPageId() == itr.leaf->GetPageId() && idx == itr.idx && posting_idx_ == itr.posting_idx_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const {
-  return !(leaf->GetPageId() == itr.leaf->GetPageId() && idx == itr.idx);
+  return !(*this == itr);
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
@@ -68,4 +262,12 @@ template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class IndexIterator<IntegerKey, RID, IntegerComparator>;
+
+template class IndexIterator<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+
+template class IndexIterator<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+
+template class IndexIterator<NormalizedKey<64>, RID, NormalizedComparator<64>>;
+
 }  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// integer_key.cpp
+//
+// Identification: src/storage/index/integer_key.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/integer_key.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** Ranges of at most this many keys, four cache lines, are compared with the search key all at once. */
+constexpr int LINEAR_SEARCH_SIZE = 32;
+
+inline int64_t KeyAt(const char *keys, int index) {
+  int64_t key;
+  std::memcpy(&key, keys + index * sizeof(int64_t), sizeof(int64_t));
+  return key;
+}
+
+/*
+ * The number of keys less than key. The keys are sorted, so it is the index of the first one that is not.
+ */
+int CountLessScalar(const char *keys, int size, int64_t key) {
+  int count = 0;
+  for (int i = 0; i < size; i++) {
+    count += static_cast<int>(KeyAt(keys, i) < key);
+  }
+  return count;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) int CountLessAvx2(const char *keys, int size, int64_t key) {
+  const __m256i search_key = _mm256_set1_epi64x(key);
+  int count = 0;
+  int i = 0;
+  for (; i + 4 <= size; i += 4) {
+    __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * sizeof(int64_t)));
+    __m256i less = _mm256_cmpgt_epi64(search_key, block);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(less)));
+  }
+  return count + CountLessScalar(keys + i * sizeof(int64_t), size - i, key);
+}
+
+__attribute__((target("sse4.2"))) int CountLessSse42(const char *keys, int size, int64_t key) {
+  const __m128i search_key = _mm_set1_epi64x(key);
+  int count = 0;
+  int i = 0;
+  for (; i + 2 <= size; i += 2) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * sizeof(int64_t)));
+    __m128i less = _mm_cmpgt_epi64(search_key, block);
+    count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(less)));
+  }
+  return count + CountLessScalar(keys + i * sizeof(int64_t), size - i, key);
+}
+#endif
+
+using CountLessFunction = int (*)(const char *keys, int size, int64_t key);
+
+/*
+ * The widest compare the CPU runs, the binary is not built for a particular one
+ */
+CountLessFunction ChooseCountLess() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return CountLessAvx2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return CountLessSse42;
+  }
+#endif
+  return CountLessScalar;
+}
+
+}  // namespace
+
+int IntegerKeyLowerBound(const char *keys, int size, int64_t key) {
+  static const CountLessFunction count_less = ChooseCountLess();
+
+  int low = 0;
+  int high = size;
+  while (high - low > LINEAR_SEARCH_SIZE) {
+    int mid = low + (high - low) / 2;
+    if (KeyAt(keys, mid) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low + count_less(keys + low * sizeof(int64_t), high - low, key);
+}
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// normalized_key.cpp
+//
+// Identification: src/storage/index/normalized_key.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/normalized_key.h"
+
+#include "common/exception.h"
+#include "type/value.h"
+
+namespace bustub {
+
+namespace {
+
+/*
+ * Appends bytes to a key, dropping those past its size
+ */
+class KeyWriter {
+ public:
+  KeyWriter(char *data, size_t size) : data_(data), size_(size) {}
+
+  void Put(uint8_t byte) {
+    if (pos_ < size_) {
+      data_[pos_] = static_cast<char>(byte);
+    }
+    pos_++;
+  }
+
+  // the low width bytes of bits, most significant first
+  void PutBigEndian(uint64_t bits, int width) {
+    for (int i = width - 1; i >= 0; i--) {
+      Put(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+  }
+
+  size_t Length() const { return pos_; }
+
+  void ZeroRest() {
+    if (pos_ < size_) {
+      std::memset(data_ + pos_, 0, size_ - pos_);
+    }
+  }
+
+ private:
+  char *data_;
+  size_t size_;
+  size_t pos_{0};
+};
+
+template <typename IntType>
+uint64_t FlipSign(IntType value) {
+  using UnsignedType = std::make_unsigned_t<IntType>;
+  return static_cast<UnsignedType>(value) ^ (UnsignedType{1} << (8 * sizeof(IntType) - 1));
+}
+
+uint64_t NormalizeDecimal(double value) {
+  // -0.0 equals 0.0
+  if (value == 0) {
+    value = 0;
+  }
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63);
+}
+
+}  // namespace
+
+size_t NormalizeKey(const Tuple &tuple, const Schema *key_schema, char *data, size_t size) {
+  KeyWriter writer(data, size);
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    const auto &column = key_schema->GetColumn(i);
+    Value value = tuple.GetValue(key_schema, i);
+    bool is_null = value.IsNull();
+    writer.Put(is_null ? 0 : 1);
+
+    switch (column.GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        writer.PutBigEndian(is_null ? 0 : FlipSign(value.GetAs<int8_t>()), sizeof(int8_t));
+        break;
+      case TypeId::SMALLINT:
+        writer.PutBigEndian(is_null ? 0 : FlipSign(value.GetAs<int16_t>()), sizeof(int16_t));
+        break;
+      case TypeId::INTEGER:
+        writer.PutBigEndian(is_null ? 0 : FlipSign(value.GetAs<int32_t>()), sizeof(int32_t));
+        break;
+      case TypeId::BIGINT:
+        writer.PutBigEndian(is_null ? 0 : FlipSign(value.GetAs<int64_t>()), sizeof(int64_t));
+        break;
+      case TypeId::TIMESTAMP:
+        writer.PutBigEndian(is_null ? 0 : value.GetAs<uint64_t>(), sizeof(uint64_t));
+        break;
+      case TypeId::DECIMAL:
+        writer.PutBigEndian(is_null ? 0 : NormalizeDecimal(value.GetAs<double>()), sizeof(double));
+        break;
+      case TypeId::VARCHAR:
+        if (is_null) {
+          break;
+        }
+        // the length counts the terminating '\0'
+        for (uint32_t j = 0; j + 1 < value.GetLength(); j++) {
+          auto byte = static_cast<uint8_t>(value.GetData()[j]);
+          writer.Put(byte);
+          if (byte == 0) {
+            writer.Put(0xFF);
+          }
+        }
+        writer.Put(0);
+        writer.Put(0);
+        break;
+      default:
+        throw Exception(ExceptionType::UNKNOWN_TYPE, "Cannot normalize a key column of this type");
+    }
+  }
+  writer.ZeroRest();
+  return writer.Length();
+}
+
+uint32_t NormalizedKeyLength(const Schema *key_schema) {
+  uint32_t length = 0;
+  for (const auto &column : key_schema->GetColumns()) {
+    length += 1 + column.GetFixedLength();
+  }
+  return length;
+}
+
+}  // namespace bustub
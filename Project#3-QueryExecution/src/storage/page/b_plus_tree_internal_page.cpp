@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 #include <sstream>
@@ -23,26 +24,92 @@ namespace bustub {
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * Including set page type, set current size, set page id, set parent id, set
+ * max page size and set the number of bytes stored of each key
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, int key_size) {
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetSize(0);
   SetPageId(page_id);
   SetParentPageId(parent_id);
   SetMaxSize(max_size);
+  key_size_ = key_size;
 }
+
+/*
+ * Helper method to get the number of leading bytes stored of each key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetKeySize() const { return key_size_; }
+
+/*
+ * Helper methods to find the pair at input "index", a truncated key followed by its value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotSize() const { return key_size_ + sizeof(ValueType); }
+
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotAt(int index) {
+  return reinterpret_cast<char *>(array) + index * SlotSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlotAt(int index) const {
+  return reinterpret_cast<const char *>(array) + index * SlotSize();
+}
+
+/*
+ * Helper methods to find the key and the value of the pair at input "index", apart if the keys are kept apart
+ */
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAddress(int index) {
+  return const_cast<char *>(static_cast<const BPlusTreeInternalPage *>(this)->KeyAddress(index));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAddress(int index) const {
+  if constexpr (SEPARATE_KEYS) {
+    return reinterpret_cast<const char *>(array) + index * sizeof(KeyType);
+  }
+  return SlotAt(index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAddress(int index) {
+  return const_cast<char *>(static_cast<const BPlusTreeInternalPage *>(this)->ValueAddress(index));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAddress(int index) const {
+  if constexpr (SEPARATE_KEYS) {
+    return reinterpret_cast<const char *>(array) + TRUNCATED_INTERNAL_PAGE_SIZE(sizeof(KeyType)) * sizeof(KeyType) +
+           index * sizeof(ValueType);
+  }
+  return SlotAt(index) + key_size_;
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const { return array[index].first; }
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
+  if constexpr (!SEPARATE_KEYS) {
+    if (key_size_ == sizeof(KeyType)) {
+      return array[index].first;
+    }
+  }
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, KeyAddress(index), key_size_);
+  return key;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  std::memcpy(KeyAddress(index), &key, key_size_);
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
@@ -50,16 +117,115 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { a
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
-  auto it = std::find_if(array, array + GetSize(), [&value](const auto &pair) { return pair.second == value; });
-  return std::distance(array, it);
+  int index = 0;
+  while (index < GetSize() && ValueAt(index) != value) {
+    index++;
+  }
+  return index;
 }
 
 /*
- * Helper method to get the value associated with input "index"(a.k.a array
+ * Helper methods to get/set the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return array[index].second; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  ValueType value;
+  std::memcpy(&value, ValueAddress(index), sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  std::memcpy(ValueAddress(index), &value, sizeof(ValueType));
+}
+
+/*
+ * Helper method to move {size} pairs starting at index from to index to, the ranges may overlap
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveItems(int from, int to, int size) {
+  if constexpr (SEPARATE_KEYS) {
+    std::memmove(KeyAddress(to), KeyAddress(from), size * sizeof(KeyType));
+    std::memmove(ValueAddress(to), ValueAddress(from), size * sizeof(ValueType));
+  } else {
+    std::memmove(SlotAt(to), SlotAt(from), size * SlotSize());
+  }
+}
+
+/*
+ * Helper methods to find the first index i from 1 on so that the key at i >= key, or > key for the upper bound
+ * Truncated keys are compared in a key that keeps its zero bytes past the key size between probes.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LowerBound(const KeyType &key, const KeyComparator &comparator) const {
+  if constexpr (SEPARATE_KEYS) {
+    return 1 + IntegerKeyLowerBound(KeyAddress(1), GetSize() - 1, key.ToInteger());
+  } else if (key_size_ == sizeof(KeyType)) {
+    auto k_it = std::lower_bound(array + 1, array + GetSize(), key,
+                                 [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
+    return std::distance(array, k_it);
+  }
+
+  KeyType slot_key;
+  std::memset(&slot_key, 0, sizeof(KeyType));
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    std::memcpy(&slot_key, SlotAt(mid), key_size_);
+    if (comparator(slot_key, key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::UpperBound(const KeyType &key, const KeyComparator &comparator) const {
+  if constexpr (SEPARATE_KEYS) {
+    // the first key greater than key is the first one not less than key + 1
+    return key.ToInteger() == INT64_MAX ? GetSize()
+                                        : 1 + IntegerKeyLowerBound(KeyAddress(1), GetSize() - 1, key.ToInteger() + 1);
+  } else if (key_size_ == sizeof(KeyType)) {
+    auto k_it = std::upper_bound(array + 1, array + GetSize(), key,
+                                 [&comparator](auto k, const auto &pair) { return comparator(k, pair.first) < 0; });
+    return std::distance(array, k_it);
+  }
+
+  KeyType slot_key;
+  std::memset(&slot_key, 0, sizeof(KeyType));
+  int low = 1;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    std::memcpy(&slot_key, SlotAt(mid), key_size_);
+    if (comparator(key, slot_key) >= 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+/*
+ * Helper methods to get/set the high key and the right link of a B-link tree page. They live in the pair at index
+ * max size, only B-link trees keep that pair free.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const { return ValueAt(GetMaxSize()); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { SetValueAt(GetMaxSize(), next_page_id); }
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const { return KeyAt(GetMaxSize()); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &key) { SetKeyAt(GetMaxSize(), key); }
 
 /*****************************************************************************
  * LOOKUP
@@ -71,18 +237,26 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return arra
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  auto k_it = std::lower_bound(array + 1, array + GetSize(), key,
-                               [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
+  auto index = LowerBound(key, comparator);
 
-  if (k_it == array + GetSize()) {
+  if (index == GetSize()) {
     return ValueAt(GetSize() - 1);
   }
 
-  if (comparator(k_it->first, key) == 0) {
-    return k_it->second;
+  if (comparator(KeyAt(index), key) == 0) {
+    return ValueAt(index);
   }
 
-  return std::prev(k_it)->second;
+  return ValueAt(index - 1);
+}
+
+/*
+ * Find and return the child pointer(page_id) which points to the child page
+ * that contains the keys right before input "key", the largest ones less than key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupBefore(const KeyType &key, const KeyComparator &comparator) const {
+  return ValueAt(LowerBound(key, comparator) - 1);
 }
 
 /*****************************************************************************
@@ -97,11 +271,45 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
-  array[0].second = old_value;
-  array[1].first = new_key;
-  array[1].second = new_value;
+  SetValueAt(0, old_value);
+  SetKeyAt(1, new_key);
+  SetValueAt(1, new_value);
   SetSize(2);
 }
+/*
+ * Insert new_key & new_value pair ordered by key
+ * Used by B-link trees, where the pair of the split node may have moved to a right sibling by the time the new pair
+ * is posted to the parent.
+ * @return:  new size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(const KeyType &new_key, const ValueType &new_value,
+                                           const KeyComparator &comparator) {
+  auto index = UpperBound(new_key, comparator);
+  MoveItems(index, index + 1, GetSize() - index);
+
+  SetKeyAt(index, new_key);
+  SetValueAt(index, new_value);
+
+  IncreaseSize(1);
+
+  return GetSize();
+}
+
+/*
+ * Append new_key & new_value pair after the last one
+ * Used by bulk loading, which fills pages in key order. The key of the first pair is not a separator, bulk loading
+ * keeps the low key of the page there.
+ * @return:  new size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &new_key, const ValueType &new_value) {
+  SetKeyAt(GetSize(), new_key);
+  SetValueAt(GetSize(), new_value);
+  IncreaseSize(1);
+  return GetSize();
+}
+
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -111,10 +319,10 @@ INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
   auto new_value_idx = ValueIndex(old_value) + 1;
-  std::move_backward(array + new_value_idx, array + GetSize(), array + GetSize() + 1);
+  MoveItems(new_value_idx, new_value_idx + 1, GetSize() - new_value_idx);
 
-  array[new_value_idx].first = new_key;
-  array[new_value_idx].second = new_value;
+  SetKeyAt(new_value_idx, new_key);
+  SetValueAt(new_value_idx, new_value);
 
   IncreaseSize(1);
 
@@ -136,18 +344,26 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient
   auto start_idx = GetMinSize();
   SetSize(start_idx);
 
-  recipient->CopyNFrom(array + start_idx, GetMaxSize() - start_idx, buffer_pool_manager);
+  recipient->CopyNFrom(this, start_idx, GetMaxSize() - start_idx, buffer_pool_manager);
 }
 
-/* Copy entries into me, starting from {items} and copy {size} entries.
+/* Copy entries into me, starting from index start_index of source and copy {size} entries. The source is a page of
+ * the same tree, with the same key size.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
+ * B-link trees do not keep parent page ids and pass no BufferPoolManager.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
-  std::copy(items, items + size, array + GetSize());
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(BPlusTreeInternalPage *source, int start_index, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
+  if constexpr (SEPARATE_KEYS) {
+    std::memcpy(KeyAddress(GetSize()), source->KeyAddress(start_index), size * sizeof(KeyType));
+    std::memcpy(ValueAddress(GetSize()), source->ValueAddress(start_index), size * sizeof(ValueType));
+  } else {
+    std::memcpy(SlotAt(GetSize()), source->SlotAt(start_index), size * SlotSize());
+  }
 
-  for (int i = 0; i < size; i++) {
+  for (int i = 0; buffer_pool_manager != nullptr && i < size; i++) {
     auto page = buffer_pool_manager->FetchPage(ValueAt(i + GetSize()));
     BPlusTreePage *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
     node->SetParentPageId(GetPageId());
@@ -167,7 +383,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
-  std::move(array + index + 1, array + GetSize(), array + index);
+  MoveItems(index + 1, index, GetSize() - index - 1);
   IncreaseSize(-1);
 }
 
@@ -194,7 +410,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                BufferPoolManager *buffer_pool_manager) {
   SetKeyAt(0, middle_key);
-  recipient->CopyNFrom(array, GetSize(), buffer_pool_manager);
+  recipient->CopyNFrom(this, 0, GetSize(), buffer_pool_manager);
   SetSize(0);
 }
 
@@ -213,10 +429,10 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                       BufferPoolManager *buffer_pool_manager) {
   SetKeyAt(0, middle_key);
-  auto first_item = array[0];
+  MappingType first_item{KeyAt(0), ValueAt(0)};
   recipient->CopyLastFrom(first_item, buffer_pool_manager);
 
-  std::move(array + 1, array + GetSize(), array);
+  MoveItems(1, 0, GetSize() - 1);
   IncreaseSize(-1);
 }
 
@@ -226,7 +442,8 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *rec
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  *(array + GetSize()) = pair;
+  SetKeyAt(GetSize(), pair.first);
+  SetValueAt(GetSize(), pair.second);
   IncreaseSize(1);
 
   auto page = buffer_pool_manager->FetchPage(pair.second);
@@ -245,7 +462,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
-  auto last_item = array[GetSize() - 1];
+  MappingType last_item{KeyAt(GetSize() - 1), ValueAt(GetSize() - 1)};
   recipient->SetKeyAt(0, middle_key);
   recipient->CopyFirstFrom(last_item, buffer_pool_manager);
 
@@ -258,8 +475,9 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *re
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {
-  std::move_backward(array, array + GetSize(), array + GetSize() + 1);
-  *array = pair;
+  MoveItems(0, 1, GetSize());
+  SetKeyAt(0, pair.first);
+  SetValueAt(0, pair.second);
   IncreaseSize(1);
 
   auto page = buffer_pool_manager->FetchPage(pair.second);
@@ -274,4 +492,8 @@ template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<IntegerKey, page_id_t, IntegerComparator>;
+template class BPlusTreeInternalPage<NormalizedKey<16>, page_id_t, NormalizedComparator<16>>;
+template class BPlusTreeInternalPage<NormalizedKey<32>, page_id_t, NormalizedComparator<32>>;
+template class BPlusTreeInternalPage<NormalizedKey<64>, page_id_t, NormalizedComparator<64>>;
 }  // namespace bustub
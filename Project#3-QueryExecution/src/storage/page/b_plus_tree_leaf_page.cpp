@@ -12,6 +12,7 @@
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <sstream>
 
@@ -27,16 +28,18 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id, set max size and set the number of bytes stored of each key
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, int key_size) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetPageId(page_id);
   SetParentPageId(parent_id);
   SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
   SetMaxSize(max_size);
+  key_size_ = key_size;
 }
 
 /**
@@ -48,16 +51,102 @@ page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_i
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/**
+ * Helper methods to set/get prev page id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
+/**
+ * Helper method to get the number of leading bytes stored of each key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetKeySize() const { return key_size_; }
+
+/*
+ * Helper methods to find the pair at input "index", a truncated key followed by its value
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::SlotSize() const { return key_size_ + sizeof(ValueType); }
+
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_LEAF_PAGE_TYPE::SlotAt(int index) { return reinterpret_cast<char *>(array) + index * SlotSize(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_LEAF_PAGE_TYPE::SlotAt(int index) const {
+  return reinterpret_cast<const char *>(array) + index * SlotSize();
+}
+
+/*
+ * Helper methods to find the key and the value of the pair at input "index", apart if the keys are kept apart
+ */
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAddress(int index) {
+  return const_cast<char *>(static_cast<const BPlusTreeLeafPage *>(this)->KeyAddress(index));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAddress(int index) const {
+  if constexpr (SEPARATE_KEYS) {
+    return reinterpret_cast<const char *>(array) + index * sizeof(KeyType);
+  }
+  return SlotAt(index);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+char *B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAddress(int index) {
+  return const_cast<char *>(static_cast<const BPlusTreeLeafPage *>(this)->ValueAddress(index));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const char *B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAddress(int index) const {
+  if constexpr (SEPARATE_KEYS) {
+    return reinterpret_cast<const char *>(array) + TRUNCATED_LEAF_PAGE_SIZE(sizeof(KeyType)) * sizeof(KeyType) +
+           index * sizeof(ValueType);
+  }
+  return SlotAt(index) + key_size_;
+}
+
+/*
+ * Helper method to find the first index i so that the key at i >= key
+ * Truncated keys are compared in a key that keeps its zero bytes past the key size between probes.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::LowerBound(const KeyType &key, const KeyComparator &comparator) const {
+  if constexpr (SEPARATE_KEYS) {
+    return IntegerKeyLowerBound(KeyAddress(0), GetSize(), key.ToInteger());
+  } else if (key_size_ == sizeof(KeyType)) {
+    auto k_it = std::lower_bound(array, array + GetSize(), key,
+                                 [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
+    return std::distance(array, k_it);
+  }
+
+  KeyType slot_key;
+  std::memset(&slot_key, 0, sizeof(KeyType));
+  int low = 0;
+  int high = GetSize();
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    std::memcpy(&slot_key, SlotAt(mid), key_size_);
+    if (comparator(slot_key, key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  auto k_it = std::lower_bound(array, array + GetSize(), key,
-                               [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
-
-  return std::distance(array, k_it);
+  return LowerBound(key, comparator);
 }
 
 /*
@@ -65,14 +154,73 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const { return array[index].first; }
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
+  if constexpr (!SEPARATE_KEYS) {
+    if (key_size_ == sizeof(KeyType)) {
+      return array[index].first;
+    }
+  }
+  KeyType key;
+  std::memset(&key, 0, sizeof(KeyType));
+  std::memcpy(&key, KeyAddress(index), key_size_);
+  return key;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  std::memcpy(KeyAddress(index), &key, key_size_);
+}
+
+/*
+ * Helper methods to get/set the value associated with input "index"(a.k.a array offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const {
+  ValueType value;
+  std::memcpy(&value, ValueAddress(index), sizeof(ValueType));
+  return value;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  std::memcpy(ValueAddress(index), &value, sizeof(ValueType));
+}
 
 /*
- * Helper method to find and return the key & value pair associated with input
+ * Helper methods to get/set the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) { return array[index]; }
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const { return {KeyAt(index), ValueAt(index)}; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetItem(int index, const MappingType &item) {
+  SetKeyAt(index, item.first);
+  SetValueAt(index, item.second);
+}
+
+/*
+ * Helper method to move {size} pairs starting at index from to index to, the ranges may overlap
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveItems(int from, int to, int size) {
+  if constexpr (SEPARATE_KEYS) {
+    std::memmove(KeyAddress(to), KeyAddress(from), size * sizeof(KeyType));
+    std::memmove(ValueAddress(to), ValueAddress(from), size * sizeof(ValueType));
+  } else {
+    std::memmove(SlotAt(to), SlotAt(from), size * SlotSize());
+  }
+}
+
+/*
+ * Helper methods to get/set the high key of a B-link tree page. It is the key of the pair at index max size, only
+ * B-link trees keep that pair free.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const { return KeyAt(GetMaxSize()); }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &key) { SetKeyAt(GetMaxSize(), key); }
 
 /*****************************************************************************
  * INSERTION
@@ -83,25 +231,14 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) { return array
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  auto k_it = std::lower_bound(array, array + GetSize(), key,
-                               [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
+  auto index = LowerBound(key, comparator);
 
-  if (k_it == array + GetSize()) {
-    k_it->first = key;
-    k_it->second = value;
-
-    IncreaseSize(1);
+  if (index < GetSize() && comparator(KeyAt(index), key) == 0) {
     return GetSize();
   }
 
-  if (comparator(k_it->first, key) == 0) {
-    return GetSize();
-  }
-
-  std::move_backward(k_it, array + GetSize(), array + GetSize() + 1);
-
-  k_it->first = key;
-  k_it->second = value;
+  MoveItems(index, index + 1, GetSize() - index);
+  SetItem(index, {key, value});
 
   IncreaseSize(1);
   return GetSize();
@@ -117,16 +254,22 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
   auto start_idx = GetMinSize();
   auto moved_size = GetMaxSize() - start_idx;
-  recipient->CopyNFrom(array + start_idx, moved_size);
+  recipient->CopyNFrom(this, start_idx, moved_size);
   IncreaseSize(-1 * moved_size);
 }
 
 /*
- * Copy starting from items, and copy {size} number of elements into me.
+ * Copy starting from index start_index of source, and copy {size} number of pairs into me. The source is a page of
+ * the same tree, with the same key size.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
-  std::copy(items, items + size, array + GetSize());
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(BPlusTreeLeafPage *source, int start_index, int size) {
+  if constexpr (SEPARATE_KEYS) {
+    std::memcpy(KeyAddress(GetSize()), source->KeyAddress(start_index), size * sizeof(KeyType));
+    std::memcpy(ValueAddress(GetSize()), source->ValueAddress(start_index), size * sizeof(ValueType));
+  } else {
+    std::memcpy(SlotAt(GetSize()), source->SlotAt(start_index), size * SlotSize());
+  }
   IncreaseSize(size);
 }
 
@@ -140,13 +283,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
-  auto k_it = std::lower_bound(array, array + GetSize(), key,
-                               [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
-  if (k_it == array + GetSize() || comparator(k_it->first, key) != 0) {
+  auto index = LowerBound(key, comparator);
+  if (index == GetSize() || comparator(KeyAt(index), key) != 0) {
     return false;
   }
 
-  *value = k_it->second;
+  *value = ValueAt(index);
   return true;
 }
 
@@ -161,13 +303,12 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
-  auto k_it = std::lower_bound(array, array + GetSize(), key,
-                               [&comparator](const auto &pair, auto k) { return comparator(pair.first, k) < 0; });
-  if (k_it == array + GetSize() || comparator(k_it->first, key) != 0) {
+  auto index = LowerBound(key, comparator);
+  if (index == GetSize() || comparator(KeyAt(index), key) != 0) {
     return GetSize();
   }
 
-  std::move(k_it + 1, array + GetSize(), k_it);
+  MoveItems(index + 1, index, GetSize() - index - 1);
   IncreaseSize(-1);
   return GetSize();
 }
@@ -181,7 +322,7 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
-  recipient->CopyNFrom(array, GetSize());
+  recipient->CopyNFrom(this, 0, GetSize());
   recipient->SetNextPageId(GetNextPageId());
   IncreaseSize(-1 * GetSize());
 }
@@ -195,7 +336,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
   auto first_item = GetItem(0);
-  std::move(array + 1, array + GetSize(), array);
+  MoveItems(1, 0, GetSize() - 1);
   IncreaseSize(-1);
 
   recipient->CopyLastFrom(first_item);
@@ -206,7 +347,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
-  *(array + GetSize()) = item;
+  SetItem(GetSize(), item);
   IncreaseSize(1);
 }
 
@@ -226,8 +367,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient)
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
-  std::move_backward(array, array + GetSize(), array + GetSize() + 1);
-  *array = item;
+  MoveItems(0, 1, GetSize());
+  SetItem(0, item);
   IncreaseSize(1);
 }
 
@@ -236,4 +377,8 @@ template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<IntegerKey, RID, IntegerComparator>;
+template class BPlusTreeLeafPage<NormalizedKey<16>, RID, NormalizedComparator<16>>;
+template class BPlusTreeLeafPage<NormalizedKey<32>, RID, NormalizedComparator<32>>;
+template class BPlusTreeLeafPage<NormalizedKey<64>, RID, NormalizedComparator<64>>;
 }  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/b_plus_tree_posting_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_posting_page.h"
+
+#include <algorithm>
+
+#include "common/rid.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+/**
+ * Init method after creating a new posting page, the page is the first and last page of its list
+ */
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Init(page_id_t page_id) {
+  next_page_id_ = INVALID_PAGE_ID;
+  last_page_id_ = page_id;
+  size_ = 0;
+}
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_POSTING_PAGE_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_POSTING_PAGE_TYPE::GetLastPageId() const {
+  return last_page_id_;
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::SetLastPageId(page_id_t last_page_id) {
+  last_page_id_ = last_page_id;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::GetSize() const {
+  return size_;
+}
+
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::GetMaxSize() const {
+  return (PAGE_SIZE - POSTING_PAGE_HEADER_SIZE) / sizeof(ValueType);
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_POSTING_PAGE_TYPE::IsFull() const {
+  return size_ == GetMaxSize();
+}
+
+template <typename ValueType>
+ValueType B_PLUS_TREE_POSTING_PAGE_TYPE::ValueAt(int index) const {
+  return array[index];
+}
+
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  array[index] = value;
+}
+
+/*
+ * Helper method to find the index of value
+ * @return : the index, -1 if the page does not hold value
+ */
+template <typename ValueType>
+int B_PLUS_TREE_POSTING_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  auto it = std::find(array, array + size_, value);
+  return it == array + size_ ? -1 : static_cast<int>(it - array);
+}
+
+/*****************************************************************************
+ * INSERTION AND DELETION
+ *****************************************************************************/
+template <typename ValueType>
+void B_PLUS_TREE_POSTING_PAGE_TYPE::Append(const ValueType &value) {
+  assert(!IsFull());
+  array[size_++] = value;
+}
+
+template <typename ValueType>
+ValueType B_PLUS_TREE_POSTING_PAGE_TYPE::RemoveLast() {
+  assert(size_ > 0);
+  return array[--size_];
+}
+
+/*****************************************************************************
+ * REFERENCES FROM LEAF PAGES
+ *****************************************************************************/
+template <typename ValueType>
+ValueType B_PLUS_TREE_POSTING_PAGE_TYPE::Reference(page_id_t page_id) {
+  return ValueType(page_id, POSTING_LIST_SLOT);
+}
+
+template <typename ValueType>
+bool B_PLUS_TREE_POSTING_PAGE_TYPE::IsReference(const ValueType &value) {
+  return value.GetSlotNum() == POSTING_LIST_SLOT;
+}
+
+template <typename ValueType>
+page_id_t B_PLUS_TREE_POSTING_PAGE_TYPE::ReferencedPageId(const ValueType &value) {
+  return value.GetPageId();
+}
+
+template class BPlusTreePostingPage<RID>;
+}  // namespace bustub
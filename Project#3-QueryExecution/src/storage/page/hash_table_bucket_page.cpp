@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         CMU-DB Project (15-445/645)
+//                         ***DO NO SHARE PUBLICLY***
+//
+// Identification: src/page/hash_table_bucket_page.cpp
+//
+// Copyright (c) 2018, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_bucket_page.h"
+
+#include <cassert>
+
+#include "common/rid.h"
+
+namespace bustub {
+
+/*****************************************************************************
+ * HELPER METHODS AND UTILITIES
+ *****************************************************************************/
+
+/**
+ * Init method after creating a new bucket page, the page is empty and ends its chain
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::Init() {
+  next_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t HASH_TABLE_BUCKET_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_TABLE_BUCKET_TYPE::GetSize() const {
+  return size_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_TABLE_BUCKET_TYPE::GetMaxSize() const {
+  return BUCKET_ARRAY_SIZE;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::IsFull() const {
+  return size_ == GetMaxSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::IsEmpty() const {
+  return size_ == 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(int index) const {
+  return array[index].first;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(int index) const {
+  return array[index].second;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &HASH_TABLE_BUCKET_TYPE::GetItem(int index) const {
+  return array[index];
+}
+
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result) const {
+  bool found = false;
+  for (int i = 0; i < size_; i++) {
+    if (KeyEquals(array[i].first, key)) {
+      result->push_back(array[i].second);
+      found = true;
+    }
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::Contains(const KeyType &key, const ValueType &value) const {
+  for (int i = 0; i < size_; i++) {
+    if (array[i].second == value && KeyEquals(array[i].first, key)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*****************************************************************************
+ * INSERTION AND REMOVAL
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::Insert(const KeyType &key, const ValueType &value) {
+  assert(!IsFull());
+  array[size_++] = MappingType(key, value);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_TYPE::Remove(const KeyType &key, const ValueType &value) {
+  for (int i = 0; i < size_; i++) {
+    if (array[i].second == value && KeyEquals(array[i].first, key)) {
+      RemoveAt(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(int index) {
+  assert(index < size_);
+  array[index] = array[--size_];
+}
+
+template class HashTableBucketPage<GenericKey<4>, RID, GenericComparator<4>>;
+template class HashTableBucketPage<GenericKey<8>, RID, GenericComparator<8>>;
+template class HashTableBucketPage<GenericKey<16>, RID, GenericComparator<16>>;
+template class HashTableBucketPage<GenericKey<32>, RID, GenericComparator<32>>;
+template class HashTableBucketPage<GenericKey<64>, RID, GenericComparator<64>>;
+}  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy_test.cpp
+//
+// Identification: test/buffer/buffer_access_strategy_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// number of pages in [first, last] that are resident in the buffer pool
+static int CountResident(BufferPoolManager *bpm, page_id_t first, page_id_t last) {
+  int resident = 0;
+  for (size_t i = 0; i < bpm->GetPoolSize(); i++) {
+    page_id_t page_id = bpm->GetPages()[i].GetPageId();
+    if (page_id >= first && page_id <= last) {
+      resident++;
+    }
+  }
+  return resident;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, ScanDoesNotFloodPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_table_pages = 20;
+  const page_id_t num_hot_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // pages [0, 20) are the table, pages [20, 25) are used by someone else
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_table_pages + num_hot_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  const page_id_t first_hot = num_table_pages;
+  const page_id_t last_hot = num_table_pages + num_hot_pages - 1;
+  EXPECT_EQ(num_hot_pages, CountResident(bpm, first_hot, last_hot));
+
+  // Scenario: a scan through a ring of two frames leaves the hot pages alone and reads correct data.
+  BufferAccessStrategy strategy(2);
+  char expected[PAGE_SIZE];
+  for (page_id_t i = 0; i < num_table_pages; ++i) {
+    auto *page = bpm->FetchPage(i, &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "%d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_hot_pages, CountResident(bpm, first_hot, last_hot));
+
+  // Scenario: a pinned ring frame is not recycled, the scan takes another frame instead.
+  auto *pinned = bpm->FetchPage(0, &strategy);
+  ASSERT_NE(nullptr, pinned);
+  auto *page = bpm->FetchPage(1, &strategy);
+  ASSERT_NE(nullptr, page);
+  EXPECT_NE(pinned, page);
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+
+  // Scenario: the same scan without a strategy pushes the hot pages out.
+  for (page_id_t i = 0; i < num_table_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(0, CountResident(bpm, first_hot, last_hot));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,105 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager_prefetch_test.cpp
+//
+// Identification: test/buffer/buffer_pool_manager_prefetch_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerPrefetchTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_pages = 20;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: prefetched pages can be fetched right away and hold the content from disk.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t i = 0; i < 5; ++i) {
+    page_ids.push_back(i);
+  }
+  bpm->Prefetch(page_ids);
+  char expected[PAGE_SIZE];
+  for (page_id_t page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "%d", page_id);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: prefetching resident pages, invalid pages or pages without a free frame does nothing.
+  std::vector<Page *> pinned;
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    pinned.push_back(bpm->FetchPage(i));
+    ASSERT_NE(nullptr, pinned.back());
+  }
+  bpm->Prefetch({0, INVALID_PAGE_ID, num_pages - 1});
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_EQ(1, pinned[i]->GetPinCount());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: read-ahead through a strategy stays in its ring, the pages that were resident before the scan keep
+  // all frames but the two of the ring.
+  const size_t ring_size = 2;
+  BufferAccessStrategy strategy(ring_size);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i, &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "%d", i);
+    EXPECT_EQ(0, strcmp(page->GetData(), expected));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    // like a sequential scan, read the next page ahead once done with this one
+    if (i + 1 < num_pages) {
+      bpm->Prefetch({i + 1}, &strategy);
+    }
+  }
+  size_t resident_from_before_scan = 0;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    if (bpm->GetPages()[i].GetPageId() < static_cast<page_id_t>(buffer_pool_size)) {
+      resident_from_before_scan++;
+    }
+  }
+  EXPECT_EQ(buffer_pool_size - ring_size, resident_from_before_scan);
+
+  // Scenario: destroying the buffer pool with prefetches in flight waits for them.
+  bpm->Prefetch({10, 11, 12, 13});
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+
+  delete disk_manager;
+}
+
+}  // namespace bustub
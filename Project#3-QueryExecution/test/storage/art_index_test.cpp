@@ -0,0 +1,323 @@
+/**
+ * art_index_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/art_index.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value.h"
+
+namespace bustub {
+
+static Tuple BigintKey(int64_t key, const Schema *key_schema) {
+  return Tuple({Value(TypeId::BIGINT, key)}, key_schema);
+}
+
+static std::vector<int64_t> ScanSlots(ArtIndex *index, const Schema *key_schema, std::optional<int64_t> lower,
+                                      bool lower_inclusive, std::optional<int64_t> upper, bool upper_inclusive) {
+  std::optional<ArtIndex::KeyBound> lower_bound;
+  std::optional<ArtIndex::KeyBound> upper_bound;
+  if (lower.has_value()) {
+    lower_bound = ArtIndex::KeyBound{BigintKey(*lower, key_schema), lower_inclusive};
+  }
+  if (upper.has_value()) {
+    upper_bound = ArtIndex::KeyBound{BigintKey(*upper, key_schema), upper_inclusive};
+  }
+  std::vector<RID> rids;
+  index->ScanRange(lower_bound, upper_bound, &rids);
+  std::vector<int64_t> slots;
+  for (const auto &rid : rids) {
+    // the slot of a key is the key cut to 32 bits
+    slots.push_back(static_cast<int32_t>(rid.GetSlotNum()));
+  }
+  return slots;
+}
+
+static std::vector<int64_t> Range(int64_t begin, int64_t end, int64_t step) {
+  std::vector<int64_t> keys;
+  for (int64_t key = begin; key <= end; key += step) {
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+TEST(ArtIndexTest, InsertScanDeleteTest) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  ArtIndex index(new IndexMetadata("foo_pk", "foo", schema, {0}));
+  const Schema *key_schema = index.GetKeySchema();
+  Transaction transaction(0);
+
+  // Scenario: keys spread over all bytes, inserted in random order, enough for every node type to grow.
+  std::vector<int64_t> keys = Range(-3000, 3000, 2);
+  for (int64_t key : {INT64_MIN + 1, int64_t{1} << 40, INT64_MAX}) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  for (auto key : keys) {
+    index.InsertEntry(BigintKey(key, key_schema), RID(0, static_cast<uint32_t>(key)), &transaction);
+  }
+  std::sort(keys.begin(), keys.end());
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index.ScanKey(BigintKey(key, key_schema), &rids, &transaction);
+    ASSERT_EQ(rids.size(), 1) << "key " << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), static_cast<uint32_t>(key));
+  }
+  rids.clear();
+  index.ScanKey(BigintKey(1, key_schema), &rids, &transaction);
+  EXPECT_TRUE(rids.empty());
+
+  // Scenario: range scans return keys in order, with bounds inclusive or not, on or between keys, or missing.
+  std::vector<int64_t> all_slots;
+  for (auto key : keys) {
+    all_slots.push_back(static_cast<int32_t>(key));
+  }
+  EXPECT_EQ(ScanSlots(&index, key_schema, std::nullopt, false, std::nullopt, false), all_slots);
+  EXPECT_EQ(ScanSlots(&index, key_schema, -10, true, 10, false), Range(-10, 8, 2));
+  EXPECT_EQ(ScanSlots(&index, key_schema, -10, false, 10, true), Range(-8, 10, 2));
+  EXPECT_EQ(ScanSlots(&index, key_schema, -11, false, 11, false), Range(-10, 10, 2));
+  EXPECT_EQ(ScanSlots(&index, key_schema, 2990, true, std::nullopt, false),
+            (std::vector<int64_t>{2990, 2992, 2994, 2996, 2998, 3000, 0, -1}));
+  EXPECT_EQ(ScanSlots(&index, key_schema, 5, true, 5, true).size(), 0);
+
+  // Scenario: a key takes every rid inserted with it, once, and loses them one by one.
+  index.InsertEntry(BigintKey(4, key_schema), RID(1, 4), &transaction);
+  index.InsertEntry(BigintKey(4, key_schema), RID(1, 4), &transaction);
+  rids.clear();
+  index.ScanKey(BigintKey(4, key_schema), &rids, &transaction);
+  EXPECT_EQ(rids, (std::vector<RID>{RID(0, 4), RID(1, 4)}));
+  index.DeleteEntry(BigintKey(4, key_schema), RID(0, 4), &transaction);
+  rids.clear();
+  index.ScanKey(BigintKey(4, key_schema), &rids, &transaction);
+  EXPECT_EQ(rids, (std::vector<RID>{RID(1, 4)}));
+
+  // Scenario: removing all keys but a few shrinks and collapses the nodes, the rest are still found in order.
+  for (auto key : keys) {
+    if (key % 1000 != 0) {
+      index.DeleteEntry(BigintKey(key, key_schema), RID(0, static_cast<uint32_t>(key)), &transaction);
+    }
+  }
+  index.DeleteEntry(BigintKey(4, key_schema), RID(1, 4), &transaction);
+  EXPECT_EQ(ScanSlots(&index, key_schema, std::nullopt, false, std::nullopt, false),
+            (std::vector<int64_t>{-3000, -2000, -1000, 0, 1000, 2000, 3000}));
+  for (auto key : keys) {
+    rids.clear();
+    index.ScanKey(BigintKey(key, key_schema), &rids, &transaction);
+    EXPECT_EQ(rids.size(), key % 1000 == 0 ? 1 : 0) << "key " << key;
+  }
+
+  delete schema;
+}
+
+TEST(ArtIndexTest, LongPrefixTest) {
+  Schema *schema = ParseCreateStatement("a varchar(64),b integer");
+  ArtIndex index(new IndexMetadata("foo_pk", "foo", schema, {0, 1}));
+  const Schema *key_schema = index.GetKeySchema();
+  Transaction transaction(0);
+
+  // Scenario: varchar keys that share paths longer than a node stores, branching at different depths, including
+  // strings that are prefixes of others and embedded zero bytes.
+  std::vector<std::string> strings;
+  std::vector<std::string> suffixes{"", "a", "ab", "b", std::string("\0", 1)};
+  for (const auto &suffix : suffixes) {
+    strings.push_back(std::string(20, 'x') + suffix);
+    strings.push_back(std::string(20, 'x') + "yyyyyyyyyyyy" + suffix);
+  }
+  strings.push_back(std::string(20, 'x') + std::string("\0z", 2));
+  strings.push_back("x");
+  strings.emplace_back();
+  std::vector<Tuple> tuples;
+  for (const auto &string : strings) {
+    for (int32_t b : {-1, 7}) {
+      tuples.emplace_back(std::vector<Value>{Value(TypeId::VARCHAR, string), Value(TypeId::INTEGER, b)}, key_schema);
+    }
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    index.InsertEntry(tuples[i], RID(0, i), &transaction);
+  }
+
+  std::vector<RID> rids;
+  for (size_t i = 0; i < tuples.size(); i++) {
+    rids.clear();
+    index.ScanKey(tuples[i], &rids, &transaction);
+    ASSERT_EQ(rids.size(), 1) << "key " << tuples[i].ToString(key_schema);
+    EXPECT_EQ(rids[0].GetSlotNum(), i);
+  }
+  rids.clear();
+  index.ScanKey(Tuple({Value(TypeId::VARCHAR, std::string(20, 'x') + "yyyy"), Value(TypeId::INTEGER, -1)}, key_schema),
+                &rids, &transaction);
+  EXPECT_TRUE(rids.empty());
+
+  // Scenario: removing keys collapses nodes into their children, whose merged paths still find the rest.
+  for (size_t i = 0; i < tuples.size(); i += 2) {
+    index.DeleteEntry(tuples[i], RID(0, i), &transaction);
+  }
+  for (size_t i = 0; i < tuples.size(); i++) {
+    rids.clear();
+    index.ScanKey(tuples[i], &rids, &transaction);
+    EXPECT_EQ(rids.size(), i % 2) << "key " << tuples[i].ToString(key_schema);
+  }
+  rids.clear();
+  EXPECT_EQ(index.ScanRange(std::nullopt, std::nullopt, &rids), tuples.size() / 2);
+
+  delete schema;
+}
+
+TEST(ArtIndexTest, ConcurrentInsertDeleteTest) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  ArtIndex index(new IndexMetadata("foo_pk", "foo", schema, {0}));
+  const Schema *key_schema = index.GetKeySchema();
+  const int64_t num_keys = 20000;
+  const int num_threads = 4;
+
+  // Scenario: threads insert disjoint keys, then delete half of them, while readers look up keys that are always in
+  // the index and scan ranges of them.
+  Transaction transaction(0);
+  for (int64_t key = 0; key < num_keys; key += 7) {
+    index.InsertEntry(BigintKey(-1 - key, key_schema), RID(1, key), &transaction);
+  }
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&, i]() {
+      std::mt19937_64 random(i);
+      std::vector<RID> rids;
+      while (!done) {
+        int64_t key = random() % num_keys / 7 * 7;
+        rids.clear();
+        index.ScanKey(BigintKey(-1 - key, key_schema), &rids, nullptr);
+        ASSERT_EQ(rids.size(), 1);
+        ASSERT_EQ(rids[0].GetSlotNum(), key);
+        rids.clear();
+        index.ScanRange(ArtIndex::KeyBound{BigintKey(-1 - key - 700, key_schema), false},
+                        ArtIndex::KeyBound{BigintKey(-1 - key, key_schema), true}, &rids);
+        ASSERT_EQ(rids.size(), std::min<int64_t>(100, (num_keys - 1 - key) / 7 + 1));
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int i = 0; i < num_threads; i++) {
+    writers.emplace_back([&, i]() {
+      std::vector<int64_t> keys;
+      for (int64_t key = i; key < num_keys; key += num_threads) {
+        keys.push_back(key);
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(i));
+      for (auto key : keys) {
+        index.InsertEntry(BigintKey(key, key_schema), RID(0, key), nullptr);
+      }
+      for (auto key : keys) {
+        if (key % 2 == 0) {
+          index.DeleteEntry(BigintKey(key, key_schema), RID(0, key), nullptr);
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    index.ScanKey(BigintKey(key, key_schema), &rids, &transaction);
+    EXPECT_EQ(rids.size(), key % 2) << "key " << key;
+  }
+  rids.clear();
+  EXPECT_EQ(index.ScanRange(ArtIndex::KeyBound{BigintKey(0, key_schema), true}, std::nullopt, &rids), num_keys / 2);
+  for (size_t i = 0; i < rids.size(); i++) {
+    EXPECT_EQ(rids[i].GetSlotNum(), 2 * i + 1);
+  }
+
+  delete schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Inserts then point lookups of random bigint keys through the Index interface, into the ART and into a B+ tree
+// index with every page cached, on 1 and 4 threads.
+static void InsertLookupBenchmark(const char *name, Index *index, const std::vector<int64_t> &keys, int num_threads) {
+  const Schema *key_schema = index->GetKeySchema();
+  auto run = [&](auto operation) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back([&, i]() {
+        Transaction transaction(i);
+        for (size_t j = i; j < keys.size(); j += num_threads) {
+          operation(keys[j], &transaction);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return keys.size() / elapsed.count();
+  };
+
+  double inserts = run([&](int64_t key, Transaction *transaction) {
+    index->InsertEntry(BigintKey(key, key_schema), RID(0, key), transaction);
+  });
+  std::atomic<size_t> num_found{0};
+  double lookups = run([&](int64_t key, Transaction *transaction) {
+    std::vector<RID> rids;
+    index->ScanKey(BigintKey(key, key_schema), &rids, transaction);
+    num_found += rids.size();
+  });
+  EXPECT_EQ(num_found, keys.size());
+  printf("%-12s threads=%d %10.0f inserts/s %10.0f lookups/s\n", name, num_threads, inserts, lookups);
+}
+
+TEST(ArtIndexTest, DISABLED_InsertLookupBenchmark) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  const int num_keys = 1000000;
+  std::vector<int64_t> keys;
+  std::mt19937_64 random(0);
+  for (int i = 0; i < num_keys; i++) {
+    keys.push_back(static_cast<int64_t>(random() >> 1));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  std::shuffle(keys.begin(), keys.end(), random);
+
+  for (int num_threads : {1, 4}) {
+    ArtIndex art_index(new IndexMetadata("foo_pk", "foo", schema, {0}));
+    InsertLookupBenchmark("ArtIndex", &art_index, keys, num_threads);
+
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50000, disk_manager);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    {
+      BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> b_plus_tree_index(
+          new IndexMetadata("foo_pk", "foo", schema, {0}), bpm);
+      InsertLookupBenchmark("BPlusTree", &b_plus_tree_index, keys, num_threads);
+    }
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+
+  delete schema;
+}
+
+}  // namespace bustub
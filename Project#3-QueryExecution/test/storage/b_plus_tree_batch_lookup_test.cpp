@@ -0,0 +1,218 @@
+/**
+ * b_plus_tree_batch_lookup_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// look up keys in one batch, and check that every even key in [2, max_key] is found
+static void CheckBatch(Tree *tree, const std::vector<int64_t> &keys, int64_t max_key) {
+  std::vector<GenericKey<8>> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromInteger(keys[i]);
+  }
+  std::vector<std::vector<RID>> results;
+  tree->GetValues(index_keys, &results);
+  ASSERT_EQ(results.size(), keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (keys[i] % 2 == 0 && keys[i] >= 2 && keys[i] <= max_key) {
+      ASSERT_EQ(results[i].size(), 1) << "key " << keys[i];
+      EXPECT_EQ(results[i][0].GetSlotNum(), keys[i]);
+    } else if (keys[i] % 2 == 0) {
+      EXPECT_TRUE(results[i].empty()) << "key " << keys[i];
+    }
+  }
+}
+
+TEST(BPlusTreeBatchLookupTest, BatchLookupTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t max_key = 2000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Scenario: nothing is found in an empty tree.
+    CheckBatch(&tree, {2, 4}, 0);
+
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    for (int64_t key = 2; key <= max_key; key += 2) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), &transaction);
+    }
+
+    // Scenario: an empty batch.
+    CheckBatch(&tree, {}, max_key);
+
+    // Scenario: batches of increasing sparseness, unordered, with duplicates and misses between and around the keys.
+    std::mt19937 random(0);
+    for (int64_t stride : {1, 3, 17, 501}) {
+      std::vector<int64_t> keys;
+      for (int64_t key = -1; key <= max_key + 2; key += stride) {
+        keys.push_back(key);
+      }
+      keys.push_back(keys[keys.size() / 2]);
+      std::shuffle(keys.begin(), keys.end(), random);
+      CheckBatch(&tree, keys, max_key);
+    }
+
+    // Scenario: odd keys are never in the tree.
+    std::vector<GenericKey<8>> odd_keys(1);
+    odd_keys[0].SetFromInteger(3);
+    std::vector<std::vector<RID>> results;
+    tree.GetValues(odd_keys, &results);
+    EXPECT_TRUE(results[0].empty());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeBatchLookupTest, ConcurrentBatchLookupTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t max_key = 4000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    for (int64_t key = 2; key <= max_key; key += 2) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), &transaction);
+    }
+
+    // Scenario: batches of even keys are found while odd keys are inserted and removed, splitting and merging the
+    // pages under the batches.
+    std::thread writer([&]() {
+      GenericKey<8> writer_key;
+      Transaction writer_transaction(1);
+      for (int round = 0; round < 3; round++) {
+        for (int64_t key = 1; key <= max_key; key += 2) {
+          writer_key.SetFromInteger(key);
+          tree.Insert(writer_key, RID(0, key), &writer_transaction);
+        }
+        for (int64_t key = 1; key <= max_key; key += 2) {
+          writer_key.SetFromInteger(key);
+          tree.Remove(writer_key, &writer_transaction);
+        }
+      }
+    });
+    std::mt19937 random(1);
+    for (int round = 0; round < 200; round++) {
+      std::vector<int64_t> keys(64);
+      for (auto &key : keys) {
+        key = 2 * static_cast<int64_t>(1 + random() % (max_key / 2));
+      }
+      CheckBatch(&tree, keys, max_key);
+    }
+    writer.join();
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Point lookups of GenericKey<8> keys in a fully cached tree, one GetValue per key against GetValues over batches of
+// random keys, and of keys from a narrow range like the probes of a join on a correlated column.
+TEST(BPlusTreeBatchLookupTest, DISABLED_BatchLookupBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1000000;
+  const int64_t num_lookups = 2000000;
+  // the default page sizes, LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE are only defined inside the page classes
+  const int leaf_max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int internal_max_size = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(8192, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  int64_t key = 0;
+  tree.BulkLoad([&](GenericKey<8> *index_key, RID *rid) {
+    if (key == num_keys) {
+      return false;
+    }
+    key++;
+    index_key->SetFromInteger(key);
+    rid->Set(0, key);
+    return true;
+  });
+
+  for (int64_t range : {num_keys, int64_t{10000}}) {
+    std::vector<GenericKey<8>> keys(num_lookups);
+    std::mt19937_64 random(0);
+    int64_t base = 0;
+    for (int64_t i = 0; i < num_lookups; i++) {
+      if (i % 1024 == 0) {
+        base = static_cast<int64_t>(random() % (num_keys - range + 1));
+      }
+      keys[i].SetFromInteger(1 + base + static_cast<int64_t>(random() % range));
+    }
+
+    for (size_t batch_size : {1, 16, 128, 1024}) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<RID> rids;
+      std::vector<GenericKey<8>> batch;
+      std::vector<std::vector<RID>> results;
+      for (int64_t i = 0; i < num_lookups; i += batch_size) {
+        if (batch_size == 1) {
+          rids.clear();
+          tree.GetValue(keys[i], &rids);
+        } else {
+          batch.assign(keys.begin() + i, keys.begin() + std::min<int64_t>(i + batch_size, num_lookups));
+          tree.GetValues(batch, &results);
+        }
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      printf("range=%-8ld batch=%-5lu %12.0f lookups/s\n", range, batch_size, num_lookups / elapsed.count());
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,253 @@
+/**
+ * b_plus_tree_bulk_load_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/external_sort.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using Sorter = ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+
+// bulk load the keys [1, num_keys], slot number = key
+static bool BulkLoadRange(Tree *tree, int64_t num_keys, double fill_factor) {
+  int64_t key = 0;
+  return tree->BulkLoad(
+      [&](GenericKey<8> *index_key, RID *rid) {
+        if (key == num_keys) {
+          return false;
+        }
+        key++;
+        index_key->SetFromInteger(key);
+        rid->Set(0, key);
+        return true;
+      },
+      fill_factor);
+}
+
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::BLINK}) {
+    for (auto fill_factor : {0.5, 0.75, 1.0}) {
+      // sizes around page boundaries: empty, a single leaf, a leaf and a bit, and many levels
+      for (int64_t num_keys : {0, 1, 4, 5, 6, 17, 1000}) {
+        DiskManager *disk_manager = new DiskManager("test.db");
+        BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+        Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+        page_id_t page_id;
+        auto header_page = bpm->NewPage(&page_id);
+        (void)header_page;
+
+        // Scenario: a bulk loaded tree holds exactly the loaded keys, in order.
+        ASSERT_TRUE(BulkLoadRange(&tree, num_keys, fill_factor));
+        EXPECT_EQ(tree.IsEmpty(), num_keys == 0);
+        // iterators need a root page
+        if (num_keys > 0) {
+          int64_t current_key = 1;
+          for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+            EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+            current_key++;
+          }
+          EXPECT_EQ(current_key, num_keys + 1);
+        }
+
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        for (int64_t key = 0; key <= num_keys + 1; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          EXPECT_EQ(tree.GetValue(index_key, &rids), key >= 1 && key <= num_keys) << "key " << key;
+        }
+
+        // Scenario: a tree that is not empty is not bulk loaded again.
+        if (num_keys > 0) {
+          EXPECT_FALSE(BulkLoadRange(&tree, num_keys, fill_factor));
+        }
+
+        // Scenario: the tree is a regular tree, inserts split and deletes merge its bulk loaded pages.
+        Transaction transaction(0);
+        for (int64_t key = num_keys + 1; key <= num_keys + 20; key++) {
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.Insert(index_key, RID(0, key), &transaction));
+        }
+        for (int64_t key = 1; key <= num_keys + 20; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.GetValue(index_key, &rids)) << "key " << key;
+          tree.Remove(index_key, &transaction);
+        }
+        for (int64_t key = 1; key <= num_keys + 20; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          EXPECT_FALSE(tree.GetValue(index_key, &rids)) << "key " << key;
+        }
+        EXPECT_TRUE(tree.begin() == tree.end());
+
+        bpm->UnpinPage(HEADER_PAGE_ID, true);
+        delete disk_manager;
+        delete bpm;
+        remove("test.db");
+        remove("test.log");
+      }
+    }
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeBulkLoadTest, UnsortedInputTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 5, 5);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Scenario: duplicate keys keep the first pair, out of order keys throw and leave the tree empty.
+  std::vector<int64_t> keys = {1, 2, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 1};
+  size_t pos = 0;
+  auto next = [&](GenericKey<8> *index_key, RID *rid) {
+    if (pos == keys.size()) {
+      return false;
+    }
+    index_key->SetFromInteger(keys[pos]);
+    rid->Set(0, static_cast<uint32_t>(pos));
+    pos++;
+    return true;
+  };
+  EXPECT_THROW(tree.BulkLoad(next), Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  keys.pop_back();
+  pos = 0;
+  EXPECT_TRUE(tree.BulkLoad(next));
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  index_key.SetFromInteger(2);
+  EXPECT_TRUE(tree.GetValue(index_key, &rids));
+  ASSERT_EQ(rids.size(), 1);
+  EXPECT_EQ(rids[0].GetSlotNum(), 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeBulkLoadTest, ExternalSortTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 10000;
+
+  for (size_t run_size : {size_t{100000}, size_t{1000}, size_t{7}}) {
+    Sorter sorter(comparator, run_size);
+    // every key twice, the copy added later has a larger slot number
+    std::vector<int64_t> keys(num_keys);
+    std::iota(keys.begin(), keys.end(), 1);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+    GenericKey<8> index_key;
+    for (int copy = 0; copy < 2; copy++) {
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        sorter.Add(index_key, RID(0, copy));
+      }
+    }
+    // full runs are written right away, the last one once the output is read
+    EXPECT_EQ(sorter.GetRunCount(), 2 * num_keys / run_size);
+
+    // Scenario: the pairs come out in key order, and equal keys in the order they were added.
+    RID rid;
+    GenericKey<8> expected_key;
+    int64_t count = 0;
+    while (sorter.Next(&index_key, &rid)) {
+      expected_key.SetFromInteger(count / 2 + 1);
+      EXPECT_EQ(comparator(index_key, expected_key), 0);
+      EXPECT_EQ(rid.GetSlotNum(), count % 2);
+      count++;
+    }
+    EXPECT_EQ(count, 2 * num_keys);
+    EXPECT_FALSE(sorter.Next(&index_key, &rid));
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Building an index over shuffled GenericKey<8> keys by inserting them one at a time, and by an external sort
+// followed by a bulk load at a few fill factors.
+TEST(BPlusTreeBulkLoadTest, DISABLED_BuildBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1000000;
+  // the default page sizes, LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE are only defined inside the page classes
+  const int leaf_max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int internal_max_size = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>);
+
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 1);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+  for (double fill_factor : {0.0, 0.7, 0.9, 1.0}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(1024, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    GenericKey<8> index_key;
+    auto start = std::chrono::steady_clock::now();
+    if (fill_factor == 0.0) {
+      Transaction transaction(0);
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, key), &transaction);
+      }
+    } else {
+      // runs of 64k pairs, so that the sort goes to disk
+      Sorter sorter(comparator, 1 << 16);
+      for (auto key : keys) {
+        index_key.SetFromInteger(key);
+        sorter.Add(index_key, RID(0, key));
+      }
+      tree.BulkLoad([&sorter](GenericKey<8> *key, RID *rid) { return sorter.Next(key, rid); }, fill_factor);
+    }
+    bpm->FlushAllPages();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    // the number of pages written, the header page is page 0
+    page_id_t num_pages;
+    bpm->NewPage(&num_pages);
+    bpm->UnpinPage(num_pages, false);
+    if (fill_factor == 0.0) {
+      printf("%-16s %12.0f keys/s %8d pages\n", "inserts", num_keys / elapsed.count(), num_pages);
+    } else {
+      printf("bulk load %-6.2f %12.0f keys/s %8d pages\n", fill_factor, num_keys / elapsed.count(), num_pages);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
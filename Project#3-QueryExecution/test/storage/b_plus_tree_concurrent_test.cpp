@@ -0,0 +1,158 @@
+/**
+ * b_plus_tree_concurrent_test.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+TEST(BPlusTreeConcurrentTest, RootChangeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_stable_keys = 3;
+  const int64_t num_rounds = 50;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+    // tiny pages, so that the root is split and collapsed all the time
+    Tree tree("foo_pk", bpm, comparator, 4, 4, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    std::vector<RID> rids;
+
+    // Scenario: lookups on an empty tree find nothing.
+    index_key.SetFromInteger(1);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+
+    for (int64_t key = 1; key <= num_stable_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), &transaction);
+    }
+
+    // Scenario: readers look up keys that are always in the tree while a writer grows the tree by a few levels and
+    // shrinks it back, replacing the root on the way up and on the way down.
+    std::atomic<bool> done{false};
+    std::vector<std::thread> readers;
+    for (int reader_itr = 0; reader_itr < 3; reader_itr++) {
+      readers.emplace_back([&]() {
+        GenericKey<8> reader_key;
+        std::vector<RID> reader_rids;
+        while (!done) {
+          for (int64_t key = 1; key <= num_stable_keys; key++) {
+            reader_rids.clear();
+            reader_key.SetFromInteger(key);
+            ASSERT_TRUE(tree.GetValue(reader_key, &reader_rids));
+            ASSERT_EQ(reader_rids[0].GetSlotNum(), key);
+          }
+        }
+      });
+    }
+    for (int64_t round = 0; round < num_rounds; round++) {
+      for (int64_t key = num_stable_keys + 1; key <= 40; key++) {
+        index_key.SetFromInteger(key);
+        tree.Insert(index_key, RID(0, key), &transaction);
+      }
+      for (int64_t key = num_stable_keys + 1; key <= 40; key++) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key, &transaction);
+      }
+    }
+    done = true;
+    for (auto &reader : readers) {
+      reader.join();
+    }
+
+    int64_t current_key = 1;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+      current_key++;
+    }
+    EXPECT_EQ(current_key, num_stable_keys + 1);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Read-only point lookups of GenericKey<8> keys in a fully cached tree, split over 1 to 64 threads.
+TEST(BPlusTreeConcurrentTest, DISABLED_LookupScalingBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 200000;
+  const int64_t num_lookups = 2000000;
+  // the default page sizes, LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE are only defined inside the page classes
+  const int leaf_max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int internal_max_size = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(4096, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 1);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  GenericKey<8> index_key;
+  Transaction transaction(0);
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key), &transaction);
+  }
+
+  for (uint64_t num_threads = 1; num_threads <= 64; num_threads *= 2) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (uint64_t thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+      threads.emplace_back([&, thread_itr]() {
+        GenericKey<8> lookup_key;
+        std::vector<RID> rids;
+        std::mt19937_64 random(thread_itr);
+        for (int64_t i = 0; i < num_lookups / static_cast<int64_t>(num_threads); i++) {
+          rids.clear();
+          lookup_key.SetFromInteger(1 + static_cast<int64_t>(random() % num_keys));
+          tree.GetValue(lookup_key, &rids);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    printf("threads=%-3lu %12.0f lookups/s\n", num_threads, num_lookups / elapsed.count());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
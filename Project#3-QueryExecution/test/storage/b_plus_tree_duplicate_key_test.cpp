@@ -0,0 +1,324 @@
+/**
+ * b_plus_tree_duplicate_key_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// the slot numbers of the values of key, sorted
+static std::vector<uint32_t> Slots(Tree *tree, int64_t key) {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  std::vector<RID> rids;
+  tree->GetValue(index_key, &rids);
+  std::vector<uint32_t> slots;
+  for (auto &rid : rids) {
+    slots.push_back(rid.GetSlotNum());
+  }
+  std::sort(slots.begin(), slots.end());
+  return slots;
+}
+
+// check that the tree holds exactly the values of expected, through GetValue and through the iterator
+static void CheckValues(Tree *tree, const std::map<int64_t, std::vector<uint32_t>> &expected) {
+  std::map<int64_t, std::vector<uint32_t>> iterated;
+  int64_t last_key = INT64_MIN;
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    // the values of a key are 10000 * key + i
+    auto key = static_cast<int64_t>((*iterator).second.GetSlotNum() / 10000);
+    EXPECT_GE(key, last_key);
+    last_key = key;
+    iterated[key].push_back((*iterator).second.GetSlotNum());
+  }
+
+  for (const auto &[key, slots] : expected) {
+    auto sorted = slots;
+    std::sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(Slots(tree, key), sorted) << "key " << key;
+    auto &iterated_slots = iterated[key];
+    std::sort(iterated_slots.begin(), iterated_slots.end());
+    EXPECT_EQ(iterated_slots, sorted) << "key " << key;
+  }
+  for (const auto &[key, slots] : iterated) {
+    EXPECT_TRUE(expected.count(key) == 1 || slots.empty()) << "key " << key;
+  }
+}
+
+TEST(BPlusTreeDuplicateKeyTest, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 60;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode, false);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // key k gets k % 5 + 1 values, key 30 enough of them to fill a few posting pages
+    std::vector<std::pair<int64_t, uint32_t>> pairs;
+    std::map<int64_t, std::vector<uint32_t>> expected;
+    for (int64_t key = 1; key <= num_keys; key++) {
+      auto num_values = key == 30 ? 1200 : key % 5 + 1;
+      for (int64_t i = 0; i < num_values; i++) {
+        pairs.emplace_back(key, static_cast<uint32_t>(10000 * key + i));
+        expected[key].push_back(pairs.back().second);
+      }
+    }
+    std::shuffle(pairs.begin(), pairs.end(), std::mt19937(0));
+
+    // Scenario: duplicate keys are accepted, and every value is found.
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    for (auto &[key, slot] : pairs) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, slot), &transaction));
+    }
+    CheckValues(&tree, expected);
+
+    // Scenario: single pairs are removed, in any order, down to the last value of a key. Removing pairs that are not
+    // in the tree changes nothing.
+    std::shuffle(pairs.begin(), pairs.end(), std::mt19937(1));
+    for (size_t i = 0; i < pairs.size() / 2; i++) {
+      auto &[key, slot] = pairs[i];
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, RID(0, slot), &transaction);
+      tree.Remove(index_key, RID(1, slot), &transaction);
+      auto &slots = expected[key];
+      slots.erase(std::find(slots.begin(), slots.end(), slot));
+      if (slots.empty()) {
+        expected.erase(key);
+      }
+    }
+    CheckValues(&tree, expected);
+
+    // Scenario: removing a key removes all of its values.
+    for (int64_t key = 1; key <= num_keys; key += 2) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, &transaction);
+      expected.erase(key);
+    }
+    CheckValues(&tree, expected);
+    index_key.SetFromInteger(2);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, 20000), &transaction));
+    expected[2].push_back(20000);
+    CheckValues(&tree, expected);
+
+    // Scenario: the pages of the posting lists are given back, the pool does not run dry.
+    for (int round = 0; round < 5; round++) {
+      for (uint32_t i = 0; i < 2000; i++) {
+        index_key.SetFromInteger(90);
+        tree.Insert(index_key, RID(0, 900000 + i), &transaction);
+      }
+      for (uint32_t i = 0; i < 2000; i++) {
+        tree.Remove(index_key, RID(0, 900000 + i), &transaction);
+      }
+    }
+    EXPECT_TRUE(Slots(&tree, 90).empty());
+    CheckValues(&tree, expected);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeDuplicateKeyTest, BulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 5, 5, LatchMode::OPTIMISTIC, false);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Scenario: a bulk load puts the values of duplicate keys into posting lists.
+  std::map<int64_t, std::vector<uint32_t>> expected;
+  for (int64_t key = 1; key <= 40; key++) {
+    for (int64_t i = 0; i < (key == 20 ? 600 : key % 3 + 1); i++) {
+      expected[key].push_back(static_cast<uint32_t>(10000 * key + i));
+    }
+  }
+  auto key_it = expected.begin();
+  size_t value_idx = 0;
+  EXPECT_TRUE(tree.BulkLoad([&](GenericKey<8> *index_key, RID *rid) {
+    if (value_idx == key_it->second.size()) {
+      ++key_it;
+      value_idx = 0;
+    }
+    if (key_it == expected.end()) {
+      return false;
+    }
+    index_key->SetFromInteger(key_it->first);
+    rid->Set(0, key_it->second[value_idx++]);
+    return true;
+  }));
+  CheckValues(&tree, expected);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeDuplicateKeyTest, ConcurrentHotKeyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const uint32_t num_values = 1500;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode, false);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Scenario: threads add values to a few hot keys and remove some of them again while readers scan the keys.
+    std::vector<std::thread> threads;
+    for (uint32_t thread_itr = 0; thread_itr < 4; thread_itr++) {
+      threads.emplace_back([&, thread_itr]() {
+        GenericKey<8> index_key;
+        Transaction transaction(thread_itr);
+        for (uint32_t i = thread_itr; i < num_values; i += 4) {
+          index_key.SetFromInteger(1 + i % 3);
+          tree.Insert(index_key, RID(0, 10000 * (1 + i % 3) + i), &transaction);
+        }
+        for (uint32_t i = thread_itr; i < num_values; i += 8) {
+          index_key.SetFromInteger(1 + i % 3);
+          tree.Remove(index_key, RID(0, 10000 * (1 + i % 3) + i), &transaction);
+        }
+      });
+    }
+    threads.emplace_back([&]() {
+      for (int round = 0; round < 50; round++) {
+        for (int64_t key = 1; key <= 3; key++) {
+          for (auto slot : Slots(&tree, key)) {
+            ASSERT_EQ(slot / 10000, key);
+          }
+        }
+      }
+    });
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::map<int64_t, std::vector<uint32_t>> expected;
+    for (uint32_t i = 0; i < num_values; i++) {
+      if (i % 8 >= 4) {
+        expected[1 + i % 3].push_back(10000 * (1 + i % 3) + i);
+      }
+    }
+    for (int64_t key = 1; key <= 3; key++) {
+      auto sorted = expected[key];
+      std::sort(sorted.begin(), sorted.end());
+      EXPECT_EQ(Slots(&tree, key), sorted);
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Inserts, key scans and single pair deletes of 1M pairs over 1000 distinct GenericKey<8> keys, with Zipf skewed key
+// frequencies, in a fully cached tree.
+TEST(BPlusTreeDuplicateKeyTest, DISABLED_SkewedKeyBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_pairs = 1000000;
+  const int64_t num_keys = 1000;
+  // the default page sizes, LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE are only defined inside the page classes
+  const int leaf_max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int internal_max_size = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>);
+
+  for (double skew : {0.0, 1.0, 1.5}) {
+    std::vector<double> weights(num_keys);
+    for (int64_t key = 0; key < num_keys; key++) {
+      weights[key] = 1.0 / std::pow(key + 1, skew);
+    }
+    std::discrete_distribution<int64_t> distribution(weights.begin(), weights.end());
+    std::mt19937_64 random(0);
+    std::vector<int64_t> keys(num_pairs);
+    for (auto &key : keys) {
+      key = 1 + distribution(random);
+    }
+
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(8192, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size, LatchMode::OPTIMISTIC, false);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < num_pairs; i++) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Insert(index_key, RID(0, i), &transaction);
+    }
+    std::chrono::duration<double> insert_elapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    int64_t num_scanned = 0;
+    std::vector<RID> rids;
+    for (int64_t i = 0; i < 10000; i++) {
+      rids.clear();
+      index_key.SetFromInteger(keys[i]);
+      tree.GetValue(index_key, &rids);
+      num_scanned += rids.size();
+    }
+    std::chrono::duration<double> scan_elapsed = std::chrono::steady_clock::now() - start;
+
+    // deletes of the values of the 10 hottest keys cost the most, they only take a share of the pairs
+    start = std::chrono::steady_clock::now();
+    int64_t num_deleted = 0;
+    for (int64_t i = 0; i < num_pairs && num_deleted < 10000; i += 7) {
+      index_key.SetFromInteger(keys[i]);
+      tree.Remove(index_key, RID(0, i), &transaction);
+      num_deleted++;
+    }
+    std::chrono::duration<double> delete_elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("skew=%.1f %10.0f inserts/s %12.0f scanned values/s %10.0f deletes/s\n", skew,
+           num_pairs / insert_elapsed.count(), num_scanned / scan_elapsed.count(),
+           num_deleted / delete_elapsed.count());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -0,0 +1,218 @@
+/**
+ * b_plus_tree_integer_key_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/integer_key.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<IntegerKey, RID, IntegerComparator>;
+
+TEST(BPlusTreeIntegerKeyTest, LowerBoundTest) {
+  std::mt19937_64 random(0);
+  // one byte of slack to search keys that are not aligned
+  std::vector<char> buffer(1 + 300 * sizeof(int64_t));
+
+  // Scenario: for every size around the linear search threshold, the search agrees with std::lower_bound on keys with
+  // duplicates and on both extremes of int64_t.
+  for (int size = 0; size <= 300; size++) {
+    std::vector<int64_t> keys(size);
+    for (auto &key : keys) {
+      key = static_cast<int64_t>(random() % 200) - 100;
+    }
+    if (size > 2) {
+      keys[0] = INT64_MIN;
+      keys[1] = INT64_MAX;
+    }
+    std::sort(keys.begin(), keys.end());
+    if (size > 0) {
+      std::memcpy(buffer.data() + 1, keys.data(), size * sizeof(int64_t));
+    }
+
+    for (int64_t probe : {INT64_MIN, INT64_MIN + 1, int64_t{-101}, int64_t{100}, INT64_MAX - 1, INT64_MAX}) {
+      auto expected = std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin();
+      EXPECT_EQ(IntegerKeyLowerBound(buffer.data() + 1, size, probe), expected);
+    }
+    for (int64_t probe = -101; probe <= 101; probe++) {
+      auto expected = std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin();
+      ASSERT_EQ(IntegerKeyLowerBound(buffer.data() + 1, size, probe), expected) << "size " << size << " key " << probe;
+    }
+  }
+}
+
+TEST(BPlusTreeIntegerKeyTest, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  IntegerComparator comparator(key_schema);
+  const int64_t num_keys = 2000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Scenario: negative and positive keys inserted in random order are found and scanned in order through splits of
+    // pages that keep their keys apart from their values.
+    std::vector<int64_t> keys(num_keys);
+    std::iota(keys.begin(), keys.end(), -num_keys / 2);
+    auto shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(0));
+    IntegerKey index_key;
+    Transaction transaction(0);
+    for (auto key : shuffled) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, key + num_keys), &transaction));
+    }
+    index_key.SetFromInteger(0);
+    EXPECT_FALSE(tree.Insert(index_key, RID(0, 0), &transaction));
+
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids[0].GetSlotNum(), key + num_keys);
+    }
+    index_key.SetFromInteger(num_keys);
+    EXPECT_FALSE(tree.GetValue(index_key, &rids));
+
+    std::vector<int64_t> scanned;
+    for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+      EXPECT_EQ((*iterator).first.ToInteger() + num_keys, (*iterator).second.GetSlotNum());
+      scanned.push_back((*iterator).first.ToInteger());
+    }
+    EXPECT_EQ(scanned, keys);
+
+    // Scenario: removing most keys merges and redistributes the pages, moving keys and values separately.
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+    for (int64_t i = 0; i < num_keys * 3 / 4; i++) {
+      index_key.SetFromInteger(shuffled[i]);
+      tree.Remove(index_key, &transaction);
+      keys.erase(std::find(keys.begin(), keys.end(), shuffled[i]));
+    }
+    for (int64_t i = 0; i < num_keys; i++) {
+      rids.clear();
+      index_key.SetFromInteger(shuffled[i]);
+      EXPECT_EQ(tree.GetValue(index_key, &rids), i >= num_keys * 3 / 4);
+    }
+    scanned.clear();
+    for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+      scanned.push_back((*iterator).first.ToInteger());
+    }
+    EXPECT_EQ(scanned, keys);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Searches of one full leaf page, then point lookups over a bulk loaded tree, of bigint keys as GenericKey<8> and as
+// IntegerKey. Both trees hold as many pairs in a page.
+template <typename KeyType, typename KeyComparator>
+static void SearchBenchmark(const char *name) {
+  // the page size macros take the value type from here
+  using ValueType = RID;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  KeyComparator comparator(key_schema);
+  const int leaf_max_size = TRUNCATED_LEAF_PAGE_SIZE(8);
+  const int internal_max_size = TRUNCATED_INTERNAL_PAGE_SIZE(8);
+  const int64_t num_keys = 1000000;
+  const int num_searches = 10000000;
+  const int num_lookups = 2000000;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(8192, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::mt19937_64 random(0);
+  KeyType index_key;
+  {
+    auto page = bpm->NewPage(&page_id);
+    auto leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size, 8);
+    for (int64_t key = 0; key < leaf_max_size; key++) {
+      index_key.SetFromInteger(2 * key);
+      leaf->Insert(index_key, RID(0, key), comparator);
+    }
+    std::vector<KeyType> searches(num_searches);
+    for (auto &search : searches) {
+      search.SetFromInteger(static_cast<int64_t>(random() % (2 * leaf_max_size)));
+    }
+
+    int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &search : searches) {
+      checksum += leaf->KeyIndex(search, comparator);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_GT(checksum, 0);
+    printf("%-14s in-page search of %d keys: %6.1f ns/search\n", name, leaf_max_size,
+           elapsed.count() * 1e9 / num_searches);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  BPlusTree<KeyType, RID, KeyComparator> tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size,
+                                              LatchMode::OPTIMISTIC, true, 8);
+  int64_t key = 0;
+  tree.BulkLoad([&](KeyType *index_key, RID *rid) {
+    if (key == num_keys) {
+      return false;
+    }
+    key++;
+    index_key->SetFromInteger(key);
+    rid->Set(0, key);
+    return true;
+  });
+
+  std::vector<KeyType> lookups(num_lookups);
+  for (auto &lookup : lookups) {
+    lookup.SetFromInteger(1 + static_cast<int64_t>(random() % num_keys));
+  }
+  std::vector<RID> rids;
+  int64_t num_found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (const auto &lookup : lookups) {
+    rids.clear();
+    num_found += static_cast<int64_t>(tree.GetValue(lookup, &rids));
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(num_found, num_lookups);
+  printf("%-14s tree of %ld keys: %10.0f lookups/s\n", name, num_keys, num_lookups / elapsed.count());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  delete key_schema;
+}
+
+TEST(BPlusTreeIntegerKeyTest, DISABLED_SearchBenchmark) {
+  SearchBenchmark<GenericKey<8>, GenericComparator<8>>("GenericKey<8>");
+  SearchBenchmark<IntegerKey, IntegerComparator>("IntegerKey");
+}
+
+}  // namespace bustub
@@ -0,0 +1,323 @@
+/**
+ * b_plus_tree_latch_mode_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+
+// every thread inserts the keys k with k % num_threads == thread_itr
+static void InsertSplit(Tree *tree, const std::vector<int64_t> &keys, uint64_t num_threads, uint64_t thread_itr) {
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction transaction(0);
+  for (auto key : keys) {
+    if (static_cast<uint64_t>(key) % num_threads == thread_itr) {
+      rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+      index_key.SetFromInteger(key);
+      tree->Insert(index_key, rid, &transaction);
+    }
+  }
+}
+
+// every thread removes the keys k with k % num_threads == thread_itr
+static void RemoveSplit(Tree *tree, const std::vector<int64_t> &keys, uint64_t num_threads, uint64_t thread_itr) {
+  GenericKey<8> index_key;
+  Transaction transaction(0);
+  for (auto key : keys) {
+    if (static_cast<uint64_t>(key) % num_threads == thread_itr) {
+      index_key.SetFromInteger(key);
+      tree->Remove(index_key, &transaction);
+    }
+  }
+}
+
+template <typename F>
+static void RunThreads(uint64_t num_threads, F f) {
+  std::vector<std::thread> threads;
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    threads.emplace_back(f, thread_itr);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+static const char *LatchModeName(LatchMode latch_mode) {
+  switch (latch_mode) {
+    case LatchMode::PESSIMISTIC:
+      return "pessimistic";
+    case LatchMode::OPTIMISTIC:
+      return "optimistic";
+    case LatchMode::BLINK:
+      return "b-link";
+  }
+  return "";
+}
+
+// check that exactly the keys in [first, last] are in the tree, in order
+static void CheckRange(Tree *tree, int64_t first, int64_t last) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  int64_t current_key = first;
+  for (auto iterator = tree->begin(); iterator != tree->end(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, last + 1);
+
+  for (int64_t key = first; key <= last; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree->GetValue(index_key, &rids));
+    ASSERT_EQ(rids.size(), 1);
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+}
+
+TEST(BPlusTreeLatchModeTest, ConcurrentInsertDeleteTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const uint64_t num_threads = 4;
+  const int64_t scale_factor = 2000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+    // small pages, so that many inserts and deletes have to restart pessimistically
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> keys(2 * scale_factor);
+    std::iota(keys.begin(), keys.end(), 1);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+    // Scenario: concurrent inserts, among them many leaf and internal splits.
+    RunThreads(num_threads, [&](uint64_t thread_itr) { InsertSplit(&tree, keys, num_threads, thread_itr); });
+    CheckRange(&tree, 1, 2 * scale_factor);
+
+    // Scenario: duplicates are refused.
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(1);
+    Transaction transaction(0);
+    EXPECT_FALSE(tree.Insert(index_key, RID(0, 1), &transaction));
+
+    // Scenario: concurrent deletes of the lower half, among them redistributions and merges, and deletes of keys
+    // that are not in the tree.
+    std::vector<int64_t> remove_keys;
+    for (auto key : keys) {
+      if (key <= scale_factor) {
+        remove_keys.push_back(key);
+        remove_keys.push_back(-key);
+      }
+    }
+    RunThreads(num_threads, [&](uint64_t thread_itr) { RemoveSplit(&tree, remove_keys, num_threads, thread_itr); });
+    CheckRange(&tree, scale_factor + 1, 2 * scale_factor);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeLatchModeTest, ConcurrentMixTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t scale_factor = 2000;
+
+  for (auto latch_mode : {LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 7, 7, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> delete_keys(scale_factor);
+    std::vector<int64_t> remain_keys(scale_factor);
+    std::iota(delete_keys.begin(), delete_keys.end(), 1);
+    std::iota(remain_keys.begin(), remain_keys.end(), scale_factor + 1);
+    std::shuffle(delete_keys.begin(), delete_keys.end(), std::mt19937(1));
+    std::shuffle(remain_keys.begin(), remain_keys.end(), std::mt19937(2));
+    RunThreads(2, [&](uint64_t thread_itr) { InsertSplit(&tree, delete_keys, 2, thread_itr); });
+
+    // Scenario: inserts, deletes and lookups of disjoint keys at the same time.
+    std::thread reader([&]() {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int round = 0; round < 5; round++) {
+        for (int64_t key = scale_factor + 1; key <= 2 * scale_factor; key++) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          if (tree.GetValue(index_key, &rids)) {
+            EXPECT_EQ(rids[0].GetSlotNum(), key);
+          }
+        }
+      }
+    });
+    RunThreads(4, [&](uint64_t thread_itr) {
+      if (thread_itr < 2) {
+        InsertSplit(&tree, remain_keys, 2, thread_itr);
+      } else {
+        RemoveSplit(&tree, delete_keys, 2, thread_itr - 2);
+      }
+    });
+    reader.join();
+
+    CheckRange(&tree, scale_factor + 1, 2 * scale_factor);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeLatchModeTest, ConcurrentSplitLookupTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t scale_factor = 2000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    std::vector<int64_t> even_keys;
+    std::vector<int64_t> odd_keys;
+    for (int64_t key = 1; key <= 2 * scale_factor; key++) {
+      (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+    }
+    std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(3));
+    InsertSplit(&tree, even_keys, 1, 0);
+
+    // Scenario: lookups of keys that are in the tree never miss while the pages holding them are split under them,
+    // in a B-link tree they have to move right for that.
+    std::thread reader([&]() {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      for (int round = 0; round < 5; round++) {
+        for (auto key : even_keys) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          ASSERT_TRUE(tree.GetValue(index_key, &rids)) << "key " << key;
+          ASSERT_EQ(rids[0].GetSlotNum(), key);
+        }
+      }
+    });
+    RunThreads(2, [&](uint64_t thread_itr) { InsertSplit(&tree, odd_keys, 2, thread_itr); });
+    reader.join();
+
+    CheckRange(&tree, 1, 2 * scale_factor);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeLatchModeTest, ConcurrentEmptyTreeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int num_rounds = 2000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Scenario: every thread inserts and removes its own key over and over, so the tree is emptied all the time and
+    // writers find it empty after checking that it is not.
+    RunThreads(4, [&](uint64_t thread_itr) {
+      GenericKey<8> index_key;
+      index_key.SetFromInteger(static_cast<int64_t>(thread_itr));
+      RID rid(0, static_cast<uint32_t>(thread_itr));
+      Transaction transaction(0);
+      for (int round = 0; round < num_rounds; round++) {
+        EXPECT_TRUE(tree.Insert(index_key, rid, &transaction)) << LatchModeName(latch_mode);
+        tree.Remove(index_key, &transaction);
+        tree.Remove(index_key, &transaction);
+      }
+    });
+    EXPECT_TRUE(tree.IsEmpty()) << LatchModeName(latch_mode);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Random inserts of GenericKey<8> keys into a fully cached tree, split over 1 to hardware_concurrency threads, with
+// every latch mode.
+TEST(BPlusTreeLatchModeTest, DISABLED_InsertScalingBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 500000;
+  const uint64_t max_threads = std::max(1U, std::thread::hardware_concurrency());
+  // the default page sizes, LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE are only defined inside the page classes
+  const int leaf_max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int internal_max_size = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>);
+
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 1);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    for (uint64_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManager(16384, disk_manager);
+      Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size, latch_mode);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      auto start = std::chrono::steady_clock::now();
+      RunThreads(num_threads, [&](uint64_t thread_itr) { InsertSplit(&tree, keys, num_threads, thread_itr); });
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      printf("%-12s threads=%-3lu %12.0f inserts/s\n", LatchModeName(latch_mode), num_threads,
+             num_keys / elapsed.count());
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete disk_manager;
+      delete bpm;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
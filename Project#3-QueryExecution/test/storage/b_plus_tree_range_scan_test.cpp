@@ -0,0 +1,318 @@
+/**
+ * b_plus_tree_range_scan_test.cpp
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using KeyBound = IndexKeyBound<GenericKey<8>>;
+
+static std::optional<KeyBound> Bound(std::optional<int64_t> key, bool inclusive) {
+  if (!key.has_value()) {
+    return std::nullopt;
+  }
+  KeyBound bound{GenericKey<8>(), inclusive};
+  bound.key_.SetFromInteger(*key);
+  return bound;
+}
+
+// the slot numbers of a range scan, the slot number of a pair is its key
+static std::vector<int64_t> Scan(Tree *tree, std::optional<int64_t> lower, bool lower_inclusive,
+                                 std::optional<int64_t> upper, bool upper_inclusive, bool reverse) {
+  std::vector<int64_t> slots;
+  for (auto iterator = tree->Begin(Bound(lower, lower_inclusive), Bound(upper, upper_inclusive), reverse);
+       !iterator.isEnd(); ++iterator) {
+    slots.push_back((*iterator).second.GetSlotNum());
+  }
+  return slots;
+}
+
+// the same range scan over the sorted keys
+static std::vector<int64_t> Expected(const std::vector<int64_t> &keys, std::optional<int64_t> lower,
+                                     bool lower_inclusive, std::optional<int64_t> upper, bool upper_inclusive,
+                                     bool reverse) {
+  std::vector<int64_t> expected;
+  for (auto key : keys) {
+    if (lower.has_value() && (key < *lower || (key == *lower && !lower_inclusive))) {
+      continue;
+    }
+    if (upper.has_value() && (key > *upper || (key == *upper && !upper_inclusive))) {
+      continue;
+    }
+    expected.push_back(key);
+  }
+  if (reverse) {
+    std::reverse(expected.begin(), expected.end());
+  }
+  return expected;
+}
+
+// every range with bounds around, on and between the keys, in both directions
+static void CheckRanges(Tree *tree, const std::vector<int64_t> &keys, int64_t max_key, int64_t step) {
+  std::vector<std::optional<int64_t>> bounds = {std::nullopt};
+  for (int64_t key = -1; key <= max_key + 2; key += step) {
+    bounds.emplace_back(key);
+  }
+  for (auto lower : bounds) {
+    for (auto upper : bounds) {
+      for (int inclusive = 0; inclusive < 4; inclusive++) {
+        for (bool reverse : {false, true}) {
+          bool lower_inclusive = (inclusive & 1) != 0;
+          bool upper_inclusive = (inclusive & 2) != 0;
+          ASSERT_EQ(Scan(tree, lower, lower_inclusive, upper, upper_inclusive, reverse),
+                    Expected(keys, lower, lower_inclusive, upper, upper_inclusive, reverse))
+              << "lower " << lower.value_or(-100) << (lower_inclusive ? "]" : ")") << " upper "
+              << upper.value_or(-100) << (upper_inclusive ? "]" : ")") << (reverse ? " reverse" : "");
+        }
+      }
+    }
+  }
+}
+
+TEST(BPlusTreeRangeScanTest, RangeScanTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t max_key = 200;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Scenario: ranges over an empty tree are empty.
+    CheckRanges(&tree, {}, 4, 1);
+    EXPECT_TRUE(tree.begin() == tree.end());
+
+    // Scenario: ranges over the even keys, inserted in random order.
+    std::vector<int64_t> keys;
+    for (int64_t key = 2; key <= max_key; key += 2) {
+      keys.push_back(key);
+    }
+    auto shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(0));
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    for (auto key : shuffled) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), &transaction);
+    }
+    CheckRanges(&tree, keys, max_key, 7);
+
+    // Scenario: reverse ranges find their way left after merges and redistributions left stale links and separators.
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+    for (size_t i = 0; i < shuffled.size() * 3 / 4; i++) {
+      index_key.SetFromInteger(shuffled[i]);
+      tree.Remove(index_key, &transaction);
+      keys.erase(std::find(keys.begin(), keys.end(), shuffled[i]));
+    }
+    CheckRanges(&tree, keys, max_key, 5);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeRangeScanTest, BulkLoadAndDuplicateKeyTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 5, 5, LatchMode::OPTIMISTIC, false);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Scenario: the leaves of a bulk loaded tree link back to each other.
+  std::vector<int64_t> keys;
+  int64_t key = 0;
+  tree.BulkLoad([&](GenericKey<8> *index_key, RID *rid) {
+    if (key == 300) {
+      return false;
+    }
+    key++;
+    keys.push_back(key);
+    index_key->SetFromInteger(key);
+    rid->Set(0, key);
+    return true;
+  });
+  CheckRanges(&tree, keys, 300, 13);
+
+  // Scenario: a reverse scan visits the values of a posting list backwards.
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(150);
+  Transaction transaction(0);
+  for (uint32_t i = 1; i <= 1000; i++) {
+    tree.Insert(index_key, RID(1, i), &transaction);
+  }
+  std::vector<RID> forward;
+  for (auto iterator = tree.Begin(Bound(150, true), Bound(150, true)); !iterator.isEnd(); ++iterator) {
+    forward.push_back((*iterator).second);
+  }
+  std::vector<RID> backward;
+  for (auto iterator = tree.Begin(Bound(149, false), Bound(151, false), true); !iterator.isEnd(); ++iterator) {
+    backward.push_back((*iterator).second);
+  }
+  ASSERT_EQ(forward.size(), 1001);
+  std::reverse(backward.begin(), backward.end());
+  EXPECT_EQ(forward, backward);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeRangeScanTest, ConcurrentReverseScanTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t max_key = 2000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(100, disk_manager);
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    GenericKey<8> index_key;
+    Transaction transaction(0);
+    for (int64_t key = 2; key <= max_key; key += 2) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), &transaction);
+    }
+
+    // Scenario: reverse scans see every even key exactly once, in order, while odd keys are inserted and removed,
+    // splitting and merging the leaves under them.
+    std::atomic<bool> done{false};
+    std::thread writer([&]() {
+      GenericKey<8> writer_key;
+      Transaction writer_transaction(1);
+      while (!done) {
+        for (int64_t key = 1; key <= max_key; key += 2) {
+          writer_key.SetFromInteger(key);
+          tree.Insert(writer_key, RID(0, key), &writer_transaction);
+        }
+        for (int64_t key = 1; key <= max_key; key += 2) {
+          writer_key.SetFromInteger(key);
+          tree.Remove(writer_key, &writer_transaction);
+        }
+      }
+    });
+    for (int round = 0; round < 20; round++) {
+      std::vector<int64_t> even_keys;
+      int64_t last_key = max_key + 1;
+      for (auto iterator = tree.Begin(std::nullopt, std::nullopt, true); !iterator.isEnd(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        EXPECT_LT(key, last_key);
+        last_key = key;
+        if (key % 2 == 0) {
+          even_keys.push_back(key);
+        }
+      }
+      EXPECT_EQ(even_keys.size(), max_key / 2);
+    }
+    done = true;
+    writer.join();
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Scans of ranges of 1% of 1M GenericKey<8> keys in a fully cached tree: a full scan that filters every key like
+// IndexScanExecutor did, against bounded forward and reverse scans.
+TEST(BPlusTreeRangeScanTest, DISABLED_RangeScanBenchmark) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1000000;
+  const int64_t range = num_keys / 100;
+  const int num_scans = 20;
+  // the default page sizes, LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE are only defined inside the page classes
+  const int leaf_max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, RID>);
+  const int internal_max_size = (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<GenericKey<8>, page_id_t>);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(8192, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, leaf_max_size, internal_max_size);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  int64_t key = 0;
+  tree.BulkLoad([&](GenericKey<8> *index_key, RID *rid) {
+    if (key == num_keys) {
+      return false;
+    }
+    key++;
+    index_key->SetFromInteger(key);
+    rid->Set(0, key);
+    return true;
+  });
+
+  std::mt19937_64 random(0);
+  std::vector<int64_t> starts(num_scans);
+  for (auto &start : starts) {
+    start = 1 + static_cast<int64_t>(random() % (num_keys - range));
+  }
+
+  const char *mode_names[] = {"filtered full", "bounded", "bounded reverse"};
+  for (int mode = 0; mode < 3; mode++) {
+    int64_t num_found = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    for (auto start : starts) {
+      if (mode == 0) {
+        for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+          int64_t slot = (*iterator).second.GetSlotNum();
+          num_found += static_cast<int64_t>(slot >= start && slot < start + range);
+        }
+      } else {
+        for (auto iterator = tree.Begin(Bound(start, true), Bound(start + range, false), mode == 2);
+             !iterator.isEnd(); ++iterator) {
+          num_found++;
+        }
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+    EXPECT_EQ(num_found, num_scans * range);
+    printf("%-16s %10.0f scans/s %12.0f keys/s\n", mode_names[mode], num_scans / elapsed.count(),
+           num_found / elapsed.count());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,209 @@
+/**
+ * b_plus_tree_truncated_key_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
+
+namespace bustub {
+
+using Tree = BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+
+// a forward scan, and a reverse scan read backwards, both return exactly the keys
+static void CheckScans(Tree *tree, const std::vector<int64_t> &keys) {
+  std::vector<int64_t> forward;
+  for (auto iterator = tree->begin(); !iterator.isEnd(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToInteger(), (*iterator).second.GetSlotNum());
+    forward.push_back((*iterator).first.ToInteger());
+  }
+  EXPECT_EQ(forward, keys);
+
+  std::vector<int64_t> backward;
+  for (auto iterator = tree->Begin(std::nullopt, std::nullopt, true); !iterator.isEnd(); ++iterator) {
+    backward.push_back((*iterator).first.ToInteger());
+  }
+  std::reverse(backward.begin(), backward.end());
+  EXPECT_EQ(backward, keys);
+}
+
+// the number of levels of the tree and the key size of its pages, read down the leftmost path
+template <typename KeyType>
+static int TreeHeight(BufferPoolManager *bpm, const std::string &name, int *key_size) {
+  using LeafPage = BPlusTreeLeafPage<KeyType, RID, GenericComparator<sizeof(KeyType)>>;
+  using InternalPage = BPlusTreeInternalPage<KeyType, page_id_t, GenericComparator<sizeof(KeyType)>>;
+  page_id_t page_id;
+  auto header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  bool found = header_page->GetRootId(name, &page_id);
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  if (!found) {
+    return 0;
+  }
+
+  int height = 1;
+  while (true) {
+    auto page = bpm->FetchPage(page_id);
+    auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (node->IsLeafPage()) {
+      *key_size = reinterpret_cast<LeafPage *>(node)->GetKeySize();
+      bpm->UnpinPage(page_id, false);
+      return height;
+    }
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    *key_size = internal->GetKeySize();
+    auto child_page_id = internal->ValueAt(0);
+    bpm->UnpinPage(page_id, false);
+    page_id = child_page_id;
+    height++;
+  }
+}
+
+TEST(BPlusTreeTruncatedKeyTest, InsertRemoveTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema);
+  const int64_t num_keys = 2000;
+
+  for (auto latch_mode : {LatchMode::PESSIMISTIC, LatchMode::OPTIMISTIC, LatchMode::BLINK}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+    // a bigint key fills 8 of the 64 bytes of the key
+    Tree tree("foo_pk", bpm, comparator, 5, 5, latch_mode, true, 8);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Scenario: keys inserted in random order are found and scanned in order from pages that store 8 bytes of each.
+    std::vector<int64_t> keys(num_keys);
+    std::iota(keys.begin(), keys.end(), 1);
+    auto shuffled = keys;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(0));
+    GenericKey<64> index_key;
+    Transaction transaction(0);
+    for (auto key : shuffled) {
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, key), &transaction));
+    }
+    index_key.SetFromInteger(num_keys / 2);
+    EXPECT_FALSE(tree.Insert(index_key, RID(0, 0), &transaction));
+
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+    CheckScans(&tree, keys);
+    int key_size = 0;
+    EXPECT_GT(TreeHeight<GenericKey<64>>(bpm, "foo_pk", &key_size), 2);
+    EXPECT_EQ(key_size, 8);
+
+    // Scenario: removing most keys merges and redistributes pages of truncated keys.
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+    for (int64_t i = 0; i < num_keys * 3 / 4; i++) {
+      index_key.SetFromInteger(shuffled[i]);
+      tree.Remove(index_key, &transaction);
+      keys.erase(std::find(keys.begin(), keys.end(), shuffled[i]));
+    }
+    for (int64_t i = 0; i < num_keys; i++) {
+      rids.clear();
+      index_key.SetFromInteger(shuffled[i]);
+      EXPECT_EQ(tree.GetValue(index_key, &rids), i >= num_keys * 3 / 4);
+    }
+    CheckScans(&tree, keys);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Point lookups over a bulk loaded tree for each instantiated key size, with the keys stored in full and truncated to
+// the 8 bytes of a bigint, 4 for GenericKey<4>.
+template <size_t KeySize>
+static void KeySizeBenchmark() {
+  using KeyType = GenericKey<KeySize>;
+  // the page size macros take the value type from here
+  using ValueType = RID;
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<KeySize> comparator(key_schema);
+  const int64_t num_keys = 1000000;
+  const int num_lookups = 1000000;
+
+  std::vector<int64_t> lookups(num_lookups);
+  std::mt19937_64 random(0);
+  for (auto &key : lookups) {
+    key = 1 + static_cast<int64_t>(random() % num_keys);
+  }
+
+  for (int key_size : {static_cast<int>(KeySize), std::min(8, static_cast<int>(KeySize))}) {
+    const int leaf_max_size = TRUNCATED_LEAF_PAGE_SIZE(key_size);
+    const int internal_max_size = TRUNCATED_INTERNAL_PAGE_SIZE(key_size);
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManager(32768, disk_manager);
+    BPlusTree<KeyType, RID, GenericComparator<KeySize>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                             internal_max_size, LatchMode::OPTIMISTIC, true, key_size);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    int64_t key = 0;
+    tree.BulkLoad([&](KeyType *index_key, RID *rid) {
+      if (key == num_keys) {
+        return false;
+      }
+      key++;
+      index_key->SetFromInteger(key);
+      rid->Set(0, key);
+      return true;
+    });
+    int stored_key_size = 0;
+    int height = TreeHeight<KeyType>(bpm, "foo_pk", &stored_key_size);
+
+    KeyType index_key;
+    std::vector<RID> rids;
+    int64_t num_found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto lookup : lookups) {
+      rids.clear();
+      index_key.SetFromInteger(lookup);
+      num_found += static_cast<int64_t>(tree.GetValue(index_key, &rids));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(num_found, num_lookups);
+
+    printf("GenericKey<%2zu> %2d bytes stored: fanout %4d leaf %4d internal, height %d, %10.0f lookups/s\n", KeySize,
+           stored_key_size, leaf_max_size, internal_max_size, height, num_lookups / elapsed.count());
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+TEST(BPlusTreeTruncatedKeyTest, DISABLED_KeySizeBenchmark) {
+  KeySizeBenchmark<4>();
+  KeySizeBenchmark<8>();
+  KeySizeBenchmark<16>();
+  KeySizeBenchmark<32>();
+  KeySizeBenchmark<64>();
+}
+
+}  // namespace bustub
@@ -0,0 +1,268 @@
+/**
+ * extendible_hash_table_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/extendible_hash_table.h"
+#include "storage/index/extendible_hash_table_index.h"
+
+namespace bustub {
+
+using HashTable = ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+
+static GenericKey<8> MakeKey(int64_t key) {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return index_key;
+}
+
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  HashTable table("foo_pk", bpm);
+  const int64_t num_keys = 10000;
+
+  // Scenario: inserting many more keys than a bucket holds splits buckets and doubles the directory, and every key
+  // is found. A pair is inserted once.
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  for (auto key : keys) {
+    EXPECT_TRUE(table.Insert(MakeKey(key), RID(0, key)));
+  }
+  EXPECT_FALSE(table.Insert(MakeKey(42), RID(0, 42)));
+  EXPECT_TRUE(table.Insert(MakeKey(42), RID(1, 42)));
+  EXPECT_GT(table.GetGlobalDepth(), 4);
+  EXPECT_TRUE(table.VerifyIntegrity());
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    ASSERT_TRUE(table.GetValue(MakeKey(key), &rids));
+    ASSERT_EQ(rids.size(), key == 42 ? 2 : 1) << "key " << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key);
+  }
+  rids.clear();
+  EXPECT_FALSE(table.GetValue(MakeKey(num_keys), &rids));
+  EXPECT_TRUE(rids.empty());
+
+  // Scenario: removing pairs that are not in the table changes nothing, removing the rest merges all buckets back
+  // into one and halves the directory down to a single entry.
+  EXPECT_FALSE(table.Remove(MakeKey(num_keys), RID(0, num_keys)));
+  EXPECT_FALSE(table.Remove(MakeKey(7), RID(0, 8)));
+  EXPECT_TRUE(table.Remove(MakeKey(42), RID(1, 42)));
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_TRUE(table.Remove(MakeKey(keys[i]), RID(0, keys[i])));
+    if (i == keys.size() / 2) {
+      EXPECT_TRUE(table.VerifyIntegrity());
+    }
+  }
+  EXPECT_EQ(table.GetGlobalDepth(), 0);
+  EXPECT_TRUE(table.VerifyIntegrity());
+  rids.clear();
+  EXPECT_FALSE(table.GetValue(MakeKey(42), &rids));
+
+  // Scenario: the table grows again after shrinking.
+  for (int64_t key = 0; key < num_keys; key++) {
+    EXPECT_TRUE(table.Insert(MakeKey(key), RID(0, key)));
+  }
+  EXPECT_GT(table.GetGlobalDepth(), 4);
+  EXPECT_TRUE(table.VerifyIntegrity());
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExtendibleHashTableTest, OverflowTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  HashTable table("foo_pk", bpm);
+  const int64_t num_values = 2000;
+
+  // Scenario: the values of one key do not fit in a bucket and cannot be split apart, they overflow into a chain of
+  // pages while the other keys split around them.
+  for (int64_t value = 0; value < num_values; value++) {
+    EXPECT_TRUE(table.Insert(MakeKey(7), RID(1, value)));
+    EXPECT_TRUE(table.Insert(MakeKey(value + 100), RID(0, value)));
+  }
+  EXPECT_FALSE(table.Insert(MakeKey(7), RID(1, num_values - 1)));
+  EXPECT_TRUE(table.VerifyIntegrity());
+  std::vector<RID> rids;
+  ASSERT_TRUE(table.GetValue(MakeKey(7), &rids));
+  ASSERT_EQ(rids.size(), num_values);
+  std::sort(rids.begin(), rids.end(),
+            [](const RID &lhs, const RID &rhs) { return lhs.GetSlotNum() < rhs.GetSlotNum(); });
+  for (int64_t value = 0; value < num_values; value++) {
+    EXPECT_EQ(rids[value], RID(1, value));
+  }
+
+  // Scenario: removing values in any order drops the pages of the chain they empty, the rest are still found.
+  std::vector<int64_t> values;
+  for (int64_t value = 0; value < num_values; value++) {
+    values.push_back(value);
+  }
+  std::shuffle(values.begin(), values.end(), std::mt19937(0));
+  for (int64_t i = 0; i < num_values - 10; i++) {
+    EXPECT_TRUE(table.Remove(MakeKey(7), RID(1, values[i])));
+  }
+  EXPECT_TRUE(table.VerifyIntegrity());
+  rids.clear();
+  ASSERT_TRUE(table.GetValue(MakeKey(7), &rids));
+  EXPECT_EQ(rids.size(), 10);
+  for (int64_t value = 0; value < num_values; value++) {
+    rids.clear();
+    ASSERT_TRUE(table.GetValue(MakeKey(value + 100), &rids));
+    EXPECT_EQ(rids, std::vector<RID>{RID(0, value)});
+  }
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExtendibleHashTableTest, ConcurrentInsertLookupTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  HashTable table("foo_pk", bpm);
+  const int64_t num_keys = 20000;
+  const int num_threads = 4;
+
+  // Scenario: threads insert disjoint keys, then remove half of them, splitting and merging buckets, while readers
+  // look up keys that are always in the table.
+  for (int64_t key = 0; key < num_keys; key += 11) {
+    table.Insert(MakeKey(-1 - key), RID(1, key));
+  }
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&, i]() {
+      std::mt19937_64 random(i);
+      std::vector<RID> rids;
+      while (!done) {
+        int64_t key = random() % num_keys / 11 * 11;
+        rids.clear();
+        ASSERT_TRUE(table.GetValue(MakeKey(-1 - key), &rids));
+        ASSERT_EQ(rids, std::vector<RID>{RID(1, key)});
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int i = 0; i < num_threads; i++) {
+    writers.emplace_back([&, i]() {
+      std::vector<int64_t> keys;
+      for (int64_t key = i; key < num_keys; key += num_threads) {
+        keys.push_back(key);
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(i));
+      for (auto key : keys) {
+        EXPECT_TRUE(table.Insert(MakeKey(key), RID(0, key)));
+      }
+      for (auto key : keys) {
+        if (key % 2 == 0) {
+          EXPECT_TRUE(table.Remove(MakeKey(key), RID(0, key)));
+        }
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_TRUE(table.VerifyIntegrity());
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; key++) {
+    rids.clear();
+    EXPECT_EQ(table.GetValue(MakeKey(key), &rids), key % 2 == 1) << "key " << key;
+  }
+
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+// Random equality probes through the Index interface, of the hash index and of a B+ tree index on the same bigint
+// keys, with every page cached, on 1 and 4 threads.
+static void ProbeBenchmark(const char *name, Index *index, const std::vector<int64_t> &keys) {
+  const Schema *key_schema = index->GetKeySchema();
+  Transaction transaction(0);
+  for (size_t i = 0; i < keys.size(); i++) {
+    index->InsertEntry(Tuple({Value(TypeId::BIGINT, keys[i])}, key_schema), RID(0, i), &transaction);
+  }
+
+  const int num_probes = 2000000;
+  for (int num_threads : {1, 4}) {
+    std::atomic<size_t> num_found{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back([&, i]() {
+        Transaction transaction(i);
+        std::mt19937_64 random(i);
+        std::vector<RID> rids;
+        for (int j = 0; j < num_probes / num_threads; j++) {
+          rids.clear();
+          index->ScanKey(Tuple({Value(TypeId::BIGINT, keys[random() % keys.size()])}, key_schema), &rids, &transaction);
+          num_found += rids.size();
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(num_found, num_probes / num_threads * num_threads);
+    printf("%-24s threads=%d %12.0f probes/s\n", name, num_threads, num_probes / elapsed.count());
+  }
+}
+
+TEST(ExtendibleHashTableTest, DISABLED_ProbeBenchmark) {
+  Schema *schema = ParseCreateStatement("a bigint");
+  std::vector<int64_t> keys;
+  std::mt19937_64 random(0);
+  for (int i = 0; i < 100000; i++) {
+    keys.push_back(static_cast<int64_t>(random() >> 1));
+  }
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50000, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  {
+    ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>> hash_index(
+        new IndexMetadata("foo_hash", "foo", schema, {0}), bpm);
+    ProbeBenchmark("ExtendibleHashTableIndex", &hash_index, keys);
+    BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> b_plus_tree_index(
+        new IndexMetadata("foo_pk", "foo", schema, {0}), bpm);
+    ProbeBenchmark("BPlusTreeIndex", &b_plus_tree_index, keys);
+  }
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  delete schema;
+}
+
+}  // namespace bustub